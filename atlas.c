@@ -0,0 +1,416 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "atlas.h"
+
+#include "blend.h"
+#include "clock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+/* Number of hash buckets, a power of two */
+#define NUM_BUCKETS 1024
+
+/* Code points below this are looked up through a direct table instead of the hash buckets */
+#define NUM_ASCII 128
+
+/* Number of distinct style combinations */
+#define NUM_STYLES 2
+
+
+/**
+ * Static variables
+ */
+
+static ul_atlas_glyph *buckets[NUM_BUCKETS];
+
+/* Cached ASCII glyphs of the most recently used font, indexed by style and code point */
+static const lv_font_t *ascii_font = NULL;
+static ul_atlas_glyph *ascii_glyphs[NUM_STYLES][NUM_ASCII];
+
+/* LRU list, the head is the most recently used glyph */
+static ul_atlas_glyph *lru_head = NULL;
+static ul_atlas_glyph *lru_tail = NULL;
+
+static size_t budget = UL_ATLAS_DEFAULT_BUDGET * 1024;
+static size_t num_bytes = 0;
+static int num_glyphs = 0;
+
+static unsigned long num_hits = 0;
+static unsigned long num_misses = 0;
+static unsigned long num_evictions = 0;
+static unsigned long long rasterise_ns = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get the hash bucket of a glyph.
+ *
+ * @param font font
+ * @param codepoint Unicode code point
+ * @param style combination of ul_atlas_style values
+ * @return bucket index
+ */
+static uint32_t get_bucket(const lv_font_t *font, uint32_t codepoint, uint8_t style);
+
+/**
+ * Get the memory a glyph occupies.
+ *
+ * @param glyph glyph
+ * @return size in bytes
+ */
+static size_t get_glyph_bytes(const ul_atlas_glyph *glyph);
+
+/**
+ * Unlink a glyph from the LRU list.
+ *
+ * @param glyph glyph
+ */
+static void lru_remove(ul_atlas_glyph *glyph);
+
+/**
+ * Link a glyph in as the most recently used one.
+ *
+ * @param glyph glyph
+ */
+static void lru_push(ul_atlas_glyph *glyph);
+
+/**
+ * Mark a glyph as the most recently used one and count a hit.
+ *
+ * @param glyph glyph
+ * @return the glyph
+ */
+static ul_atlas_glyph *touch(ul_atlas_glyph *glyph);
+
+/**
+ * Get the direct table slot of a glyph.
+ *
+ * @param font font
+ * @param codepoint Unicode code point
+ * @param style combination of ul_atlas_style values
+ * @return the slot or NULL if the glyph can't be held in the table
+ */
+static ul_atlas_glyph **get_ascii_slot(const lv_font_t *font, uint32_t codepoint, uint8_t style);
+
+/**
+ * Drop the least recently used glyph.
+ */
+static void evict_oldest(void);
+
+/**
+ * Rasterise a glyph into 8-bit alpha values.
+ *
+ * @param font font
+ * @param codepoint Unicode code point
+ * @param style combination of ul_atlas_style values
+ * @return the new glyph (not linked into the cache) or NULL on failure
+ */
+static ul_atlas_glyph *rasterise(const lv_font_t *font, uint32_t codepoint, uint8_t style);
+
+
+/**
+ * Static functions
+ */
+
+static uint32_t get_bucket(const lv_font_t *font, uint32_t codepoint, uint8_t style) {
+    uint32_t h = codepoint * 0x9e3779b1u;
+    h ^= (uint32_t)((uintptr_t)font >> 4) * 0x85ebca6bu;
+    h ^= style;
+    h ^= h >> 15;
+    return h & (NUM_BUCKETS - 1);
+}
+
+static size_t get_glyph_bytes(const ul_atlas_glyph *glyph) {
+    return sizeof(ul_atlas_glyph) + (size_t)glyph->width * glyph->height;
+}
+
+static void lru_remove(ul_atlas_glyph *glyph) {
+    if (glyph->prev) {
+        glyph->prev->next = glyph->next;
+    } else {
+        lru_head = glyph->next;
+    }
+    if (glyph->next) {
+        glyph->next->prev = glyph->prev;
+    } else {
+        lru_tail = glyph->prev;
+    }
+    glyph->prev = NULL;
+    glyph->next = NULL;
+}
+
+static void lru_push(ul_atlas_glyph *glyph) {
+    glyph->prev = NULL;
+    glyph->next = lru_head;
+    if (lru_head) {
+        lru_head->prev = glyph;
+    } else {
+        lru_tail = glyph;
+    }
+    lru_head = glyph;
+}
+
+static ul_atlas_glyph *touch(ul_atlas_glyph *glyph) {
+    if (glyph != lru_head) {
+        lru_remove(glyph);
+        lru_push(glyph);
+    }
+    ++num_hits;
+    return glyph;
+}
+
+static ul_atlas_glyph **get_ascii_slot(const lv_font_t *font, uint32_t codepoint, uint8_t style) {
+    if (codepoint >= NUM_ASCII || style >= NUM_STYLES || font != ascii_font) {
+        return NULL;
+    }
+    return &(ascii_glyphs[style][codepoint]);
+}
+
+static void evict_oldest(void) {
+    ul_atlas_glyph *glyph = lru_tail;
+    if (!glyph) {
+        return;
+    }
+
+    ul_atlas_glyph **slot = get_ascii_slot(glyph->font, glyph->codepoint, glyph->style);
+    if (slot) {
+        *slot = NULL;
+    }
+
+    ul_atlas_glyph **link = &(buckets[get_bucket(glyph->font, glyph->codepoint, glyph->style)]);
+    while (*link != glyph) {
+        link = &((*link)->bucket_next);
+    }
+    *link = glyph->bucket_next;
+
+    lru_remove(glyph);
+    num_bytes -= get_glyph_bytes(glyph);
+    --num_glyphs;
+    ++num_evictions;
+
+    free(glyph->alpha);
+    free(glyph);
+}
+
+static ul_atlas_glyph *rasterise(const lv_font_t *font, uint32_t codepoint, uint8_t style) {
+    lv_font_glyph_dsc_t dsc;
+    if (!lv_font_get_glyph_dsc(font, &dsc, codepoint, 0)) {
+        return NULL;
+    }
+
+    const lv_font_t *resolved_font = dsc.resolved_font ? dsc.resolved_font : font;
+    const uint8_t *bitmap = dsc.box_w > 0 && dsc.box_h > 0 ? lv_font_get_glyph_bitmap(resolved_font, codepoint) : NULL;
+    const int extra_width = (style & UL_ATLAS_STYLE_BOLD) ? 1 : 0;
+
+    ul_atlas_glyph *glyph = calloc(1, sizeof(ul_atlas_glyph));
+    if (!glyph) {
+        return NULL;
+    }
+    glyph->font = font;
+    glyph->codepoint = codepoint;
+    glyph->style = style;
+
+    if (!bitmap || dsc.bpp < 1 || dsc.bpp > 8) {
+        return glyph; /* Nothing to draw, e.g. a space */
+    }
+
+    /* Same placement as lv_draw_letter: the box sits on the font's base line */
+    glyph->ofs_x = dsc.ofs_x;
+    glyph->ofs_y = (int16_t)(font->line_height - font->base_line - dsc.box_h - dsc.ofs_y);
+    glyph->width = (uint16_t)(dsc.box_w + extra_width);
+    glyph->height = dsc.box_h;
+    glyph->alpha = calloc((size_t)glyph->width * glyph->height, 1);
+    if (!glyph->alpha) {
+        free(glyph);
+        return NULL;
+    }
+
+    /* Bitmap rows are packed without padding, every pixel takes bpp bits */
+    if (dsc.bpp == 4) {
+        /* The common case, unpack the whole glyph at once and spread the rows out afterwards if needed */
+        ul_blend_expand_4bpp(bitmap, glyph->alpha, (size_t)dsc.box_w * dsc.box_h);
+        for (int y = dsc.box_h - 1; extra_width > 0 && y >= 0; --y) {
+            lv_opa_t *row = glyph->alpha + (size_t)y * glyph->width;
+            memmove(row, glyph->alpha + (size_t)y * dsc.box_w, dsc.box_w);
+            memset(row + dsc.box_w, 0, extra_width);
+        }
+    } else {
+        const uint32_t max_value = (1u << dsc.bpp) - 1;
+        uint32_t bit = 0;
+        for (int y = 0; y < dsc.box_h; ++y) {
+            lv_opa_t *row = glyph->alpha + (size_t)y * glyph->width;
+            for (int x = 0; x < dsc.box_w; ++x, bit += dsc.bpp) {
+                uint32_t value = 0;
+                for (int b = 0; b < dsc.bpp; ++b) {
+                    uint32_t pos = bit + b;
+                    value = (value << 1) | ((bitmap[pos >> 3] >> (7 - (pos & 7))) & 1);
+                }
+                row[x] = (lv_opa_t)(value * 255 / max_value);
+            }
+        }
+    }
+
+    for (int y = 0; extra_width > 0 && y < glyph->height; ++y) {
+        lv_opa_t *row = glyph->alpha + (size_t)y * glyph->width;
+        for (int x = glyph->width - 1; x > 0; --x) {
+            row[x] = LV_MAX(row[x], row[x - 1]);
+        }
+    }
+
+    return glyph;
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_atlas_set_budget(size_t bytes) {
+    budget = bytes;
+    while (num_bytes > budget) {
+        evict_oldest();
+    }
+}
+
+const ul_atlas_glyph *ul_atlas_get(const lv_font_t *font, uint32_t codepoint, uint8_t style) {
+    if (budget == 0) {
+        return NULL;
+    }
+
+    /* Terminal text is mostly ASCII in a single font, skip hashing for it */
+    if (codepoint < NUM_ASCII && font != ascii_font) {
+        ascii_font = font;
+        memset(ascii_glyphs, 0, sizeof(ascii_glyphs));
+    }
+    ul_atlas_glyph **slot = get_ascii_slot(font, codepoint, style);
+    if (slot && *slot) {
+        return touch(*slot);
+    }
+
+    uint32_t bucket = get_bucket(font, codepoint, style);
+    for (ul_atlas_glyph *glyph = buckets[bucket]; glyph; glyph = glyph->bucket_next) {
+        if (glyph->codepoint == codepoint && glyph->font == font && glyph->style == style) {
+            if (slot) {
+                *slot = glyph;
+            }
+            return touch(glyph);
+        }
+    }
+
+    unsigned long long start_ns = ul_clock_get_ns();
+    ul_atlas_glyph *glyph = rasterise(font, codepoint, style);
+    rasterise_ns += ul_clock_get_ns() - start_ns;
+    ++num_misses;
+    if (!glyph) {
+        return NULL;
+    }
+
+    size_t bytes = get_glyph_bytes(glyph);
+    if (bytes > budget) {
+        free(glyph->alpha);
+        free(glyph);
+        return NULL;
+    }
+    while (num_bytes + bytes > budget) {
+        evict_oldest();
+    }
+
+    glyph->bucket_next = buckets[bucket];
+    buckets[bucket] = glyph;
+    lru_push(glyph);
+    num_bytes += bytes;
+    ++num_glyphs;
+    if (slot) {
+        *slot = glyph;
+    }
+
+    return glyph;
+}
+
+void ul_atlas_draw(lv_draw_ctx_t *draw_ctx, const ul_atlas_glyph *glyph, const lv_point_t *pos, lv_color_t color, lv_opa_t opa) {
+    if (glyph->width == 0 || glyph->height == 0) {
+        return;
+    }
+
+    lv_area_t area;
+    area.x1 = pos->x + glyph->ofs_x;
+    area.y1 = pos->y + glyph->ofs_y;
+    area.x2 = area.x1 + glyph->width - 1;
+    area.y2 = area.y1 + glyph->height - 1;
+
+#if LV_COLOR_DEPTH == 32
+    /* Without masks or custom pixel writers the glyph can go straight into the ARGB8888 draw buffer */
+    const lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    if (disp && !disp->driver->set_px_cb && !disp->driver->screen_transp && !lv_draw_mask_is_any(&area)) {
+        lv_area_t clipped;
+        if (!_lv_area_intersect(&clipped, &area, draw_ctx->clip_area)) {
+            return;
+        }
+
+        const lv_coord_t buf_width = lv_area_get_width(draw_ctx->buf_area);
+        const size_t len = (size_t)lv_area_get_width(&clipped);
+        uint32_t *buf = (uint32_t *)draw_ctx->buf;
+        for (lv_coord_t y = clipped.y1; y <= clipped.y2; ++y) {
+            uint32_t *dst = buf + (size_t)(y - draw_ctx->buf_area->y1) * buf_width + (clipped.x1 - draw_ctx->buf_area->x1);
+            const lv_opa_t *mask = glyph->alpha + (size_t)(y - area.y1) * glyph->width + (clipped.x1 - area.x1);
+            ul_blend_mask_argb8888(dst, mask, len, lv_color_to32(color), opa);
+        }
+        return;
+    }
+#endif
+
+    /* The blender only reads the mask, so the cached alpha values are used as they are */
+    lv_draw_sw_blend_dsc_t blend_dsc;
+    memset(&blend_dsc, 0, sizeof(blend_dsc));
+    blend_dsc.blend_area = &area;
+    blend_dsc.mask_area = &area;
+    blend_dsc.mask_buf = glyph->alpha;
+    blend_dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+    blend_dsc.color = color;
+    blend_dsc.opa = opa;
+    blend_dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+    lv_draw_sw_blend(draw_ctx, &blend_dsc);
+}
+
+void ul_atlas_clear(void) {
+    while (lru_tail) {
+        evict_oldest();
+    }
+}
+
+void ul_atlas_get_stats(ul_atlas_stats *stats) {
+    stats->glyphs = num_glyphs;
+    stats->bytes = num_bytes;
+    stats->budget = budget;
+    stats->hits = num_hits;
+    stats->misses = num_misses;
+    stats->evictions = num_evictions;
+    stats->rasterise_ns = rasterise_ns;
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_ATLAS_H
+#define UL_ATLAS_H
+
+#include "lvgl/lvgl.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Memory (in KiB) cached glyphs may occupy if not configured otherwise */
+#define UL_ATLAS_DEFAULT_BUDGET 256
+
+/**
+ * Glyph styles that change a glyph's bitmap
+ */
+typedef enum {
+    /* Synthetic bold, every pixel is smeared one column to the right */
+    UL_ATLAS_STYLE_BOLD = 1 << 0
+} ul_atlas_style;
+
+/**
+ * A rasterised glyph: one 8-bit alpha value per pixel of its bounding box, ready to be
+ * blended in the text colour
+ */
+typedef struct _ul_atlas_glyph {
+    /* Font the glyph was rasterised from */
+    const lv_font_t *font;
+    /* Unicode code point */
+    uint32_t codepoint;
+    /* Combination of ul_atlas_style values */
+    uint8_t style;
+    /* Offset of the bounding box from the top left corner of the glyph's cell */
+    int16_t ofs_x;
+    int16_t ofs_y;
+    /* Size of the bounding box, 0 for glyphs without any pixels */
+    uint16_t width;
+    uint16_t height;
+    /* Alpha values, width * height bytes row by row */
+    lv_opa_t *alpha;
+    /* Neighbours in the LRU list, most recently used first */
+    struct _ul_atlas_glyph *prev;
+    struct _ul_atlas_glyph *next;
+    /* Next glyph in the same hash bucket */
+    struct _ul_atlas_glyph *bucket_next;
+} ul_atlas_glyph;
+
+/**
+ * Glyph atlas statistics
+ */
+typedef struct {
+    /* Number of glyphs currently cached */
+    int glyphs;
+    /* Memory used by the cached glyphs in bytes */
+    size_t bytes;
+    /* Memory budget in bytes */
+    size_t budget;
+    /* Number of lookups served from the cache */
+    unsigned long hits;
+    /* Number of lookups that had to rasterise the glyph */
+    unsigned long misses;
+    /* Number of glyphs dropped to stay within the budget */
+    unsigned long evictions;
+    /* Total time spent rasterising glyphs on misses in nanoseconds */
+    unsigned long long rasterise_ns;
+} ul_atlas_stats;
+
+/**
+ * Set the memory budget of the atlas, dropping the least recently used glyphs if it is
+ * exceeded. A budget of 0 disables caching.
+ *
+ * @param bytes budget in bytes
+ */
+void ul_atlas_set_budget(size_t bytes);
+
+/**
+ * Look up a glyph, rasterising and caching it if it isn't cached yet.
+ *
+ * @param font font
+ * @param codepoint Unicode code point
+ * @param style combination of ul_atlas_style values
+ * @return the glyph or NULL if the font has no such glyph or it can't be cached, the
+ *         glyph stays valid until the next lookup
+ */
+const ul_atlas_glyph *ul_atlas_get(const lv_font_t *font, uint32_t codepoint, uint8_t style);
+
+/**
+ * Blend a cached glyph onto the display.
+ *
+ * @param draw_ctx draw context
+ * @param glyph glyph
+ * @param pos top left corner of the glyph's cell
+ * @param color text colour
+ * @param opa opacity
+ */
+void ul_atlas_draw(lv_draw_ctx_t *draw_ctx, const ul_atlas_glyph *glyph, const lv_point_t *pos, lv_color_t color, lv_opa_t opa);
+
+/**
+ * Drop all cached glyphs.
+ */
+void ul_atlas_clear(void);
+
+/**
+ * Get glyph atlas statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_atlas_get_stats(ul_atlas_stats *stats);
+
+#endif /* UL_ATLAS_H */
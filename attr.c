@@ -0,0 +1,321 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "attr.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+#define HASH_BUCKETS 256 /* Must be a power of two */
+#define NO_SLOT 0xffff
+
+
+/**
+ * Static variables
+ */
+
+/* Cells are copied between the parser and the render thread, so references are counted
+ * atomically. Slots only change hands under mutex: a reference can only be added without it
+ * by someone already holding one. */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static ul_attr attrs[UL_ATTR_TABLE_SIZE];
+static _Atomic uint32_t refs[UL_ATTR_TABLE_SIZE];
+static uint16_t next[UL_ATTR_TABLE_SIZE]; /* Hash chain for used slots, free list for unused ones */
+static uint16_t buckets[HASH_BUCKETS];
+static uint16_t free_head = NO_SLOT;
+
+static int num_used = 0;
+static int peak_used = 0;
+static unsigned long num_overflows = 0;
+
+static bool is_initialised = false;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Compute the hash bucket of an attribute set.
+ *
+ * @param attr attribute set
+ * @return bucket index
+ */
+static uint16_t hash_attr(const ul_attr *attr);
+
+/**
+ * Check two attribute sets for equality.
+ *
+ * @param a first attribute set
+ * @param b second attribute set
+ * @return true if both sets are equal, false otherwise
+ */
+static bool attrs_equal(const ul_attr *a, const ul_attr *b);
+
+/**
+ * Parse an extended colour (38 / 48) from SGR parameters.
+ *
+ * @param params SGR parameters following the 38 / 48 selector
+ * @param num_params number of remaining parameters
+ * @param color pointer for writing the colour into
+ * @return number of parameters consumed
+ */
+static int parse_extended_color(const int *params, int num_params, uint32_t *color);
+
+
+/**
+ * Static functions
+ */
+
+static uint16_t hash_attr(const ul_attr *attr) {
+    uint32_t h = attr->fg * 0x9e3779b1u;
+    h ^= attr->bg * 0x85ebca77u;
+    h ^= (uint32_t)attr->flags * 0xc2b2ae3du;
+    h ^= h >> 15;
+    return (uint16_t)(h & (HASH_BUCKETS - 1));
+}
+
+static bool attrs_equal(const ul_attr *a, const ul_attr *b) {
+    return a->fg == b->fg && a->bg == b->bg && a->flags == b->flags;
+}
+
+static int parse_extended_color(const int *params, int num_params, uint32_t *color) {
+    if (num_params < 1) {
+        return 0;
+    }
+
+    if (params[0] == 5 && num_params >= 2) {
+        if (params[1] >= 0 && params[1] <= 255) {
+            *color = UL_ATTR_COLOR_INDEXED(params[1]);
+        }
+        return 2;
+    }
+
+    if (params[0] == 2 && num_params >= 4) {
+        *color = UL_ATTR_COLOR_RGB(params[1] < 0 ? 0 : params[1], params[2] < 0 ? 0 : params[2], params[3] < 0 ? 0 : params[3]);
+        return 4;
+    }
+
+    return num_params; /* Malformed, swallow the rest of the sequence */
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_attr_table_init(void) {
+    for (int i = 0; i < UL_ATTR_TABLE_SIZE; ++i) {
+        atomic_init(&(refs[i]), 0);
+    }
+    for (int i = 0; i < HASH_BUCKETS; ++i) {
+        buckets[i] = NO_SLOT;
+    }
+
+    /* Chain all slots except the default one into the free list */
+    free_head = NO_SLOT;
+    for (int i = UL_ATTR_TABLE_SIZE - 1; i > UL_ATTR_DEFAULT_ID; --i) {
+        next[i] = free_head;
+        free_head = (uint16_t)i;
+    }
+
+    ul_attr_reset(&(attrs[UL_ATTR_DEFAULT_ID]));
+    uint16_t bucket = hash_attr(&(attrs[UL_ATTR_DEFAULT_ID]));
+    next[UL_ATTR_DEFAULT_ID] = NO_SLOT;
+    buckets[bucket] = UL_ATTR_DEFAULT_ID;
+
+    num_used = 1;
+    peak_used = 1;
+    num_overflows = 0;
+    is_initialised = true;
+}
+
+ul_attr_id ul_attr_intern(const ul_attr *attr) {
+    if (!is_initialised) {
+        ul_attr_table_init();
+    }
+
+    pthread_mutex_lock(&mutex);
+
+    /* A slot found in its chain may be at zero references with its release still pending,
+     * the release backs off once it sees the revived count */
+    uint16_t bucket = hash_attr(attr);
+    for (uint16_t slot = buckets[bucket]; slot != NO_SLOT; slot = next[slot]) {
+        if (attrs_equal(&(attrs[slot]), attr)) {
+            if (slot != UL_ATTR_DEFAULT_ID) {
+                atomic_fetch_add(&(refs[slot]), 1);
+            }
+            pthread_mutex_unlock(&mutex);
+            return slot;
+        }
+    }
+
+    if (free_head == NO_SLOT) {
+        ++num_overflows;
+        pthread_mutex_unlock(&mutex);
+        return UL_ATTR_DEFAULT_ID;
+    }
+
+    uint16_t slot = free_head;
+    free_head = next[slot];
+
+    attrs[slot] = *attr;
+    atomic_store(&(refs[slot]), 1);
+    next[slot] = buckets[bucket];
+    buckets[bucket] = slot;
+
+    if (++num_used > peak_used) {
+        peak_used = num_used;
+    }
+
+    pthread_mutex_unlock(&mutex);
+    return slot;
+}
+
+void ul_attr_ref(ul_attr_id id) {
+    if (id == UL_ATTR_DEFAULT_ID || id >= UL_ATTR_TABLE_SIZE) {
+        return;
+    }
+    atomic_fetch_add_explicit(&(refs[id]), 1, memory_order_relaxed);
+}
+
+void ul_attr_unref(ul_attr_id id) {
+    if (id == UL_ATTR_DEFAULT_ID || id >= UL_ATTR_TABLE_SIZE) {
+        return;
+    }
+
+    uint32_t count = atomic_load(&(refs[id]));
+    do {
+        if (count == 0) {
+            return;
+        }
+    } while (!atomic_compare_exchange_weak(&(refs[id]), &count, count - 1));
+
+    if (count > 1) {
+        return;
+    }
+
+    /* The slot may have been revived by ul_attr_intern or already released by another thread
+     * that dropped it to zero again, only a slot still chained without references is freed */
+    pthread_mutex_lock(&mutex);
+    uint16_t *link = &(buckets[hash_attr(&(attrs[id]))]);
+    while (*link != NO_SLOT && *link != id) {
+        link = &(next[*link]);
+    }
+    if (*link == id && atomic_load(&(refs[id])) == 0) {
+        /* Unlink from the hash chain and return the slot to the free list */
+        *link = next[id];
+        next[id] = free_head;
+        free_head = id;
+        --num_used;
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+const ul_attr *ul_attr_get(ul_attr_id id) {
+    if (id >= UL_ATTR_TABLE_SIZE) {
+        id = UL_ATTR_DEFAULT_ID;
+    }
+    return &(attrs[id]);
+}
+
+void ul_attr_reset(ul_attr *attr) {
+    attr->fg = UL_ATTR_COLOR_DEFAULT;
+    attr->bg = UL_ATTR_COLOR_DEFAULT;
+    attr->flags = 0;
+}
+
+void ul_attr_apply_sgr(ul_attr *attr, const int *params, int num_params) {
+    if (num_params == 0) {
+        ul_attr_reset(attr);
+        return;
+    }
+
+    for (int i = 0; i < num_params; ++i) {
+        int p = params[i] < 0 ? 0 : params[i];
+
+        if (p == 0) {
+            ul_attr_reset(attr);
+        } else if (p == 1) {
+            attr->flags |= UL_ATTR_FLAG_BOLD;
+        } else if (p == 2) {
+            attr->flags |= UL_ATTR_FLAG_FAINT;
+        } else if (p == 3) {
+            attr->flags |= UL_ATTR_FLAG_ITALIC;
+        } else if (p == 4) {
+            attr->flags |= UL_ATTR_FLAG_UNDERLINE;
+        } else if (p == 5 || p == 6) {
+            attr->flags |= UL_ATTR_FLAG_BLINK;
+        } else if (p == 7) {
+            attr->flags |= UL_ATTR_FLAG_INVERSE;
+        } else if (p == 8) {
+            attr->flags |= UL_ATTR_FLAG_INVISIBLE;
+        } else if (p == 9) {
+            attr->flags |= UL_ATTR_FLAG_STRIKETHROUGH;
+        } else if (p == 21 || p == 22) {
+            attr->flags &= ~(UL_ATTR_FLAG_BOLD | UL_ATTR_FLAG_FAINT);
+        } else if (p == 23) {
+            attr->flags &= ~UL_ATTR_FLAG_ITALIC;
+        } else if (p == 24) {
+            attr->flags &= ~UL_ATTR_FLAG_UNDERLINE;
+        } else if (p == 25) {
+            attr->flags &= ~UL_ATTR_FLAG_BLINK;
+        } else if (p == 27) {
+            attr->flags &= ~UL_ATTR_FLAG_INVERSE;
+        } else if (p == 28) {
+            attr->flags &= ~UL_ATTR_FLAG_INVISIBLE;
+        } else if (p == 29) {
+            attr->flags &= ~UL_ATTR_FLAG_STRIKETHROUGH;
+        } else if (p >= 30 && p <= 37) {
+            attr->fg = UL_ATTR_COLOR_INDEXED(p - 30);
+        } else if (p == 38) {
+            i += parse_extended_color(params + i + 1, num_params - i - 1, &(attr->fg));
+        } else if (p == 39) {
+            attr->fg = UL_ATTR_COLOR_DEFAULT;
+        } else if (p >= 40 && p <= 47) {
+            attr->bg = UL_ATTR_COLOR_INDEXED(p - 40);
+        } else if (p == 48) {
+            i += parse_extended_color(params + i + 1, num_params - i - 1, &(attr->bg));
+        } else if (p == 49) {
+            attr->bg = UL_ATTR_COLOR_DEFAULT;
+        } else if (p >= 90 && p <= 97) {
+            attr->fg = UL_ATTR_COLOR_INDEXED(p - 90 + 8);
+        } else if (p >= 100 && p <= 107) {
+            attr->bg = UL_ATTR_COLOR_INDEXED(p - 100 + 8);
+        }
+    }
+}
+
+void ul_attr_get_stats(ul_attr_stats *stats) {
+    pthread_mutex_lock(&mutex);
+    stats->used = num_used;
+    stats->peak = peak_used;
+    stats->capacity = UL_ATTR_TABLE_SIZE;
+    stats->overflows = num_overflows;
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,162 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_ATTR_H
+#define UL_ATTR_H
+
+#include <stdint.h>
+
+/* Number of distinct attribute sets that can be alive at the same time */
+#define UL_ATTR_TABLE_SIZE 1024
+
+/* ID of the default attribute set. It is always present and never released. */
+#define UL_ATTR_DEFAULT_ID 0
+
+/**
+ * Colour encoding. The top byte selects the colour type, the remaining bits hold
+ * either a palette index or a 24-bit RGB value.
+ */
+#define UL_ATTR_COLOR_DEFAULT 0x00000000u
+#define UL_ATTR_COLOR_INDEXED(index) (0x01000000u | ((uint32_t)(index) & 0xffu))
+#define UL_ATTR_COLOR_RGB(r, g, b) (0x02000000u | (((uint32_t)(r) & 0xffu) << 16) | (((uint32_t)(g) & 0xffu) << 8) | ((uint32_t)(b) & 0xffu))
+#define UL_ATTR_COLOR_TYPE(color) ((color) >> 24)
+
+/**
+ * Rendition flags
+ */
+typedef enum {
+    UL_ATTR_FLAG_BOLD          = 1 << 0,
+    UL_ATTR_FLAG_FAINT         = 1 << 1,
+    UL_ATTR_FLAG_ITALIC        = 1 << 2,
+    UL_ATTR_FLAG_UNDERLINE     = 1 << 3,
+    UL_ATTR_FLAG_BLINK         = 1 << 4,
+    UL_ATTR_FLAG_INVERSE       = 1 << 5,
+    UL_ATTR_FLAG_INVISIBLE     = 1 << 6,
+    UL_ATTR_FLAG_STRIKETHROUGH = 1 << 7
+} ul_attr_flag;
+
+/* Index into the attribute table */
+typedef uint16_t ul_attr_id;
+
+/**
+ * Set of graphic rendition attributes shared by any number of cells
+ */
+typedef struct {
+    /* Foreground colour (see UL_ATTR_COLOR_*) */
+    uint32_t fg;
+    /* Background colour (see UL_ATTR_COLOR_*) */
+    uint32_t bg;
+    /* Combination of ul_attr_flag values */
+    uint16_t flags;
+} ul_attr;
+
+/**
+ * A single character cell. Kept at 8 bytes so that rows stay compact and cheap to copy.
+ */
+typedef struct {
+    /* Unicode code point, 0 for an empty cell */
+    uint32_t codepoint;
+    /* Interned attribute set of the cell */
+    ul_attr_id attr;
+    /* Number of columns occupied (1 or 2), 0 for the right half of a wide character */
+    uint8_t width;
+    /* Unused, keeps the cell size a power of two */
+    uint8_t reserved;
+} ul_cell;
+
+_Static_assert(sizeof(ul_cell) == 8, "ul_cell must stay 8 bytes wide");
+
+/**
+ * Attribute table statistics
+ */
+typedef struct {
+    /* Number of attribute sets currently in use (including the default set) */
+    int used;
+    /* Maximum number of attribute sets that have been in use at the same time */
+    int peak;
+    /* Total number of slots in the table */
+    int capacity;
+    /* Number of intern requests that fell back to the default set because the table was full */
+    unsigned long overflows;
+} ul_attr_stats;
+
+/**
+ * Initialise (or reset) the attribute table. All previously returned IDs except
+ * UL_ATTR_DEFAULT_ID become invalid.
+ */
+void ul_attr_table_init(void);
+
+/**
+ * Look up an attribute set in the table and add it if it isn't present yet. The
+ * returned ID holds one reference which needs to be dropped with ul_attr_unref.
+ *
+ * @param attr attribute set to intern
+ * @return ID of the interned set or UL_ATTR_DEFAULT_ID if the table is full
+ */
+ul_attr_id ul_attr_intern(const ul_attr *attr);
+
+/**
+ * Add a reference to an interned attribute set. Like all reference counting functions of the
+ * table, this may be called from any thread.
+ *
+ * @param id attribute set ID
+ */
+void ul_attr_ref(ul_attr_id id);
+
+/**
+ * Drop a reference to an interned attribute set. The slot is recycled once the last
+ * reference is gone.
+ *
+ * @param id attribute set ID
+ */
+void ul_attr_unref(ul_attr_id id);
+
+/**
+ * Get the attribute set behind an ID.
+ *
+ * @param id attribute set ID
+ * @return pointer to the attribute set
+ */
+const ul_attr *ul_attr_get(ul_attr_id id);
+
+/**
+ * Reset an attribute set to the default rendition.
+ *
+ * @param attr attribute set to reset
+ */
+void ul_attr_reset(ul_attr *attr);
+
+/**
+ * Apply the parameters of an SGR (CSI ... m) control sequence to an attribute set.
+ *
+ * @param attr attribute set to modify
+ * @param params SGR parameters, -1 for omitted parameters
+ * @param num_params number of parameters
+ */
+void ul_attr_apply_sgr(ul_attr *attr, const int *params, int num_params);
+
+/**
+ * Get statistics about the attribute table.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_attr_get_stats(ul_attr_stats *stats);
+
+#endif /* UL_ATTR_H */
@@ -0,0 +1,561 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "blend.h"
+
+#include "clock.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS 1
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+
+/**
+ * Defines
+ */
+
+/* Pixels per row and number of rows timed by the benchmark */
+#define BENCHMARK_PIXELS 4096
+#define BENCHMARK_ROUNDS 4000
+
+
+/**
+ * Static variables
+ */
+
+static ul_blend_kernel selected_kernel = UL_BLEND_KERNEL_SCALAR;
+
+static void (*expand_4bpp)(const uint8_t *src, uint8_t *dst, size_t num_pixels);
+static void (*mask_argb8888)(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa);
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Divide by 255 with rounding. Exact for the products of two 8 bit values and matches
+ * what the vector kernels compute.
+ *
+ * @param x dividend, at most 255 * 255
+ * @return the quotient
+ */
+static inline uint32_t div255(uint32_t x);
+
+/**
+ * Check whether a kernel can run on this CPU.
+ *
+ * @param kernel kernel
+ * @return true if the kernel is available, false otherwise
+ */
+static bool is_kernel_supported(ul_blend_kernel kernel);
+
+/**
+ * Scalar implementation of ul_blend_expand_4bpp.
+ */
+static void expand_4bpp_scalar(const uint8_t *src, uint8_t *dst, size_t num_pixels);
+
+/**
+ * Scalar implementation of ul_blend_mask_argb8888.
+ */
+static void mask_argb8888_scalar(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa);
+
+#if defined(__SSE2__)
+/**
+ * SSE2 implementation of ul_blend_expand_4bpp.
+ */
+static void expand_4bpp_sse2(const uint8_t *src, uint8_t *dst, size_t num_pixels);
+
+/**
+ * SSE2 implementation of ul_blend_mask_argb8888.
+ */
+static void mask_argb8888_sse2(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa);
+#endif
+
+#if defined(HAVE_AVX2_KERNELS)
+/**
+ * AVX2 implementation of ul_blend_mask_argb8888.
+ */
+static void mask_argb8888_avx2(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa);
+#endif
+
+#if defined(__ARM_NEON)
+/**
+ * NEON implementation of ul_blend_expand_4bpp.
+ */
+static void expand_4bpp_neon(const uint8_t *src, uint8_t *dst, size_t num_pixels);
+
+/**
+ * NEON implementation of ul_blend_mask_argb8888.
+ */
+static void mask_argb8888_neon(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa);
+#endif
+
+
+/**
+ * Static functions
+ */
+
+static inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static bool is_kernel_supported(ul_blend_kernel kernel) {
+    switch (kernel) {
+    case UL_BLEND_KERNEL_SCALAR:
+        return true;
+#if defined(__SSE2__)
+    case UL_BLEND_KERNEL_SSE2:
+        return true;
+#endif
+#if defined(HAVE_AVX2_KERNELS)
+    case UL_BLEND_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON)
+    case UL_BLEND_KERNEL_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+static void expand_4bpp_scalar(const uint8_t *src, uint8_t *dst, size_t num_pixels) {
+    size_t i = 0;
+    for (; i + 1 < num_pixels; i += 2) {
+        const uint8_t b = src[i / 2];
+        dst[i] = (uint8_t)((b >> 4) * 17);
+        dst[i + 1] = (uint8_t)((b & 0x0f) * 17);
+    }
+    if (i < num_pixels) {
+        dst[i] = (uint8_t)((src[i / 2] >> 4) * 17);
+    }
+}
+
+static void mask_argb8888_scalar(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa) {
+    /* The glyph is opaque, all four channels are blended alike so that the result has full alpha */
+    const uint32_t solid = color | 0xff000000u;
+    for (size_t i = 0; i < len; ++i) {
+        const uint32_t a = opa == 255 ? mask[i] : div255((uint32_t)mask[i] * opa);
+        if (a == 0) {
+            continue;
+        }
+        if (a == 255) {
+            dst[i] = solid;
+            continue;
+        }
+
+        const uint32_t d = dst[i];
+        uint32_t out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            out |= div255(((solid >> shift) & 0xff) * a + ((d >> shift) & 0xff) * (255 - a)) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+#if defined(__SSE2__)
+static void expand_4bpp_sse2(const uint8_t *src, uint8_t *dst, size_t num_pixels) {
+    const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= num_pixels; i += 32) {
+        const __m128i b = _mm_loadu_si128((const __m128i *)(src + i / 2));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(b, 4), low_nibbles);
+        __m128i lo = _mm_and_si128(b, low_nibbles);
+        /* v * 17 == (v << 4) | v for v < 16, no carry crosses into the neighbouring byte */
+        hi = _mm_or_si128(hi, _mm_slli_epi16(hi, 4));
+        lo = _mm_or_si128(lo, _mm_slli_epi16(lo, 4));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(dst + i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+
+    expand_4bpp_scalar(src + i / 2, dst + i, num_pixels - i);
+}
+
+/**
+ * Divide eight 16 bit values by 255 like div255.
+ *
+ * @param x dividends
+ * @return quotients
+ */
+static inline __m128i div255_sse2(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static void mask_argb8888_sse2(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa) {
+    const uint32_t solid = color | 0xff000000u;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i opa16 = _mm_set1_epi16(opa);
+    const __m128i solid32 = _mm_set1_epi32((int)solid);
+    const __m128i fg = _mm_unpacklo_epi8(solid32, zero);
+
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t m;
+        memcpy(&m, mask + i, sizeof(m));
+        if (m == 0) {
+            continue;
+        }
+        if (m == 0xffffffffu && opa == 255) {
+            _mm_storeu_si128((__m128i *)(dst + i), solid32);
+            continue;
+        }
+
+        /* Spread every alpha value over the four channels of its pixel, two pixels per register */
+        __m128i a = _mm_cvtsi32_si128((int)m);
+        a = _mm_unpacklo_epi8(a, a);
+        a = _mm_unpacklo_epi8(a, a);
+        __m128i a_lo = _mm_unpacklo_epi8(a, zero);
+        __m128i a_hi = _mm_unpackhi_epi8(a, zero);
+        if (opa != 255) {
+            a_lo = div255_sse2(_mm_mullo_epi16(a_lo, opa16));
+            a_hi = div255_sse2(_mm_mullo_epi16(a_hi, opa16));
+        }
+
+        const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        const __m128i d_lo = _mm_unpacklo_epi8(d, zero);
+        const __m128i d_hi = _mm_unpackhi_epi8(d, zero);
+
+        const __m128i out_lo = div255_sse2(_mm_add_epi16(_mm_mullo_epi16(fg, a_lo), _mm_mullo_epi16(d_lo, _mm_sub_epi16(full, a_lo))));
+        const __m128i out_hi = div255_sse2(_mm_add_epi16(_mm_mullo_epi16(fg, a_hi), _mm_mullo_epi16(d_hi, _mm_sub_epi16(full, a_hi))));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(out_lo, out_hi));
+    }
+
+    mask_argb8888_scalar(dst + i, mask + i, len - i, color, opa);
+}
+#endif
+
+#if defined(HAVE_AVX2_KERNELS)
+/**
+ * Divide sixteen 16 bit values by 255 like div255.
+ *
+ * @param x dividends
+ * @return quotients
+ */
+__attribute__((target("avx2")))
+static inline __m256i div255_avx2(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+static void mask_argb8888_avx2(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa) {
+    const uint32_t solid = color | 0xff000000u;
+    const __m256i full = _mm256_set1_epi16(255);
+    const __m256i opa16 = _mm256_set1_epi16(opa);
+    const __m256i solid32 = _mm256_set1_epi32((int)solid);
+    const __m256i fg = _mm256_cvtepu8_epi16(_mm_set1_epi32((int)solid));
+
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t m;
+        memcpy(&m, mask + i, sizeof(m));
+        if (m == 0) {
+            continue;
+        }
+        if (m == UINT64_MAX && opa == 255) {
+            _mm256_storeu_si256((__m256i *)(dst + i), solid32);
+            continue;
+        }
+
+        /* Spread every alpha value over the four channels of its pixel, four pixels per register */
+        __m128i a = _mm_loadl_epi64((const __m128i *)(mask + i));
+        a = _mm_unpacklo_epi8(a, a);
+        __m256i a_lo = _mm256_cvtepu8_epi16(_mm_unpacklo_epi16(a, a));
+        __m256i a_hi = _mm256_cvtepu8_epi16(_mm_unpackhi_epi16(a, a));
+        if (opa != 255) {
+            a_lo = div255_avx2(_mm256_mullo_epi16(a_lo, opa16));
+            a_hi = div255_avx2(_mm256_mullo_epi16(a_hi, opa16));
+        }
+
+        const __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        const __m256i d_lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(d));
+        const __m256i d_hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(d, 1));
+
+        const __m256i out_lo = div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(fg, a_lo), _mm256_mullo_epi16(d_lo, _mm256_sub_epi16(full, a_lo))));
+        const __m256i out_hi = div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(fg, a_hi), _mm256_mullo_epi16(d_hi, _mm256_sub_epi16(full, a_hi))));
+
+        /* Packing works per 128 bit lane, put the pixel pairs back in order afterwards */
+        const __m256i packed = _mm256_packus_epi16(out_lo, out_hi);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    mask_argb8888_scalar(dst + i, mask + i, len - i, color, opa);
+}
+#endif
+
+#if defined(__ARM_NEON)
+static void expand_4bpp_neon(const uint8_t *src, uint8_t *dst, size_t num_pixels) {
+    const uint8x16_t low_nibbles = vdupq_n_u8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= num_pixels; i += 32) {
+        const uint8x16_t b = vld1q_u8(src + i / 2);
+        const uint8x16_t hi = vshrq_n_u8(b, 4);
+        const uint8x16_t lo = vandq_u8(b, low_nibbles);
+        uint8x16x2_t out;
+        out.val[0] = vsliq_n_u8(hi, hi, 4);
+        out.val[1] = vsliq_n_u8(lo, lo, 4);
+        vst2q_u8(dst + i, out);
+    }
+
+    expand_4bpp_scalar(src + i / 2, dst + i, num_pixels - i);
+}
+
+/**
+ * Divide eight 16 bit values by 255 like div255 and narrow them to 8 bits.
+ *
+ * @param x dividends
+ * @return quotients
+ */
+static inline uint8x8_t div255_neon(uint16x8_t x) {
+    return vraddhn_u16(x, vrshrq_n_u16(x, 8));
+}
+
+static void mask_argb8888_neon(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa) {
+    const uint32_t solid = color | 0xff000000u;
+    const uint32x4_t solid32 = vdupq_n_u32(solid);
+    const uint8x8_t opa8 = vdup_n_u8(opa);
+    uint8x8_t fg[4];
+    for (int c = 0; c < 4; ++c) {
+        fg[c] = vdup_n_u8((uint8_t)(solid >> (8 * c)));
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t m;
+        memcpy(&m, mask + i, sizeof(m));
+        if (m == 0) {
+            continue;
+        }
+        if (m == UINT64_MAX && opa == 255) {
+            vst1q_u32(dst + i, solid32);
+            vst1q_u32(dst + i + 4, solid32);
+            continue;
+        }
+
+        uint8x8_t a = vld1_u8(mask + i);
+        if (opa != 255) {
+            a = div255_neon(vmull_u8(a, opa8));
+        }
+        const uint8x8_t inv = vmvn_u8(a);
+
+        /* Deinterleave the channels so that every lane holds the same channel of a different pixel */
+        uint8x8x4_t d = vld4_u8((const uint8_t *)(dst + i));
+        for (int c = 0; c < 4; ++c) {
+            d.val[c] = div255_neon(vmlal_u8(vmull_u8(fg[c], a), d.val[c], inv));
+        }
+        vst4_u8((uint8_t *)(dst + i), d);
+    }
+
+    mask_argb8888_scalar(dst + i, mask + i, len - i, color, opa);
+}
+#endif
+
+
+/**
+ * Public functions
+ */
+
+void ul_blend_init(void) {
+    static const ul_blend_kernel preferred[] = { UL_BLEND_KERNEL_NEON, UL_BLEND_KERNEL_AVX2, UL_BLEND_KERNEL_SSE2 };
+    for (size_t i = 0; i < sizeof(preferred) / sizeof(preferred[0]); ++i) {
+        if (ul_blend_set_kernel(preferred[i])) {
+            break;
+        }
+    }
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Using %s glyph blending kernels", ul_blend_get_kernel_name(selected_kernel));
+}
+
+bool ul_blend_set_kernel(ul_blend_kernel kernel) {
+    if (!is_kernel_supported(kernel)) {
+        return false;
+    }
+
+    selected_kernel = kernel;
+    expand_4bpp = expand_4bpp_scalar;
+    mask_argb8888 = mask_argb8888_scalar;
+
+    switch (kernel) {
+#if defined(__SSE2__)
+    case UL_BLEND_KERNEL_SSE2:
+        expand_4bpp = expand_4bpp_sse2;
+        mask_argb8888 = mask_argb8888_sse2;
+        break;
+#endif
+#if defined(HAVE_AVX2_KERNELS)
+    case UL_BLEND_KERNEL_AVX2:
+        /* Expanding is bound by memory, the SSE2 version is as fast */
+        expand_4bpp = expand_4bpp_sse2;
+        mask_argb8888 = mask_argb8888_avx2;
+        break;
+#endif
+#if defined(__ARM_NEON)
+    case UL_BLEND_KERNEL_NEON:
+        expand_4bpp = expand_4bpp_neon;
+        mask_argb8888 = mask_argb8888_neon;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return true;
+}
+
+ul_blend_kernel ul_blend_get_kernel(void) {
+    return selected_kernel;
+}
+
+const char *ul_blend_get_kernel_name(ul_blend_kernel kernel) {
+    switch (kernel) {
+    case UL_BLEND_KERNEL_SSE2:
+        return "SSE2";
+    case UL_BLEND_KERNEL_AVX2:
+        return "AVX2";
+    case UL_BLEND_KERNEL_NEON:
+        return "NEON";
+    default:
+        return "scalar";
+    }
+}
+
+void ul_blend_expand_4bpp(const uint8_t *src, uint8_t *dst, size_t num_pixels) {
+    if (!expand_4bpp) {
+        ul_blend_set_kernel(selected_kernel);
+    }
+    expand_4bpp(src, dst, num_pixels);
+}
+
+void ul_blend_mask_argb8888(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa) {
+    if (!mask_argb8888) {
+        ul_blend_set_kernel(selected_kernel);
+    }
+    mask_argb8888(dst, mask, len, color, opa);
+}
+
+bool ul_blend_run_benchmark(void) {
+    uint8_t *packed = malloc(BENCHMARK_PIXELS / 2);
+    uint8_t *mask = malloc(BENCHMARK_PIXELS);
+    uint32_t *background = malloc(BENCHMARK_PIXELS * sizeof(uint32_t));
+    uint8_t *expected_mask = malloc(BENCHMARK_PIXELS);
+    uint32_t *expected_pixels = malloc(BENCHMARK_PIXELS * sizeof(uint32_t));
+    uint32_t *pixels = malloc(BENCHMARK_PIXELS * sizeof(uint32_t));
+    if (!packed || !mask || !background || !expected_mask || !expected_pixels || !pixels) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for blending benchmark");
+        free(packed);
+        free(mask);
+        free(background);
+        free(expected_mask);
+        free(expected_pixels);
+        free(pixels);
+        return false;
+    }
+
+    /* Coverage that looks like text: mostly empty or solid runs with antialiased edges in between */
+    uint32_t state = 0x12345678;
+    for (size_t i = 0; i < BENCHMARK_PIXELS / 2; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        const uint8_t kind = state & 3;
+        packed[i] = kind == 0 ? 0x00 : kind == 1 ? 0xff : (uint8_t)(state >> 8);
+        background[2 * i] = 0xff000000u | (state >> 8);
+        background[2 * i + 1] = 0xff000000u | (state >> 4);
+    }
+
+    const ul_blend_kernel original_kernel = selected_kernel;
+    const uint32_t color = 0xffe5e5e5u;
+    const uint8_t opa = 153;
+    bool is_identical = true;
+    double scalar_ns = 0.0;
+
+    ul_blend_set_kernel(UL_BLEND_KERNEL_SCALAR);
+    expand_4bpp(packed, expected_mask, BENCHMARK_PIXELS);
+    memcpy(expected_pixels, background, BENCHMARK_PIXELS * sizeof(uint32_t));
+    mask_argb8888(expected_pixels, expected_mask, BENCHMARK_PIXELS, color, 255);
+    mask_argb8888(expected_pixels, expected_mask, BENCHMARK_PIXELS, color, opa);
+
+    printf("%-8s %16s %16s %10s\n", "kernel", "expand Mpx/s", "blend Mpx/s", "speedup");
+    for (int kernel = UL_BLEND_KERNEL_SCALAR; kernel <= UL_BLEND_KERNEL_NEON; ++kernel) {
+        if (!ul_blend_set_kernel((ul_blend_kernel)kernel)) {
+            continue;
+        }
+
+        expand_4bpp(packed, mask, BENCHMARK_PIXELS);
+        memcpy(pixels, background, BENCHMARK_PIXELS * sizeof(uint32_t));
+        mask_argb8888(pixels, mask, BENCHMARK_PIXELS, color, 255);
+        mask_argb8888(pixels, mask, BENCHMARK_PIXELS, color, opa);
+        const bool is_kernel_identical = memcmp(mask, expected_mask, BENCHMARK_PIXELS) == 0
+            && memcmp(pixels, expected_pixels, BENCHMARK_PIXELS * sizeof(uint32_t)) == 0;
+        is_identical = is_identical && is_kernel_identical;
+
+        unsigned long long start_ns = ul_clock_get_ns();
+        for (int round = 0; round < BENCHMARK_ROUNDS; ++round) {
+            expand_4bpp(packed, mask, BENCHMARK_PIXELS);
+        }
+        const double expand_ns = (double)(ul_clock_get_ns() - start_ns);
+
+        /* Blend onto the same row over and over, alternating the opacity like normal and faint text */
+        start_ns = ul_clock_get_ns();
+        for (int round = 0; round < BENCHMARK_ROUNDS; ++round) {
+            mask_argb8888(pixels, mask, BENCHMARK_PIXELS, color, (round & 1) ? opa : 255);
+        }
+        const double blend_ns = (double)(ul_clock_get_ns() - start_ns);
+        if (kernel == UL_BLEND_KERNEL_SCALAR) {
+            scalar_ns = blend_ns;
+        }
+
+        const double num_pixels = (double)BENCHMARK_PIXELS * BENCHMARK_ROUNDS;
+        printf("%-8s %16.1f %16.1f %9.2fx%s\n", ul_blend_get_kernel_name((ul_blend_kernel)kernel),
+            expand_ns > 0 ? num_pixels * 1000.0 / expand_ns : 0.0, blend_ns > 0 ? num_pixels * 1000.0 / blend_ns : 0.0,
+            blend_ns > 0 ? scalar_ns / blend_ns : 0.0, is_kernel_identical ? "" : " (output differs from scalar)");
+    }
+
+    ul_blend_set_kernel(original_kernel);
+
+    free(packed);
+    free(mask);
+    free(background);
+    free(expected_mask);
+    free(expected_pixels);
+    free(pixels);
+
+    return is_identical;
+}
@@ -0,0 +1,101 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_BLEND_H
+#define UL_BLEND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Implementations of the glyph blending kernels
+ */
+typedef enum {
+    /* Portable C */
+    UL_BLEND_KERNEL_SCALAR = 0,
+    /* x86 SSE2 */
+    UL_BLEND_KERNEL_SSE2 = 1,
+    /* x86 AVX2 */
+    UL_BLEND_KERNEL_AVX2 = 2,
+    /* ARM NEON */
+    UL_BLEND_KERNEL_NEON = 3
+} ul_blend_kernel;
+
+/**
+ * Select the fastest kernels the CPU supports.
+ */
+void ul_blend_init(void);
+
+/**
+ * Select specific kernels.
+ *
+ * @param kernel kernels to use
+ * @return true if the kernels are available on this CPU and were selected, false otherwise
+ */
+bool ul_blend_set_kernel(ul_blend_kernel kernel);
+
+/**
+ * Get the selected kernels.
+ *
+ * @return the kernels
+ */
+ul_blend_kernel ul_blend_get_kernel(void);
+
+/**
+ * Get the name of a kernel implementation.
+ *
+ * @param kernel kernel
+ * @return the name
+ */
+const char *ul_blend_get_kernel_name(ul_blend_kernel kernel);
+
+/**
+ * Expand 4 bit coverage values into 8 bit alpha values. Pixels are packed two to a byte
+ * with the first pixel in the high nibble.
+ *
+ * @param src coverage values
+ * @param dst buffer for num_pixels alpha values
+ * @param num_pixels number of pixels
+ */
+void ul_blend_expand_4bpp(const uint8_t *src, uint8_t *dst, size_t num_pixels);
+
+/**
+ * Blend a solid colour through an alpha mask onto a row of ARGB8888 pixels. Fully covered
+ * pixels are overwritten and uncovered pixels are left untouched, so glyphs can be drawn
+ * onto both solid fills and arbitrary existing content.
+ *
+ * @param dst pixels to blend onto
+ * @param mask one alpha value per pixel
+ * @param len number of pixels
+ * @param color colour in 0xAARRGGBB, the alpha channel is ignored
+ * @param opa opacity applied on top of the mask
+ */
+void ul_blend_mask_argb8888(uint32_t *dst, const uint8_t *mask, size_t len, uint32_t color, uint8_t opa);
+
+/**
+ * Time every kernel available on this CPU against the scalar one and print the results
+ * to STDOUT.
+ *
+ * @return true if all kernels produced the same output as the scalar one, false otherwise
+ */
+bool ul_blend_run_benchmark(void);
+
+#endif /* UL_BLEND_H */
@@ -0,0 +1,40 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_CLOCK_H
+#define UL_CLOCK_H
+
+#include <stdint.h>
+
+/**
+ * Get the time of the monotonic clock, for measuring durations.
+ *
+ * @return time in microseconds
+ */
+int64_t ul_clock_get_us(void);
+
+/**
+ * Get the time of the monotonic clock, for measuring short durations.
+ *
+ * @return time in nanoseconds
+ */
+uint64_t ul_clock_get_ns(void);
+
+#endif /* UL_CLOCK_H */
@@ -64,6 +64,7 @@ static void init_opts(ul_cli_opts *opts) {
     opts->x_offset = 0;
     opts->y_offset = 0;
     opts->verbose = false;
+    opts->benchmark = false;
 }
 
 static void print_usage() {
@@ -85,7 +86,10 @@ static void print_usage() {
         "  -g, --geometry=NxM[@X,Y]  Force a display size of N horizontal times M\n"
         "                            vertical pixels, offset horizontally by X\n"
         "                            pixels and vertically by Y pixels\n"
-        "  -d  --dpi=N               Override the display's DPI value\n"
+        "  -d  --dpi=N               Override the display's DPI value, which also\n"
+        "                            sets the terminal font's scale\n"
+        "  -b, --benchmark           Time the glyph blending and pixel conversion\n"
+        "                            kernels and exit\n"
         "  -h, --help                Print this message and exit\n"
         "  -v, --verbose             Enable more detailed logging output on STDERR\n"
         "  -V, --version             Print the furios-terminal version and exit\n");
@@ -105,6 +109,7 @@ void ul_cli_parse_opts(int argc, char *argv[], ul_cli_opts *opts) {
         { "config-override", required_argument, NULL, 'C' },
         { "geometry",        required_argument, NULL, 'g' },
         { "dpi",             required_argument, NULL, 'd' },
+        { "benchmark",       no_argument,       NULL, 'b' },
         { "help",            no_argument,       NULL, 'h' },
         { "verbose",         no_argument,       NULL, 'v' },
         { "version",         no_argument,       NULL, 'V' },
@@ -113,7 +118,7 @@ void ul_cli_parse_opts(int argc, char *argv[], ul_cli_opts *opts) {
 
     int opt, index = 0;
 
-    while ((opt = getopt_long(argc, argv, "c:C:g:d:hvV", long_opts, &index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "c:C:g:d:bhvV", long_opts, &index)) != -1) {
         switch (opt) {
         case 'c':
             opts->config_files[0] = optarg;
@@ -141,6 +146,9 @@ void ul_cli_parse_opts(int argc, char *argv[], ul_cli_opts *opts) {
                 exit(EXIT_FAILURE);
             }
             break;
+        case 'b':
+            opts->benchmark = true;
+            break;
         case 'h':
             print_usage();
             exit(EXIT_SUCCESS);
@@ -43,6 +43,8 @@ typedef struct {
     int dpi;
     /* Verbose mode. If true, provide more detailed logging output on STDERR. */
     bool verbose;
+    /* If true, time the glyph blending kernels and exit */
+    bool benchmark;
 } ul_cli_opts;
 
 /**
@@ -20,7 +20,10 @@
 
 #include "config.h"
 
+#include "atlas.h"
 #include "log.h"
+#include "screen.h"
+#include "spill.h"
 
 #include "lvgl/lvgl.h"
 
@@ -69,6 +72,15 @@ static int parsing_handler(void* user_data, const char* section, const char* key
  */
 static bool parse_bool(const char *value, bool *result);
 
+/**
+ * Attempt to parse a scroll mode.
+ *
+ * @param value string to parse
+ * @param result pointer to write result into if parsing is successful
+ * @return true on success, false otherwise
+ */
+static bool parse_scroll_mode(const char *value, ul_config_scroll_mode *result);
+
 
 /**
  * Static functions
@@ -78,6 +90,9 @@ static void init_opts(ul_config_opts *opts) {
     opts->general.animations = false;
     opts->general.backend = ul_backends_backends[0] == NULL ? UL_BACKENDS_BACKEND_NONE : 0;
     opts->general.timeout = 0;
+    opts->general.direct_rendering = true;
+    opts->general.draw_buffer = 10;
+    opts->general.draw_buffers = 2;
     opts->keyboard.autohide = true;
     opts->keyboard.layout_id = SQ2LV_LAYOUT_US;
     opts->keyboard.popovers = false;
@@ -85,6 +100,13 @@ static void init_opts(ul_config_opts *opts) {
     opts->textarea.bullet = LV_SYMBOL_BULLET;
     opts->theme.default_id = UL_THEMES_THEME_BREEZY_DARK;
     opts->theme.alternate_id = UL_THEMES_THEME_BREEZY_LIGHT;
+    opts->terminal.scrollback = UL_SCREEN_DEFAULT_SCROLLBACK;
+    opts->terminal.history_memory = 0;
+    opts->terminal.spill_directory = NULL;
+    opts->terminal.spill_size = UL_SPILL_DEFAULT_SIZE;
+    opts->terminal.glyph_cache = UL_ATLAS_DEFAULT_BUDGET;
+    opts->terminal.scroll = UL_CONFIG_SCROLL_PAN;
+    opts->terminal.cursor_blink_idle = 10;
     opts->input.keyboard = true;
     opts->input.pointer = true;
     opts->input.touchscreen = true;
@@ -110,6 +132,18 @@ static int parsing_handler(void* user_data, const char* section, const char* key
                 opts->general.backend = id;
                 return 1;
             }
+        } else if (strcmp(key, "direct-rendering") == 0) {
+            if (parse_bool(value, &(opts->general.direct_rendering))) {
+                return 1;
+            }
+        } else if (strcmp(key, "draw-buffer") == 0) {
+            /* Use a range of 1 to 100 percent of the display */
+            opts->general.draw_buffer = (int)LV_CLAMP(1, strtoul(value, (char **)NULL, 10), 100);
+            return 1;
+        } else if (strcmp(key, "draw-buffers") == 0) {
+            /* Use one or two buffers */
+            opts->general.draw_buffers = (int)LV_CLAMP(1, strtoul(value, (char **)NULL, 10), 2);
+            return 1;
         } else if (strcmp(key, "timeout") == 0) {
             /* Use a max ceiling of 60 minutes (3600 secs) */
             opts->general.timeout = (uint16_t)LV_MIN(strtoul(value, (char **)NULL, 10), 3600);
@@ -157,6 +191,38 @@ static int parsing_handler(void* user_data, const char* section, const char* key
                 return 1;
             }
         }
+    } else if (strcmp(section, "terminal") == 0) {
+        if (strcmp(key, "scrollback") == 0) {
+            /* Use a max ceiling of 1000000 lines */
+            opts->terminal.scrollback = (int)LV_MIN(strtoul(value, (char **)NULL, 10), 1000000);
+            return 1;
+        } else if (strcmp(key, "history-memory") == 0) {
+            /* Use a max ceiling of 1 GiB */
+            opts->terminal.history_memory = (int)LV_MIN(strtoul(value, (char **)NULL, 10), 1048576);
+            return 1;
+        } else if (strcmp(key, "spill-directory") == 0) {
+            char *directory = strdup(value);
+            if (directory) {
+                opts->terminal.spill_directory = directory;
+                return 1;
+            }
+        } else if (strcmp(key, "spill-size") == 0) {
+            /* Use a max ceiling of 4 GiB */
+            opts->terminal.spill_size = (int)LV_MIN(strtoul(value, (char **)NULL, 10), 4096);
+            return 1;
+        } else if (strcmp(key, "glyph-cache") == 0) {
+            /* Use a max ceiling of 64 MiB */
+            opts->terminal.glyph_cache = (int)LV_MIN(strtoul(value, (char **)NULL, 10), 65536);
+            return 1;
+        } else if (strcmp(key, "scroll") == 0) {
+            if (parse_scroll_mode(value, &(opts->terminal.scroll))) {
+                return 1;
+            }
+        } else if (strcmp(key, "cursor-blink-idle") == 0) {
+            /* Use a max ceiling of 1 hour */
+            opts->terminal.cursor_blink_idle = (int)LV_MIN(strtoul(value, (char **)NULL, 10), 3600);
+            return 1;
+        }
     } else if (strcmp(section, "input") == 0) {
         if (strcmp(key, "keyboard") == 0) {
             if (parse_bool(value, &(opts->input.keyboard))) {
@@ -191,6 +257,25 @@ static bool parse_bool(const char *value, bool *result) {
     return false;
 }
 
+static bool parse_scroll_mode(const char *value, ul_config_scroll_mode *result) {
+    if (strcmp(value, "redraw") == 0) {
+        *result = UL_CONFIG_SCROLL_REDRAW;
+        return true;
+    }
+
+    if (strcmp(value, "move") == 0) {
+        *result = UL_CONFIG_SCROLL_MOVE;
+        return true;
+    }
+
+    if (strcmp(value, "pan") == 0) {
+        *result = UL_CONFIG_SCROLL_PAN;
+        return true;
+    }
+
+    return false;
+}
+
 
 /**
  * Public functions
@@ -40,6 +40,12 @@ typedef struct {
     bool animations;
     /* Timeout (in seconds) - once elapsed, the device will shutdown. 0 (default) to disable */
     uint16_t timeout;
+    /* If true, render straight into the framebuffer when its pixel layout matches LVGL's */
+    bool direct_rendering;
+    /* Size of each draw buffer (in percent of the display) when not rendering directly */
+    int draw_buffer;
+    /* Number of draw buffers, with 2 the framebuffer is written on a separate thread */
+    int draw_buffers;
 } ul_config_opts_general;
 
 /**
@@ -74,6 +80,38 @@ typedef struct {
     ul_themes_theme_id_t alternate_id;
 } ul_config_opts_theme;
 
+/**
+ * Ways of updating the display when the terminal scrolls
+ */
+typedef enum {
+    /* Redraw all rows */
+    UL_CONFIG_SCROLL_REDRAW = 0,
+    /* Move the pixels of the rows that stay visible and draw only the new ones */
+    UL_CONFIG_SCROLL_MOVE,
+    /* Pan the display where the backend supports it, move pixels otherwise */
+    UL_CONFIG_SCROLL_PAN
+} ul_config_scroll_mode;
+
+/**
+ * Options related to the terminal
+ */
+typedef struct {
+    /* Maximum number of lines kept in scrollback */
+    int scrollback;
+    /* Memory (in KiB) compressed scrollback may occupy before it is spilled, 0 for no limit */
+    int history_memory;
+    /* Directory to create the scrollback spill file in, NULL to disable spilling */
+    const char *spill_directory;
+    /* Maximum size of the spill file (in MiB) */
+    int spill_size;
+    /* Memory (in KiB) rasterised glyphs may occupy, 0 to draw every glyph from the font */
+    int glyph_cache;
+    /* How to update the display when the terminal scrolls */
+    ul_config_scroll_mode scroll;
+    /* Seconds without output or key presses after which the cursor stops blinking, 0 to blink forever */
+    int cursor_blink_idle;
+} ul_config_opts_terminal;
+
 /**
  * Options related to input devices
  */
@@ -98,6 +136,8 @@ typedef struct {
     ul_config_opts_textarea textarea;
     /* Options related to the theme */
     ul_config_opts_theme theme;
+    /* Options related to the terminal */
+    ul_config_opts_terminal terminal;
     /* Options related to input devices */
     ul_config_opts_input input;
 } ul_config_opts;
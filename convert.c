@@ -0,0 +1,615 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "convert.h"
+
+#include "blend.h"
+#include "clock.h"
+#include "log.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS 1
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* The vector kernels read ARGB8888 pixels, 16 bit builds are meant for RGB565 panels where rows are copied */
+#if LV_COLOR_DEPTH == 32
+#define HAVE_VECTOR_KERNELS 1
+#endif
+
+
+/**
+ * Defines
+ */
+
+/* Number of pixel formats */
+#define NUM_FORMATS (UL_CONVERT_FORMAT_XRGB2101010 + 1)
+
+/* Pixels per row and number of rows timed by the benchmark */
+#define BENCHMARK_PIXELS 4096
+#define BENCHMARK_ROUNDS 4000
+
+
+/**
+ * Static variables
+ */
+
+#if LV_COLOR_DEPTH == 16
+typedef uint16_t src_pixel;
+#else
+typedef uint32_t src_pixel;
+#endif
+
+typedef void (*convert_fn)(void *dst, const src_pixel *src, size_t num_pixels);
+
+static int selected_kernel = -1;
+static convert_fn converters[NUM_FORMATS];
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Widen an 8 bit colour channel to 10 bits by repeating its top bits.
+ *
+ * @param c channel value
+ * @return widened value
+ */
+static inline uint32_t widen_10(uint32_t c);
+
+/**
+ * Read a pixel rendered by LVGL as ARGB8888.
+ *
+ * @param src pixels
+ * @param i index of the pixel
+ * @return the pixel in 0xAARRGGBB
+ */
+static inline uint32_t load_pixel(const src_pixel *src, size_t i);
+
+/**
+ * Pick the converters matching the glyph blending kernels.
+ *
+ * @param kernel selected blending kernels
+ */
+static void select_converters(ul_blend_kernel kernel);
+
+/**
+ * Copy pixels into a format identical to LVGL's.
+ */
+static void copy_pixels(void *dst, const src_pixel *src, size_t num_pixels);
+
+/**
+ * Scalar implementations of ul_convert_row, one per format.
+ */
+#if LV_COLOR_DEPTH == 16
+static void to_xrgb8888_scalar(void *dst, const src_pixel *src, size_t num_pixels);
+#endif
+static void to_xbgr8888_scalar(void *dst, const src_pixel *src, size_t num_pixels);
+static void to_rgb888_scalar(void *dst, const src_pixel *src, size_t num_pixels);
+#if LV_COLOR_DEPTH != 16
+static void to_rgb565_scalar(void *dst, const src_pixel *src, size_t num_pixels);
+#endif
+static void to_xrgb2101010_scalar(void *dst, const src_pixel *src, size_t num_pixels);
+
+#if defined(HAVE_VECTOR_KERNELS) && defined(__SSE2__)
+/**
+ * SSE2 implementations of ul_convert_row. 24 bit output needs byte shuffles and stays scalar.
+ */
+static void to_xbgr8888_sse2(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_rgb565_sse2(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_xrgb2101010_sse2(void *dst, const uint32_t *src, size_t num_pixels);
+#endif
+
+#if defined(HAVE_VECTOR_KERNELS) && defined(HAVE_AVX2_KERNELS)
+/**
+ * AVX2 implementations of ul_convert_row.
+ */
+static void to_xbgr8888_avx2(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_rgb888_avx2(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_rgb565_avx2(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_xrgb2101010_avx2(void *dst, const uint32_t *src, size_t num_pixels);
+#endif
+
+#if defined(HAVE_VECTOR_KERNELS) && defined(__ARM_NEON)
+/**
+ * NEON implementations of ul_convert_row.
+ */
+static void to_xbgr8888_neon(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_rgb888_neon(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_rgb565_neon(void *dst, const uint32_t *src, size_t num_pixels);
+static void to_xrgb2101010_neon(void *dst, const uint32_t *src, size_t num_pixels);
+#endif
+
+
+/**
+ * Static functions
+ */
+
+static inline uint32_t widen_10(uint32_t c) {
+    return (c << 2) | (c >> 6);
+}
+
+static inline uint32_t load_pixel(const src_pixel *src, size_t i) {
+#if LV_COLOR_DEPTH == 16
+    /* Widen RGB565 by repeating the top bits of every channel */
+    const uint32_t r = (src[i] >> 11) & 0x1f;
+    const uint32_t g = (src[i] >> 5) & 0x3f;
+    const uint32_t b = src[i] & 0x1f;
+    return 0xff000000u | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+#else
+    return src[i];
+#endif
+}
+
+static void select_converters(ul_blend_kernel kernel) {
+    selected_kernel = kernel;
+#if LV_COLOR_DEPTH == 16
+    converters[UL_CONVERT_FORMAT_XRGB8888] = to_xrgb8888_scalar;
+    converters[UL_CONVERT_FORMAT_RGB565] = copy_pixels;
+#else
+    converters[UL_CONVERT_FORMAT_XRGB8888] = copy_pixels;
+    converters[UL_CONVERT_FORMAT_RGB565] = to_rgb565_scalar;
+#endif
+    converters[UL_CONVERT_FORMAT_XBGR8888] = to_xbgr8888_scalar;
+    converters[UL_CONVERT_FORMAT_RGB888] = to_rgb888_scalar;
+    converters[UL_CONVERT_FORMAT_XRGB2101010] = to_xrgb2101010_scalar;
+
+    switch (kernel) {
+#if defined(HAVE_VECTOR_KERNELS) && defined(__SSE2__)
+    case UL_BLEND_KERNEL_SSE2:
+        converters[UL_CONVERT_FORMAT_XBGR8888] = to_xbgr8888_sse2;
+        converters[UL_CONVERT_FORMAT_RGB565] = to_rgb565_sse2;
+        converters[UL_CONVERT_FORMAT_XRGB2101010] = to_xrgb2101010_sse2;
+        break;
+#endif
+#if defined(HAVE_VECTOR_KERNELS) && defined(HAVE_AVX2_KERNELS)
+    case UL_BLEND_KERNEL_AVX2:
+        converters[UL_CONVERT_FORMAT_XBGR8888] = to_xbgr8888_avx2;
+        converters[UL_CONVERT_FORMAT_RGB888] = to_rgb888_avx2;
+        converters[UL_CONVERT_FORMAT_RGB565] = to_rgb565_avx2;
+        converters[UL_CONVERT_FORMAT_XRGB2101010] = to_xrgb2101010_avx2;
+        break;
+#endif
+#if defined(HAVE_VECTOR_KERNELS) && defined(__ARM_NEON)
+    case UL_BLEND_KERNEL_NEON:
+        converters[UL_CONVERT_FORMAT_XBGR8888] = to_xbgr8888_neon;
+        converters[UL_CONVERT_FORMAT_RGB888] = to_rgb888_neon;
+        converters[UL_CONVERT_FORMAT_RGB565] = to_rgb565_neon;
+        converters[UL_CONVERT_FORMAT_XRGB2101010] = to_xrgb2101010_neon;
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+static void copy_pixels(void *dst, const src_pixel *src, size_t num_pixels) {
+    memcpy(dst, src, num_pixels * sizeof(src_pixel));
+}
+
+#if LV_COLOR_DEPTH == 16
+static void to_xrgb8888_scalar(void *dst, const src_pixel *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    for (size_t i = 0; i < num_pixels; ++i) {
+        d[i] = load_pixel(src, i);
+    }
+}
+#endif
+
+static void to_xbgr8888_scalar(void *dst, const src_pixel *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    for (size_t i = 0; i < num_pixels; ++i) {
+        const uint32_t c = load_pixel(src, i);
+        d[i] = (c & 0xff00ff00u) | ((c >> 16) & 0xff) | ((c & 0xff) << 16);
+    }
+}
+
+static void to_rgb888_scalar(void *dst, const src_pixel *src, size_t num_pixels) {
+    uint8_t *d = dst;
+    for (size_t i = 0; i < num_pixels; ++i) {
+        const uint32_t c = load_pixel(src, i);
+        d[3 * i] = (uint8_t)c;
+        d[3 * i + 1] = (uint8_t)(c >> 8);
+        d[3 * i + 2] = (uint8_t)(c >> 16);
+    }
+}
+
+#if LV_COLOR_DEPTH != 16
+static void to_rgb565_scalar(void *dst, const src_pixel *src, size_t num_pixels) {
+    uint16_t *d = dst;
+    for (size_t i = 0; i < num_pixels; ++i) {
+        const uint32_t c = src[i];
+        d[i] = (uint16_t)(((c >> 8) & 0xf800) | ((c >> 5) & 0x07e0) | ((c >> 3) & 0x001f));
+    }
+}
+#endif
+
+static void to_xrgb2101010_scalar(void *dst, const src_pixel *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    for (size_t i = 0; i < num_pixels; ++i) {
+        const uint32_t c = load_pixel(src, i);
+        d[i] = 0xc0000000u | (widen_10((c >> 16) & 0xff) << 20) | (widen_10((c >> 8) & 0xff) << 10) | widen_10(c & 0xff);
+    }
+}
+
+#if defined(HAVE_VECTOR_KERNELS) && defined(__SSE2__)
+static void to_xbgr8888_sse2(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    const __m128i ag_mask = _mm_set1_epi32((int)0xff00ff00u);
+    const __m128i channel_mask = _mm_set1_epi32(0xff);
+
+    size_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        const __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+        const __m128i r = _mm_and_si128(_mm_srli_epi32(c, 16), channel_mask);
+        const __m128i b = _mm_slli_epi32(_mm_and_si128(c, channel_mask), 16);
+        _mm_storeu_si128((__m128i *)(d + i), _mm_or_si128(_mm_and_si128(c, ag_mask), _mm_or_si128(r, b)));
+    }
+    to_xbgr8888_scalar(d + i, src + i, num_pixels - i);
+}
+
+/**
+ * Pack four ARGB8888 pixels into RGB565 values in the low halves of 32 bit lanes.
+ *
+ * @param c pixels
+ * @return packed pixels
+ */
+static inline __m128i pack_rgb565_sse2(__m128i c) {
+    const __m128i r = _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0xf800));
+    const __m128i g = _mm_and_si128(_mm_srli_epi32(c, 5), _mm_set1_epi32(0x07e0));
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(c, 3), _mm_set1_epi32(0x001f));
+    return _mm_or_si128(r, _mm_or_si128(g, b));
+}
+
+static void to_rgb565_sse2(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint16_t *d = dst;
+    /* SSE2 can only narrow with signed saturation, so move the values into the signed range and back */
+    const __m128i bias_32 = _mm_set1_epi32(0x8000);
+    const __m128i bias_16 = _mm_set1_epi16((short)0x8000);
+
+    size_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        const __m128i lo = _mm_sub_epi32(pack_rgb565_sse2(_mm_loadu_si128((const __m128i *)(src + i))), bias_32);
+        const __m128i hi = _mm_sub_epi32(pack_rgb565_sse2(_mm_loadu_si128((const __m128i *)(src + i + 4))), bias_32);
+        _mm_storeu_si128((__m128i *)(d + i), _mm_xor_si128(_mm_packs_epi32(lo, hi), bias_16));
+    }
+    to_rgb565_scalar(d + i, src + i, num_pixels - i);
+}
+
+/**
+ * Widen four 8 bit colour channels in the low bytes of 32 bit lanes like widen_10.
+ *
+ * @param c channel values
+ * @return widened values
+ */
+static inline __m128i widen_10_sse2(__m128i c) {
+    return _mm_or_si128(_mm_slli_epi32(c, 2), _mm_srli_epi32(c, 6));
+}
+
+static void to_xrgb2101010_sse2(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    const __m128i channel_mask = _mm_set1_epi32(0xff);
+    const __m128i alpha = _mm_set1_epi32((int)0xc0000000u);
+
+    size_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        const __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+        const __m128i r = widen_10_sse2(_mm_and_si128(_mm_srli_epi32(c, 16), channel_mask));
+        const __m128i g = widen_10_sse2(_mm_and_si128(_mm_srli_epi32(c, 8), channel_mask));
+        const __m128i b = widen_10_sse2(_mm_and_si128(c, channel_mask));
+        const __m128i rg = _mm_or_si128(_mm_slli_epi32(r, 20), _mm_slli_epi32(g, 10));
+        _mm_storeu_si128((__m128i *)(d + i), _mm_or_si128(alpha, _mm_or_si128(rg, b)));
+    }
+    to_xrgb2101010_scalar(d + i, src + i, num_pixels - i);
+}
+#endif
+
+#if defined(HAVE_VECTOR_KERNELS) && defined(HAVE_AVX2_KERNELS)
+__attribute__((target("avx2")))
+static void to_xbgr8888_avx2(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    /* Swap bytes 0 and 2 of every pixel */
+    const __m256i swap = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        const __m256i c = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(d + i), _mm256_shuffle_epi8(c, swap));
+    }
+    to_xbgr8888_scalar(d + i, src + i, num_pixels - i);
+}
+
+__attribute__((target("avx2")))
+static void to_rgb888_avx2(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint8_t *d = dst;
+    /* Drop byte 3 of every pixel, leaving 12 bytes followed by 4 unused ones */
+    const __m128i drop_alpha = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    /* Every store writes 4 bytes past the converted pixels, keep them within the row */
+    size_t i = 0;
+    for (; i + 6 <= num_pixels; i += 4) {
+        const __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(d + 3 * i), _mm_shuffle_epi8(c, drop_alpha));
+    }
+    to_rgb888_scalar(d + 3 * i, src + i, num_pixels - i);
+}
+
+/**
+ * Pack eight ARGB8888 pixels into RGB565 values like pack_rgb565_sse2.
+ *
+ * @param c pixels
+ * @return packed pixels
+ */
+__attribute__((target("avx2")))
+static inline __m256i pack_rgb565_avx2(__m256i c) {
+    const __m256i r = _mm256_and_si256(_mm256_srli_epi32(c, 8), _mm256_set1_epi32(0xf800));
+    const __m256i g = _mm256_and_si256(_mm256_srli_epi32(c, 5), _mm256_set1_epi32(0x07e0));
+    const __m256i b = _mm256_and_si256(_mm256_srli_epi32(c, 3), _mm256_set1_epi32(0x001f));
+    return _mm256_or_si256(r, _mm256_or_si256(g, b));
+}
+
+__attribute__((target("avx2")))
+static void to_rgb565_avx2(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint16_t *d = dst;
+
+    size_t i = 0;
+    for (; i + 16 <= num_pixels; i += 16) {
+        const __m256i lo = pack_rgb565_avx2(_mm256_loadu_si256((const __m256i *)(src + i)));
+        const __m256i hi = pack_rgb565_avx2(_mm256_loadu_si256((const __m256i *)(src + i + 8)));
+        /* Packing works within 128 bit lanes, restore the pixel order afterwards */
+        const __m256i packed = _mm256_packus_epi32(lo, hi);
+        _mm256_storeu_si256((__m256i *)(d + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    to_rgb565_scalar(d + i, src + i, num_pixels - i);
+}
+
+/**
+ * Widen eight 8 bit colour channels like widen_10.
+ *
+ * @param c channel values
+ * @return widened values
+ */
+__attribute__((target("avx2")))
+static inline __m256i widen_10_avx2(__m256i c) {
+    return _mm256_or_si256(_mm256_slli_epi32(c, 2), _mm256_srli_epi32(c, 6));
+}
+
+__attribute__((target("avx2")))
+static void to_xrgb2101010_avx2(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    const __m256i channel_mask = _mm256_set1_epi32(0xff);
+    const __m256i alpha = _mm256_set1_epi32((int)0xc0000000u);
+
+    size_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        const __m256i c = _mm256_loadu_si256((const __m256i *)(src + i));
+        const __m256i r = widen_10_avx2(_mm256_and_si256(_mm256_srli_epi32(c, 16), channel_mask));
+        const __m256i g = widen_10_avx2(_mm256_and_si256(_mm256_srli_epi32(c, 8), channel_mask));
+        const __m256i b = widen_10_avx2(_mm256_and_si256(c, channel_mask));
+        const __m256i rg = _mm256_or_si256(_mm256_slli_epi32(r, 20), _mm256_slli_epi32(g, 10));
+        _mm256_storeu_si256((__m256i *)(d + i), _mm256_or_si256(alpha, _mm256_or_si256(rg, b)));
+    }
+    to_xrgb2101010_scalar(d + i, src + i, num_pixels - i);
+}
+#endif
+
+#if defined(HAVE_VECTOR_KERNELS) && defined(__ARM_NEON)
+static void to_xbgr8888_neon(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint8_t *d = dst;
+
+    size_t i = 0;
+    for (; i + 16 <= num_pixels; i += 16) {
+        uint8x16x4_t c = vld4q_u8((const uint8_t *)(src + i));
+        const uint8x16_t b = c.val[0];
+        c.val[0] = c.val[2];
+        c.val[2] = b;
+        vst4q_u8(d + 4 * i, c);
+    }
+    to_xbgr8888_scalar(d + 4 * i, src + i, num_pixels - i);
+}
+
+static void to_rgb888_neon(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint8_t *d = dst;
+
+    size_t i = 0;
+    for (; i + 16 <= num_pixels; i += 16) {
+        const uint8x16x4_t c = vld4q_u8((const uint8_t *)(src + i));
+        const uint8x16x3_t rgb = { { c.val[0], c.val[1], c.val[2] } };
+        vst3q_u8(d + 3 * i, rgb);
+    }
+    to_rgb888_scalar(d + 3 * i, src + i, num_pixels - i);
+}
+
+static void to_rgb565_neon(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint16_t *d = dst;
+
+    size_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        const uint8x8x4_t c = vld4_u8((const uint8_t *)(src + i));
+        /* Insert green and blue below the top bits of red */
+        uint16x8_t p = vshll_n_u8(c.val[2], 8);
+        p = vsriq_n_u16(p, vshll_n_u8(c.val[1], 8), 5);
+        p = vsriq_n_u16(p, vshll_n_u8(c.val[0], 8), 11);
+        vst1q_u16(d + i, p);
+    }
+    to_rgb565_scalar(d + i, src + i, num_pixels - i);
+}
+
+/**
+ * Widen four 8 bit colour channels like widen_10.
+ *
+ * @param c channel values
+ * @return widened values
+ */
+static inline uint32x4_t widen_10_neon(uint32x4_t c) {
+    return vorrq_u32(vshlq_n_u32(c, 2), vshrq_n_u32(c, 6));
+}
+
+static void to_xrgb2101010_neon(void *dst, const uint32_t *src, size_t num_pixels) {
+    uint32_t *d = dst;
+    const uint32x4_t channel_mask = vdupq_n_u32(0xff);
+    const uint32x4_t alpha = vdupq_n_u32(0xc0000000u);
+
+    size_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        const uint32x4_t c = vld1q_u32(src + i);
+        const uint32x4_t r = widen_10_neon(vandq_u32(vshrq_n_u32(c, 16), channel_mask));
+        const uint32x4_t g = widen_10_neon(vandq_u32(vshrq_n_u32(c, 8), channel_mask));
+        const uint32x4_t b = widen_10_neon(vandq_u32(c, channel_mask));
+        const uint32x4_t rg = vorrq_u32(vshlq_n_u32(r, 20), vshlq_n_u32(g, 10));
+        vst1q_u32(d + i, vorrq_u32(alpha, vorrq_u32(rg, b)));
+    }
+    to_xrgb2101010_scalar(d + i, src + i, num_pixels - i);
+}
+#endif
+
+
+/**
+ * Public functions
+ */
+
+const char *ul_convert_get_format_name(ul_convert_format format) {
+    switch (format) {
+    case UL_CONVERT_FORMAT_XBGR8888:
+        return "XBGR8888";
+    case UL_CONVERT_FORMAT_RGB888:
+        return "RGB888";
+    case UL_CONVERT_FORMAT_RGB565:
+        return "RGB565";
+    case UL_CONVERT_FORMAT_XRGB2101010:
+        return "XRGB2101010";
+    default:
+        return "XRGB8888";
+    }
+}
+
+ul_convert_format ul_convert_get_native_format(void) {
+#if LV_COLOR_DEPTH == 16
+    return UL_CONVERT_FORMAT_RGB565;
+#else
+    return UL_CONVERT_FORMAT_XRGB8888;
+#endif
+}
+
+size_t ul_convert_get_bytes_per_pixel(ul_convert_format format) {
+    switch (format) {
+    case UL_CONVERT_FORMAT_RGB888:
+        return 3;
+    case UL_CONVERT_FORMAT_RGB565:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+void ul_convert_row(ul_convert_format format, void *dst, const lv_color_t *src, size_t num_pixels) {
+    const ul_blend_kernel kernel = ul_blend_get_kernel();
+    if (selected_kernel != (int)kernel) {
+        select_converters(kernel);
+    }
+    converters[format](dst, (const src_pixel *)src, num_pixels);
+}
+
+bool ul_convert_run_benchmark(void) {
+    src_pixel *src = malloc(BENCHMARK_PIXELS * sizeof(src_pixel));
+    uint32_t *expected = malloc(BENCHMARK_PIXELS * sizeof(uint32_t));
+    uint32_t *pixels = malloc(BENCHMARK_PIXELS * sizeof(uint32_t));
+    if (!src || !expected || !pixels) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for conversion benchmark");
+        free(src);
+        free(expected);
+        free(pixels);
+        return false;
+    }
+
+    uint32_t state = 0x12345678;
+    for (size_t i = 0; i < BENCHMARK_PIXELS; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        src[i] = (src_pixel)(0xff000000u | state);
+    }
+
+    const ul_blend_kernel original_kernel = ul_blend_get_kernel();
+    bool is_identical = true;
+
+    printf("%-12s %-8s %16s %10s\n", "format", "kernel", "convert Mpx/s", "speedup");
+    for (int format = UL_CONVERT_FORMAT_XRGB8888; format < NUM_FORMATS; ++format) {
+        const size_t num_bytes = BENCHMARK_PIXELS * ul_convert_get_bytes_per_pixel((ul_convert_format)format);
+        double scalar_ns = 0.0;
+
+        select_converters(UL_BLEND_KERNEL_SCALAR);
+        converters[format](expected, src, BENCHMARK_PIXELS);
+
+        for (int kernel = UL_BLEND_KERNEL_SCALAR; kernel <= UL_BLEND_KERNEL_NEON; ++kernel) {
+            if (!ul_blend_set_kernel((ul_blend_kernel)kernel)) {
+                continue;
+            }
+            select_converters((ul_blend_kernel)kernel);
+
+            /* Odd lengths exercise the scalar tails */
+            memset(pixels, 0, BENCHMARK_PIXELS * sizeof(uint32_t));
+            converters[format](pixels, src, BENCHMARK_PIXELS - 7);
+            converters[format]((uint8_t *)pixels + num_bytes - 7 * ul_convert_get_bytes_per_pixel((ul_convert_format)format),
+                src + BENCHMARK_PIXELS - 7, 7);
+            const bool is_kernel_identical = memcmp(pixels, expected, num_bytes) == 0;
+            is_identical = is_identical && is_kernel_identical;
+
+            const unsigned long long start_ns = ul_clock_get_ns();
+            for (int round = 0; round < BENCHMARK_ROUNDS; ++round) {
+                converters[format](pixels, src, BENCHMARK_PIXELS);
+            }
+            const double convert_ns = (double)(ul_clock_get_ns() - start_ns);
+            if (kernel == UL_BLEND_KERNEL_SCALAR) {
+                scalar_ns = convert_ns;
+            }
+
+            const double num_pixels = (double)BENCHMARK_PIXELS * BENCHMARK_ROUNDS;
+            printf("%-12s %-8s %16.1f %9.2fx%s\n", ul_convert_get_format_name((ul_convert_format)format),
+                ul_blend_get_kernel_name((ul_blend_kernel)kernel), convert_ns > 0 ? num_pixels * 1000.0 / convert_ns : 0.0,
+                convert_ns > 0 ? scalar_ns / convert_ns : 0.0, is_kernel_identical ? "" : " (output differs from scalar)");
+        }
+    }
+
+    ul_blend_set_kernel(original_kernel);
+
+    free(src);
+    free(expected);
+    free(pixels);
+
+    return is_identical;
+}
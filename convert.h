@@ -0,0 +1,88 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_CONVERT_H
+#define UL_CONVERT_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Pixel formats of display memory
+ */
+typedef enum {
+    /* 32 bit little endian 0xXXRRGGBB */
+    UL_CONVERT_FORMAT_XRGB8888 = 0,
+    /* 32 bit little endian 0xXXBBGGRR */
+    UL_CONVERT_FORMAT_XBGR8888 = 1,
+    /* 24 bit, blue in the first byte */
+    UL_CONVERT_FORMAT_RGB888 = 2,
+    /* 16 bit little endian with 5 bits red, 6 bits green and 5 bits blue */
+    UL_CONVERT_FORMAT_RGB565 = 3,
+    /* 32 bit little endian with 2 bits alpha and 10 bits per colour channel */
+    UL_CONVERT_FORMAT_XRGB2101010 = 4
+} ul_convert_format;
+
+/**
+ * Get the name of a pixel format.
+ *
+ * @param format pixel format
+ * @return the name
+ */
+const char *ul_convert_get_format_name(ul_convert_format format);
+
+/**
+ * Get the format LVGL renders pixels in, as chosen by the colour depth of the build.
+ *
+ * @return the pixel format
+ */
+ul_convert_format ul_convert_get_native_format(void);
+
+/**
+ * Get the number of bytes a pixel takes up in a format.
+ *
+ * @param format pixel format
+ * @return bytes per pixel
+ */
+size_t ul_convert_get_bytes_per_pixel(ul_convert_format format);
+
+/**
+ * Convert a row of pixels rendered by LVGL into another format, using the glyph blending
+ * kernels' instruction set.
+ *
+ * @param format format to convert into
+ * @param dst buffer for num_pixels pixels in the target format
+ * @param src pixels to convert
+ * @param num_pixels number of pixels
+ */
+void ul_convert_row(ul_convert_format format, void *dst, const lv_color_t *src, size_t num_pixels);
+
+/**
+ * Time the conversion into every format with every kernel available on this CPU and print
+ * the results to STDOUT.
+ *
+ * @return true if all kernels produced the same output as the scalar one, false otherwise
+ */
+bool ul_convert_run_benchmark(void);
+
+#endif /* UL_CONVERT_H */
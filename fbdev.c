@@ -0,0 +1,415 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "fbdev.h"
+
+#include "lv_drv_conf.h"
+
+#if USE_FBDEV
+
+#include "convert.h"
+#include "log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/fb.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/**
+ * Defines
+ */
+
+/* Panning is used if the virtual framebuffer has at least 1/PAN_MIN_FRACTION of a screen
+ * to spare, so that the copy on wrapping around happens rarely enough */
+#define PAN_MIN_FRACTION 4
+
+
+/**
+ * Static variables
+ */
+
+static int fd = -1;
+static uint8_t *fbp = NULL;
+static size_t fb_size = 0;
+static struct fb_var_screeninfo vinfo;
+static struct fb_fix_screeninfo finfo;
+static struct fb_var_screeninfo orig_vinfo;
+static ul_convert_format format = UL_CONVERT_FORMAT_XRGB8888;
+static bool is_panning = false;
+static lv_disp_draw_buf_t *direct_buf = NULL;
+static unsigned long long copied_bytes = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get the address of a pixel in the virtual framebuffer.
+ *
+ * @param x column in the visible part
+ * @param y row in the virtual framebuffer
+ * @return the address
+ */
+static uint8_t *get_virtual_pixel(lv_coord_t x, uint32_t y);
+
+/**
+ * Get the address of a pixel in the visible part of the framebuffer.
+ *
+ * @param x column
+ * @param y row
+ * @return the address
+ */
+static uint8_t *get_pixel(lv_coord_t x, lv_coord_t y);
+
+/**
+ * Clip an area to the visible part of the framebuffer.
+ *
+ * @param area area to clip
+ * @param clipped pointer for writing the clipped area into
+ * @return true if any part of the area is visible, false otherwise
+ */
+static bool clip_to_screen(const lv_area_t *area, lv_area_t *clipped);
+
+/**
+ * Determine the framebuffer's pixel format from its colour channel layout.
+ *
+ * @return the pixel format
+ */
+static ul_convert_format detect_format(void);
+
+/**
+ * Enlarge the virtual framebuffer if needed and check if the display can be panned in it.
+ *
+ * @return true if panning can be used for scrolling, false otherwise
+ */
+static bool prepare_panning(void);
+
+/**
+ * Copy a range of pixels between rows of the virtual framebuffer.
+ *
+ * @param dst_y destination row in the virtual framebuffer
+ * @param src_y source row in the virtual framebuffer
+ * @param x1 first column
+ * @param x2 last column
+ */
+static void copy_span(uint32_t dst_y, uint32_t src_y, lv_coord_t x1, lv_coord_t x2);
+
+/**
+ * Copy the parts of a screen row that lie outside of an area between rows of the virtual
+ * framebuffer.
+ *
+ * @param dst_y destination row in the virtual framebuffer
+ * @param src_y source row in the virtual framebuffer
+ * @param y row on the screen
+ * @param area area to leave out
+ */
+static void copy_static_parts(uint32_t dst_y, uint32_t src_y, lv_coord_t y, const lv_area_t *area);
+
+/**
+ * Scroll an area up by panning the display further down the virtual framebuffer. When the end
+ * of the virtual framebuffer is reached, the content is copied back to its start.
+ *
+ * @param area area to scroll, clipped to the screen
+ * @param dy number of pixel rows to move the content by
+ * @return true if the display was panned, false otherwise
+ */
+static bool pan_scroll(const lv_area_t *area, lv_coord_t dy);
+
+/**
+ * Point the direct draw buffer, if any, at the visible part of the framebuffer.
+ */
+static void update_direct_buffer(void);
+
+
+/**
+ * Static functions
+ */
+
+static uint8_t *get_virtual_pixel(lv_coord_t x, uint32_t y) {
+    return fbp + (size_t)y * finfo.line_length + (size_t)(x + vinfo.xoffset) * (vinfo.bits_per_pixel / 8);
+}
+
+static uint8_t *get_pixel(lv_coord_t x, lv_coord_t y) {
+    return get_virtual_pixel(x, y + vinfo.yoffset);
+}
+
+static bool clip_to_screen(const lv_area_t *area, lv_area_t *clipped) {
+    clipped->x1 = LV_MAX(area->x1, 0);
+    clipped->y1 = LV_MAX(area->y1, 0);
+    clipped->x2 = LV_MIN(area->x2, (lv_coord_t)vinfo.xres - 1);
+    clipped->y2 = LV_MIN(area->y2, (lv_coord_t)vinfo.yres - 1);
+    return clipped->x1 <= clipped->x2 && clipped->y1 <= clipped->y2;
+}
+
+static ul_convert_format detect_format(void) {
+    switch (vinfo.bits_per_pixel) {
+    case 16:
+        return UL_CONVERT_FORMAT_RGB565;
+    case 24:
+        return UL_CONVERT_FORMAT_RGB888;
+    default:
+        break;
+    }
+
+    /* Some drivers leave the channel layout empty, assume the common one then */
+    if (vinfo.red.length == 10 && vinfo.green.length == 10 && vinfo.blue.length == 10) {
+        return UL_CONVERT_FORMAT_XRGB2101010;
+    }
+    if (vinfo.red.length == 8 && vinfo.red.offset == 0 && vinfo.blue.offset == 16) {
+        return UL_CONVERT_FORMAT_XBGR8888;
+    }
+    return UL_CONVERT_FORMAT_XRGB8888;
+}
+
+static bool prepare_panning(void) {
+    if (finfo.ypanstep == 0) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Framebuffer cannot pan vertically");
+        return false;
+    }
+
+    /* Ask for a virtual framebuffer twice the screen's height if the memory allows it */
+    const uint32_t max_rows = finfo.smem_len / finfo.line_length;
+    if (vinfo.yres_virtual < 2 * vinfo.yres && max_rows > vinfo.yres_virtual) {
+        struct fb_var_screeninfo request = vinfo;
+        request.yres_virtual = LV_MIN(2 * vinfo.yres, max_rows);
+        if (ioctl(fd, FBIOPUT_VSCREENINFO, &request) < 0) {
+            ul_log(UL_LOG_LEVEL_VERBOSE, "Could not enlarge virtual framebuffer: %s", strerror(errno));
+        }
+        if (ioctl(fd, FBIOGET_FSCREENINFO, &finfo) < 0 || ioctl(fd, FBIOGET_VSCREENINFO, &vinfo) < 0) {
+            return false;
+        }
+    }
+
+    if (vinfo.yres_virtual < vinfo.yres + vinfo.yres / PAN_MIN_FRACTION
+            || (size_t)vinfo.yres_virtual * finfo.line_length > finfo.smem_len) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Virtual framebuffer of %u rows is too small for panning", vinfo.yres_virtual);
+        return false;
+    }
+
+    /* Panning to the current offset tells if the driver implements it at all */
+    if (ioctl(fd, FBIOPAN_DISPLAY, &vinfo) < 0) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Framebuffer does not support panning: %s", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+static void copy_span(uint32_t dst_y, uint32_t src_y, lv_coord_t x1, lv_coord_t x2) {
+    if (x1 <= x2) {
+        memmove(get_virtual_pixel(x1, dst_y), get_virtual_pixel(x1, src_y), (size_t)(x2 - x1 + 1) * (vinfo.bits_per_pixel / 8));
+    }
+}
+
+static void copy_static_parts(uint32_t dst_y, uint32_t src_y, lv_coord_t y, const lv_area_t *area) {
+    const lv_coord_t x_max = (lv_coord_t)vinfo.xres - 1;
+    if (y < area->y1 || y > area->y2) {
+        copy_span(dst_y, src_y, 0, x_max);
+    } else {
+        copy_span(dst_y, src_y, 0, area->x1 - 1);
+        copy_span(dst_y, src_y, area->x2 + 1, x_max);
+    }
+}
+
+static bool pan_scroll(const lv_area_t *area, lv_coord_t dy) {
+    if (dy % finfo.ypanstep != 0) {
+        return false;
+    }
+
+    const uint32_t old_y = vinfo.yoffset;
+    const bool wraps = old_y + dy + vinfo.yres > vinfo.yres_virtual;
+    const uint32_t new_y = wraps ? 0 : old_y + dy;
+    const lv_coord_t num_rows = (lv_coord_t)vinfo.yres;
+
+    if (wraps) {
+        /* Destination rows lie before their sources, copying top to bottom keeps the sources intact */
+        for (lv_coord_t y = 0; y < num_rows; ++y) {
+            copy_static_parts(new_y + y, old_y + y, y, area);
+            if (y >= area->y1 && y <= area->y2 - dy) {
+                copy_span(new_y + y, old_y + y + dy, area->x1, area->x2);
+            }
+        }
+    } else {
+        /* The area's rows are already in place below the screen, only the rest has to follow */
+        for (lv_coord_t y = num_rows - 1; y >= 0; --y) {
+            copy_static_parts(new_y + y, old_y + y, y, area);
+        }
+    }
+
+    struct fb_var_screeninfo request = vinfo;
+    request.yoffset = new_y;
+    if (ioctl(fd, FBIOPAN_DISPLAY, &request) < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not pan framebuffer, falling back to moving pixels: %s", strerror(errno));
+        is_panning = false;
+        return false;
+    }
+    vinfo.yoffset = new_y;
+    update_direct_buffer();
+
+    return true;
+}
+
+static void update_direct_buffer(void) {
+    if (direct_buf) {
+        direct_buf->buf1 = (lv_color_t *)get_pixel(0, 0);
+        direct_buf->buf_act = direct_buf->buf1;
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_fbdev_init(const char *path, bool allow_panning) {
+    fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not open framebuffer device %s", path);
+        return false;
+    }
+
+    /* Make sure that the display is on */
+    ioctl(fd, FBIOBLANK, FB_BLANK_UNBLANK);
+
+    if (ioctl(fd, FBIOGET_FSCREENINFO, &finfo) < 0 || ioctl(fd, FBIOGET_VSCREENINFO, &vinfo) < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not query framebuffer device %s", path);
+        ul_fbdev_exit();
+        return false;
+    }
+
+    if (vinfo.bits_per_pixel != 16 && vinfo.bits_per_pixel != 24 && vinfo.bits_per_pixel != 32) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Unsupported framebuffer depth of %u bits", vinfo.bits_per_pixel);
+        ul_fbdev_exit();
+        return false;
+    }
+
+    format = detect_format();
+    orig_vinfo = vinfo;
+    is_panning = allow_panning && prepare_panning();
+
+    fb_size = finfo.smem_len;
+    void *map = mmap(NULL, fb_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not map framebuffer device %s", path);
+        ul_fbdev_exit();
+        return false;
+    }
+    fbp = map;
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Framebuffer is %ux%u in %s, %u bytes per line, %s",
+        vinfo.xres, vinfo.yres, ul_convert_get_format_name(format), finfo.line_length, is_panning ? "scrolling by panning" : "not panning");
+    if ((format == UL_CONVERT_FORMAT_RGB565 || format == UL_CONVERT_FORMAT_XRGB8888) && format != ul_convert_get_native_format()) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Rendering at %d bits per pixel, a build with -Dcolor-depth=%s would copy pixels without converting them",
+            LV_COLOR_DEPTH, format == UL_CONVERT_FORMAT_RGB565 ? "16" : "32");
+    }
+    return true;
+}
+
+bool ul_fbdev_init_direct_buffer(lv_disp_draw_buf_t *draw_buf) {
+    if (!fbp || format != ul_convert_get_native_format() || finfo.line_length != vinfo.xres * sizeof(lv_color_t)) {
+        return false;
+    }
+
+    lv_disp_draw_buf_init(draw_buf, (lv_color_t *)get_pixel(0, 0), NULL, vinfo.xres * vinfo.yres);
+    direct_buf = draw_buf;
+    return true;
+}
+
+void ul_fbdev_exit(void) {
+    /* Leave the display as it was found */
+    if (fd >= 0 && orig_vinfo.yres_virtual > 0
+            && (vinfo.yoffset != orig_vinfo.yoffset || vinfo.yres_virtual != orig_vinfo.yres_virtual)) {
+        ioctl(fd, FBIOPUT_VSCREENINFO, &orig_vinfo);
+    }
+    is_panning = false;
+    direct_buf = NULL;
+
+    if (fbp) {
+        munmap(fbp, fb_size);
+        fbp = NULL;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void ul_fbdev_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi) {
+    *width = vinfo.xres;
+    *height = vinfo.yres;
+    if (dpi) {
+        /* The physical width is given in millimetres */
+        *dpi = vinfo.width > 0 ? (vinfo.xres * 254 + vinfo.width * 5) / (vinfo.width * 10) : 0;
+    }
+}
+
+void ul_fbdev_write(const lv_area_t *area, const lv_color_t *color_p) {
+    lv_area_t clipped;
+    if (!fbp || direct_buf || !clip_to_screen(area, &clipped)) {
+        return;
+    }
+
+    const lv_coord_t src_width = lv_area_get_width(area);
+    const lv_coord_t width = lv_area_get_width(&clipped);
+
+    for (lv_coord_t y = clipped.y1; y <= clipped.y2; ++y) {
+        const lv_color_t *src = color_p + (size_t)(y - area->y1) * src_width + (clipped.x1 - area->x1);
+        ul_convert_row(format, get_pixel(clipped.x1, y), src, (size_t)width);
+    }
+    copied_bytes += (unsigned long long)lv_area_get_size(&clipped) * (vinfo.bits_per_pixel / 8);
+}
+
+bool ul_fbdev_blit_scroll(const lv_area_t *area, lv_coord_t dy) {
+    lv_area_t clipped;
+    if (!fbp || dy <= 0 || !clip_to_screen(area, &clipped) || lv_area_get_height(&clipped) <= dy) {
+        return false;
+    }
+
+    if (is_panning && pan_scroll(&clipped, dy)) {
+        return true;
+    }
+
+    const size_t bytes_per_pixel = vinfo.bits_per_pixel / 8;
+    const size_t row_bytes = (size_t)lv_area_get_width(&clipped) * bytes_per_pixel;
+    const lv_coord_t num_rows = lv_area_get_height(&clipped) - dy;
+
+    if (row_bytes == finfo.line_length) {
+        /* Full-width rows are contiguous, the whole block moves at once */
+        memmove(get_pixel(clipped.x1, clipped.y1), get_pixel(clipped.x1, clipped.y1 + dy), row_bytes * num_rows);
+    } else {
+        /* Source and destination rows never overlap, moving top to bottom keeps the source intact */
+        for (lv_coord_t y = clipped.y1; y < clipped.y1 + num_rows; ++y) {
+            memcpy(get_pixel(clipped.x1, y), get_pixel(clipped.x1, y + dy), row_bytes);
+        }
+    }
+
+    return true;
+}
+
+void ul_fbdev_get_stats(ul_fbdev_stats *stats) {
+    stats->copied_bytes = copied_bytes;
+}
+
+#endif /* USE_FBDEV */
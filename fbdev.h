@@ -0,0 +1,98 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_FBDEV_H
+#define UL_FBDEV_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Framebuffer statistics
+ */
+typedef struct {
+    /* Bytes copied from LVGL's draw buffer into the framebuffer */
+    unsigned long long copied_bytes;
+} ul_fbdev_stats;
+
+/**
+ * Open and map a framebuffer device.
+ *
+ * @param path device path
+ * @param allow_panning if true, scroll by panning the display within a taller virtual
+ * framebuffer when the device supports it
+ * @return true on success, false otherwise
+ */
+bool ul_fbdev_init(const char *path, bool allow_panning);
+
+/**
+ * Let LVGL render straight into the visible part of the framebuffer, if its pixel layout
+ * matches LVGL's. The buffer follows the display when it is panned. Requires the display
+ * driver to use direct mode.
+ *
+ * @param draw_buf draw buffer to initialise, must stay valid while the device is open
+ * @return true if the draw buffer was set up, false if a separate buffer is needed
+ */
+bool ul_fbdev_init_direct_buffer(lv_disp_draw_buf_t *draw_buf);
+
+/**
+ * Restore the framebuffer's original panning, unmap and close the device.
+ */
+void ul_fbdev_exit(void);
+
+/**
+ * Get the size of the framebuffer device's display.
+ *
+ * @param width pointer for writing the horizontal resolution into
+ * @param height pointer for writing the vertical resolution into
+ * @param dpi pointer for writing the DPI into (0 if unknown), may be NULL
+ */
+void ul_fbdev_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi);
+
+/**
+ * Copy rendered pixels to the framebuffer unless they were rendered into it directly. Used as
+ * write callback of ul_flush and safe to call from its worker thread.
+ *
+ * @param area area to write to
+ * @param color_p pixels of the area, row by row
+ */
+void ul_fbdev_write(const lv_area_t *area, const lv_color_t *color_p);
+
+/**
+ * Move the pixels of an area of the framebuffer up, leaving the bottom rows unchanged. If
+ * panning is enabled, the display is panned down instead and everything outside the area is
+ * copied along so that it appears to stay in place.
+ *
+ * @param area area to scroll
+ * @param dy number of pixel rows to move the content by
+ * @return true if the pixels were moved, false otherwise
+ */
+bool ul_fbdev_blit_scroll(const lv_area_t *area, lv_coord_t dy);
+
+/**
+ * Get framebuffer statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_fbdev_get_stats(ul_fbdev_stats *stats);
+
+#endif /* UL_FBDEV_H */
@@ -0,0 +1,172 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "flush.h"
+
+#include "clock.h"
+#include "log.h"
+
+#include <pthread.h>
+
+
+/**
+ * Static variables
+ */
+
+static ul_flush_write_cb_t write_cb = NULL;
+static bool is_async = false;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+/* Area waiting for or being written by the worker, guarded by mutex */
+static lv_disp_drv_t *job_drv = NULL;
+static lv_area_t job_area;
+static const lv_color_t *job_color_p = NULL;
+static bool is_busy = false;
+
+static unsigned long num_flushes = 0;
+static unsigned long long write_us = 0;
+static unsigned long long wait_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Write the areas handed over by ul_flush_cb.
+ *
+ * @param arg unused
+ * @return never returns
+ */
+static void *worker_thread(void *arg);
+
+
+/**
+ * Static functions
+ */
+
+static void *worker_thread(void *arg) {
+    LV_UNUSED(arg);
+
+    pthread_mutex_lock(&mutex);
+    while (1) {
+        while (!job_drv) {
+            pthread_cond_wait(&cond, &mutex);
+        }
+        lv_disp_drv_t *drv = job_drv;
+        const lv_area_t area = job_area;
+        const lv_color_t *color_p = job_color_p;
+        pthread_mutex_unlock(&mutex);
+
+        const int64_t start_us = ul_clock_get_us();
+        write_cb(&area, color_p);
+        const int64_t elapsed_us = ul_clock_get_us() - start_us;
+
+        /* Release the draw buffer under the mutex so that LVGL, waiting in ul_flush_wait_cb,
+         * sees the finished writes */
+        pthread_mutex_lock(&mutex);
+        write_us += (unsigned long long)elapsed_us;
+        job_drv = NULL;
+        is_busy = false;
+        lv_disp_flush_ready(drv);
+        pthread_cond_broadcast(&cond);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_flush_init(ul_flush_write_cb_t cb, bool async) {
+    write_cb = cb;
+    is_async = false;
+
+    if (!async) {
+        return true;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, worker_thread, NULL) != 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not start flush thread, flushing synchronously");
+        return false;
+    }
+    pthread_detach(thread);
+    is_async = true;
+
+    return true;
+}
+
+void ul_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    ++num_flushes;
+
+    if (!is_async) {
+        /* LVGL can't do anything else while the area is written */
+        const int64_t start_us = ul_clock_get_us();
+        write_cb(area, color_p);
+        const int64_t elapsed_us = ul_clock_get_us() - start_us;
+        write_us += (unsigned long long)elapsed_us;
+        wait_us += (unsigned long long)elapsed_us;
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+
+    /* LVGL waits for the previous area before flushing the next one */
+    pthread_mutex_lock(&mutex);
+    job_drv = disp_drv;
+    job_area = *area;
+    job_color_p = color_p;
+    is_busy = true;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+void ul_flush_wait_cb(lv_disp_drv_t *disp_drv) {
+    LV_UNUSED(disp_drv);
+
+    const int64_t start_us = ul_clock_get_us();
+    ul_flush_wait_idle();
+    wait_us += (unsigned long long)(ul_clock_get_us() - start_us);
+}
+
+void ul_flush_wait_idle(void) {
+    if (!is_async) {
+        return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    while (is_busy) {
+        pthread_cond_wait(&cond, &mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void ul_flush_get_stats(ul_flush_stats *stats) {
+    pthread_mutex_lock(&mutex);
+    stats->flushes = num_flushes;
+    stats->write_us = write_us;
+    stats->wait_us = wait_us;
+    stats->is_async = is_async;
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,90 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_FLUSH_H
+#define UL_FLUSH_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+
+/**
+ * Flushing statistics
+ */
+typedef struct {
+    /* Number of areas flushed */
+    unsigned long flushes;
+    /* Time spent writing areas to the display (in microseconds) */
+    unsigned long long write_us;
+    /* Time LVGL was blocked by flushing, either writing itself or waiting for the worker (in microseconds) */
+    unsigned long long wait_us;
+    /* True if areas are written on a worker thread */
+    bool is_async;
+} ul_flush_stats;
+
+/**
+ * Callback for writing the pixels of an area to the display
+ *
+ * @param area area to write to
+ * @param color_p pixels of the area, row by row
+ */
+typedef void (*ul_flush_write_cb_t)(const lv_area_t *area, const lv_color_t *color_p);
+
+/**
+ * Set up flushing through a write callback.
+ *
+ * @param write_cb callback for writing areas to the display
+ * @param async if true, write areas on a worker thread so that LVGL can render into its other
+ * draw buffer in the meantime
+ * @return true on success, false if the worker could not be started and areas are written synchronously
+ */
+bool ul_flush_init(ul_flush_write_cb_t write_cb, bool async);
+
+/**
+ * Write an area to the display and signal LVGL once done, possibly on the worker thread. Used
+ * as LVGL flush callback.
+ *
+ * @param disp_drv display driver
+ * @param area area to write to
+ * @param color_p pixels of the area, row by row
+ */
+void ul_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Block until the worker has written the current area. Used as LVGL wait callback.
+ *
+ * @param disp_drv display driver
+ */
+void ul_flush_wait_cb(lv_disp_drv_t *disp_drv);
+
+/**
+ * Block until all areas handed to the worker are on the display. Call this before touching
+ * the display's pixels outside of LVGL.
+ */
+void ul_flush_wait_idle(void);
+
+/**
+ * Get flushing statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_flush_get_stats(ul_flush_stats *stats);
+
+#endif /* UL_FLUSH_H */
@@ -0,0 +1,252 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "font.h"
+
+#include "log.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+/* Code points covered by lv_font_unscii_16 */
+#define FIRST_CODEPOINT 0x20
+#define LAST_CODEPOINT 0x7f
+#define NUM_GLYPHS (LAST_CODEPOINT - FIRST_CODEPOINT + 1)
+
+/* Pixel density at which the unscaled font has a comfortable size, the scale is the multiple
+ * of it closest to the display's density */
+#define DPI_PER_SCALE 160
+
+
+/**
+ * Static variables
+ */
+
+/* Precomputed glyphs of a scaled font */
+typedef struct {
+    /* Descriptors of all glyphs in font pixels */
+    lv_font_glyph_dsc_t glyphs[NUM_GLYPHS];
+    /* Bitmaps in the base font's bit depth, NULL for glyphs the base font lacks */
+    const uint8_t *bitmaps[NUM_GLYPHS];
+    /* True for glyphs present in the base font */
+    bool has_glyph[NUM_GLYPHS];
+    /* Memory holding all bitmaps */
+    uint8_t *data;
+} scaled_glyphs;
+
+static lv_font_t scaled_fonts[UL_FONT_MAX_SCALE + 1];
+static scaled_glyphs glyph_sets[UL_FONT_MAX_SCALE + 1];
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get the descriptor of a glyph of a scaled font. Used as get_glyph_dsc callback.
+ *
+ * @param font scaled font
+ * @param dsc pointer for writing the descriptor into
+ * @param letter code point
+ * @param letter_next following code point (unused, the font has no kerning)
+ * @return true if the font has the glyph, false otherwise
+ */
+static bool get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next);
+
+/**
+ * Get the bitmap of a glyph of a scaled font. Used as get_glyph_bitmap callback.
+ *
+ * @param font scaled font
+ * @param letter code point
+ * @return the bitmap or NULL if the font has no such glyph
+ */
+static const uint8_t *get_glyph_bitmap(const lv_font_t *font, uint32_t letter);
+
+/**
+ * Get the number of bytes of a glyph bitmap. Rows are packed without padding.
+ *
+ * @param dsc glyph descriptor
+ * @return size in bytes
+ */
+static size_t get_bitmap_size(const lv_font_glyph_dsc_t *dsc);
+
+/**
+ * Scale up a glyph bitmap, repeating every pixel scale times in both directions.
+ *
+ * @param src bitmap to scale
+ * @param dsc descriptor of the unscaled glyph
+ * @param scale scale factor
+ * @param dst zeroed buffer for the scaled bitmap
+ */
+static void scale_bitmap(const uint8_t *src, const lv_font_glyph_dsc_t *dsc, int scale, uint8_t *dst);
+
+/**
+ * Build the glyphs and metrics of a scaled font.
+ *
+ * @param base font to scale
+ * @param scale scale factor
+ * @return true on success, false if memory is short
+ */
+static bool build_font(const lv_font_t *base, int scale);
+
+
+/**
+ * Static functions
+ */
+
+static bool get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next) {
+    LV_UNUSED(letter_next);
+
+    const scaled_glyphs *set = font->dsc;
+    if (letter < FIRST_CODEPOINT || letter > LAST_CODEPOINT || !set->has_glyph[letter - FIRST_CODEPOINT]) {
+        return false;
+    }
+
+    *dsc = set->glyphs[letter - FIRST_CODEPOINT];
+    return true;
+}
+
+static const uint8_t *get_glyph_bitmap(const lv_font_t *font, uint32_t letter) {
+    const scaled_glyphs *set = font->dsc;
+    if (letter < FIRST_CODEPOINT || letter > LAST_CODEPOINT) {
+        return NULL;
+    }
+    return set->bitmaps[letter - FIRST_CODEPOINT];
+}
+
+static size_t get_bitmap_size(const lv_font_glyph_dsc_t *dsc) {
+    return ((size_t)dsc->box_w * dsc->box_h * dsc->bpp + 7) / 8;
+}
+
+static void scale_bitmap(const uint8_t *src, const lv_font_glyph_dsc_t *dsc, int scale, uint8_t *dst) {
+    const uint8_t bpp = dsc->bpp;
+    const uint32_t dst_width = (uint32_t)dsc->box_w * scale;
+    uint32_t src_pos = 0;
+
+    /* Pixels take bpp bits each, the first one in the most significant bits of a byte */
+    for (int y = 0; y < dsc->box_h; ++y) {
+        for (int x = 0; x < dsc->box_w; ++x, src_pos += bpp) {
+            for (uint8_t b = 0; b < bpp; ++b) {
+                const uint32_t pos = src_pos + b;
+                if (!((src[pos >> 3] >> (7 - (pos & 7))) & 1)) {
+                    continue;
+                }
+
+                for (int dy = 0; dy < scale; ++dy) {
+                    const uint32_t row_pos = ((uint32_t)(y * scale + dy) * dst_width + (uint32_t)x * scale) * bpp + b;
+                    for (int dx = 0; dx < scale; ++dx) {
+                        const uint32_t dst_pos = row_pos + (uint32_t)dx * bpp;
+                        dst[dst_pos >> 3] |= (uint8_t)(0x80 >> (dst_pos & 7));
+                    }
+                }
+            }
+        }
+    }
+}
+
+static bool build_font(const lv_font_t *base, int scale) {
+    scaled_glyphs *set = &(glyph_sets[scale]);
+    size_t total_size = 0;
+
+    for (uint32_t letter = FIRST_CODEPOINT; letter <= LAST_CODEPOINT; ++letter) {
+        lv_font_glyph_dsc_t dsc;
+        if (!lv_font_get_glyph_dsc(base, &dsc, letter, 0)) {
+            continue;
+        }
+
+        lv_font_glyph_dsc_t *glyph = &(set->glyphs[letter - FIRST_CODEPOINT]);
+        *glyph = dsc;
+        glyph->resolved_font = NULL;
+        glyph->adv_w = (uint16_t)(dsc.adv_w * scale);
+        glyph->box_w = (uint16_t)(dsc.box_w * scale);
+        glyph->box_h = (uint16_t)(dsc.box_h * scale);
+        glyph->ofs_x = (int16_t)(dsc.ofs_x * scale);
+        glyph->ofs_y = (int16_t)(dsc.ofs_y * scale);
+        set->has_glyph[letter - FIRST_CODEPOINT] = true;
+        total_size += get_bitmap_size(glyph);
+    }
+
+    set->data = calloc(total_size > 0 ? total_size : 1, 1);
+    if (!set->data) {
+        return false;
+    }
+
+    size_t offset = 0;
+    for (uint32_t letter = FIRST_CODEPOINT; letter <= LAST_CODEPOINT; ++letter) {
+        const int i = letter - FIRST_CODEPOINT;
+        lv_font_glyph_dsc_t dsc;
+        if (!set->has_glyph[i] || !lv_font_get_glyph_dsc(base, &dsc, letter, 0)) {
+            continue;
+        }
+
+        const lv_font_t *resolved_font = dsc.resolved_font ? dsc.resolved_font : base;
+        const uint8_t *bitmap = dsc.box_w > 0 && dsc.box_h > 0 ? lv_font_get_glyph_bitmap(resolved_font, letter) : NULL;
+        if (!bitmap) {
+            continue;
+        }
+
+        scale_bitmap(bitmap, &dsc, scale, set->data + offset);
+        set->bitmaps[i] = set->data + offset;
+        offset += get_bitmap_size(&(set->glyphs[i]));
+    }
+
+    lv_font_t *font = &(scaled_fonts[scale]);
+    font->get_glyph_dsc = get_glyph_dsc;
+    font->get_glyph_bitmap = get_glyph_bitmap;
+    font->line_height = (lv_coord_t)(base->line_height * scale);
+    font->base_line = (lv_coord_t)(base->base_line * scale);
+    font->subpx = base->subpx;
+    font->underline_position = (int8_t)(base->underline_position * scale);
+    font->underline_thickness = (int8_t)(base->underline_thickness * scale);
+    font->dsc = set;
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Scaled terminal font by %d (%zu bytes of glyphs)", scale, total_size);
+    return true;
+}
+
+
+/**
+ * Public functions
+ */
+
+int ul_font_get_scale_for_dpi(uint32_t dpi) {
+    const int scale = (int)((dpi + DPI_PER_SCALE / 2) / DPI_PER_SCALE);
+    return scale < 1 ? 1 : (scale > UL_FONT_MAX_SCALE ? UL_FONT_MAX_SCALE : scale);
+}
+
+const lv_font_t *ul_font_get_terminal(int scale) {
+    const lv_font_t *base = &lv_font_unscii_16;
+    if (scale <= 1 || scale > UL_FONT_MAX_SCALE) {
+        return base;
+    }
+
+    if (!glyph_sets[scale].data && !build_font(base, scale)) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not allocate memory for terminal font scaled by %d", scale);
+        return base;
+    }
+
+    return &(scaled_fonts[scale]);
+}
@@ -0,0 +1,49 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_FONT_H
+#define UL_FONT_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdint.h>
+
+/* Largest integer factor the terminal font is scaled by */
+#define UL_FONT_MAX_SCALE 3
+
+/**
+ * Pick the integer factor the terminal font should be scaled by on a display.
+ *
+ * @param dpi pixel density of the display, 0 if unknown
+ * @return scale between 1 and UL_FONT_MAX_SCALE
+ */
+int ul_font_get_scale_for_dpi(uint32_t dpi);
+
+/**
+ * Get the terminal font (lv_font_unscii_16) scaled up by an integer factor. Every pixel of the
+ * bitmap font becomes a square block, so glyphs stay as crisp as the original. All glyphs of a
+ * scale are computed on the first call, drawing them costs the same as drawing unscaled ones.
+ *
+ * @param scale factor between 1 and UL_FONT_MAX_SCALE
+ * @return the scaled font, or the unscaled one if scale is 1 or memory is short
+ */
+const lv_font_t *ul_font_get_terminal(int scale);
+
+#endif /* UL_FONT_H */
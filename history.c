@@ -0,0 +1,600 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "history.h"
+
+#include "log.h"
+#include "lz.h"
+#include "spill.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+/* Serialised row header: 16-bit length and flags */
+#define ROW_HEADER_SIZE 3
+/* Serialised cell: three code point bytes, two attribute bytes and the width, each in its own plane */
+#define CELL_SIZE 6
+
+
+/**
+ * Static variables
+ */
+
+static int total_blocks = 0;
+static long total_lines = 0;
+static size_t total_raw_bytes = 0;
+static size_t total_compressed_bytes = 0;
+static unsigned long total_decompressions = 0;
+static size_t resident_bytes = 0;
+static size_t memory_budget = 0;
+static unsigned long total_spills = 0;
+static unsigned long total_evictions = 0;
+static size_t total_filter_bytes = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Fill a range of cells with blanks in the default rendition without releasing references.
+ *
+ * @param cells first cell
+ * @param n number of cells
+ */
+static void blank_cells(ul_cell *cells, int n);
+
+/**
+ * Get a block by its position.
+ *
+ * @param history history
+ * @param i position (0 is the oldest block)
+ * @return the block
+ */
+static ul_history_block *get_block(ul_history *history, int i);
+
+/**
+ * Get a block by its position.
+ *
+ * @param history history
+ * @param i position (0 is the oldest block)
+ * @return the block
+ */
+static const ul_history_block *get_const_block(const ul_history *history, int i);
+
+/**
+ * Add the characters, bigrams and trigrams of a row to a block filter.
+ *
+ * @param filter block filter
+ * @param row row to index
+ */
+static void add_to_filter(uint64_t *filter, const ul_row *row);
+
+/**
+ * Get the memory an uncompressed block of lines occupies.
+ *
+ * @param history history
+ * @return number of bytes
+ */
+static size_t get_raw_block_size(const ul_history *history);
+
+/**
+ * Compress the pending lines into a new block.
+ *
+ * @param history history
+ * @return true on success, false otherwise
+ */
+static bool compress_pending(ul_history *history);
+
+/**
+ * Release the pending lines.
+ *
+ * @param history history
+ */
+static void clear_pending(ul_history *history);
+
+/**
+ * Drop the oldest block.
+ *
+ * @param history history
+ */
+static void drop_oldest_block(ul_history *history);
+
+/**
+ * Move least recently used blocks out of memory until the memory budget is met.
+ *
+ * @param history history
+ */
+static void enforce_budget(ul_history *history);
+
+/**
+ * Decompress a block into the cache unless it is already present.
+ *
+ * @param history history
+ * @param block block to decompress
+ * @return the cache entry holding the block's rows or NULL on failure
+ */
+static ul_history_cache_entry *thaw_block(ul_history *history, ul_history_block *block);
+
+
+/**
+ * Static functions
+ */
+
+static void blank_cells(ul_cell *cells, int n) {
+    for (int i = 0; i < n; ++i) {
+        cells[i] = (ul_cell){ .codepoint = 0, .attr = UL_ATTR_DEFAULT_ID, .width = 1, .reserved = 0 };
+    }
+}
+
+static ul_history_block *get_block(ul_history *history, int i) {
+    return &(history->blocks[(history->blocks_head + i) % history->blocks_capacity]);
+}
+
+static const ul_history_block *get_const_block(const ul_history *history, int i) {
+    return &(history->blocks[(history->blocks_head + i) % history->blocks_capacity]);
+}
+
+static void add_to_filter(uint64_t *filter, const ul_row *row) {
+    for (int x = 0; x < row->len; ++x) {
+        uint32_t a = ul_history_fold(row->cells[x].codepoint);
+        uint32_t b = x + 1 < row->len ? ul_history_fold(row->cells[x + 1].codepoint) : 0;
+        uint32_t c = x + 2 < row->len ? ul_history_fold(row->cells[x + 2].codepoint) : 0;
+        uint32_t bits[3] = { ul_history_get_trigram_bit(a, 0, 0), ul_history_get_trigram_bit(a, b, 0), ul_history_get_trigram_bit(a, b, c) };
+        for (int i = 0; i < 3; ++i) {
+            filter[bits[i] / 64] |= (uint64_t)1 << (bits[i] % 64);
+        }
+    }
+}
+
+static size_t get_raw_block_size(const ul_history *history) {
+    return UL_HISTORY_BLOCK_LINES * (sizeof(ul_row *) + sizeof(ul_row) + history->cols * sizeof(ul_cell));
+}
+
+static bool compress_pending(ul_history *history) {
+    int num_cells = 0;
+    for (int i = 0; i < history->num_pending; ++i) {
+        num_cells += history->pending[i].len;
+    }
+
+    size_t raw_size = history->num_pending * ROW_HEADER_SIZE + num_cells * CELL_SIZE;
+    size_t bound = ul_lz_compress_bound(raw_size);
+    uint8_t *raw = malloc(raw_size + bound);
+    if (!raw) {
+        return false;
+    }
+    uint8_t *compressed = raw + raw_size;
+
+    /* Split cells into byte planes, the high code point bytes and the attributes are long runs */
+    uint8_t *header = raw;
+    uint8_t *planes[CELL_SIZE];
+    for (int p = 0; p < CELL_SIZE; ++p) {
+        planes[p] = raw + history->num_pending * ROW_HEADER_SIZE + p * num_cells;
+    }
+
+    uint8_t seen[UL_ATTR_TABLE_SIZE / 8];
+    ul_attr_id attrs[UL_ATTR_TABLE_SIZE];
+    int num_attrs = 0;
+    memset(seen, 0, sizeof(seen));
+
+    int c = 0;
+    for (int i = 0; i < history->num_pending; ++i) {
+        const ul_row *row = &(history->pending[i]);
+        *header++ = (uint8_t)(row->len & 0xff);
+        *header++ = (uint8_t)(row->len >> 8);
+        *header++ = row->flags;
+
+        for (int x = 0; x < row->len; ++x, ++c) {
+            const ul_cell *cell = &(row->cells[x]);
+            planes[0][c] = (uint8_t)(cell->codepoint & 0xff);
+            planes[1][c] = (uint8_t)((cell->codepoint >> 8) & 0xff);
+            planes[2][c] = (uint8_t)((cell->codepoint >> 16) & 0xff);
+            planes[3][c] = (uint8_t)(cell->attr & 0xff);
+            planes[4][c] = (uint8_t)(cell->attr >> 8);
+            planes[5][c] = cell->width;
+
+            if (!(seen[cell->attr / 8] & (1 << (cell->attr % 8)))) {
+                seen[cell->attr / 8] |= (uint8_t)(1 << (cell->attr % 8));
+                attrs[num_attrs++] = cell->attr;
+            }
+        }
+    }
+
+    size_t size = ul_lz_compress(raw, raw_size, compressed, bound);
+    ul_history_block *block = get_block(history, history->num_blocks);
+    block->data = size > 0 ? malloc(size) : NULL;
+    block->attrs = malloc(num_attrs * sizeof(ul_attr_id) + 1);
+    block->filter = calloc(UL_HISTORY_FILTER_BITS / 64, sizeof(uint64_t));
+    if (!block->data || !block->attrs || !block->filter) {
+        free(block->data);
+        free(block->attrs);
+        free(block->filter);
+        free(raw);
+        return false;
+    }
+
+    /* Index the lines while they are still at hand so that searches can skip the block */
+    for (int i = 0; i < history->num_pending; ++i) {
+        add_to_filter(block->filter, &(history->pending[i]));
+    }
+
+    memcpy(block->data, compressed, size);
+    block->is_spilled = false;
+    block->last_use = ++history->use_counter;
+    block->size = (uint32_t)size;
+    block->raw_size = (uint32_t)raw_size;
+    memcpy(block->attrs, attrs, num_attrs * sizeof(ul_attr_id));
+    block->num_attrs = (uint16_t)num_attrs;
+    free(raw);
+
+    /* The block holds a single reference per attribute set instead of one per cell */
+    for (int i = 0; i < num_attrs; ++i) {
+        ul_attr_ref(attrs[i]);
+    }
+    clear_pending(history);
+
+    ++history->num_blocks;
+    ++total_blocks;
+    total_lines += UL_HISTORY_BLOCK_LINES;
+    total_raw_bytes += get_raw_block_size(history);
+    total_compressed_bytes += sizeof(ul_history_block) + block->size + block->num_attrs * sizeof(ul_attr_id);
+    resident_bytes += block->size;
+    total_filter_bytes += UL_HISTORY_FILTER_BITS / 8;
+
+    enforce_budget(history);
+
+    return true;
+}
+
+static void clear_pending(ul_history *history) {
+    for (int i = 0; i < history->num_pending; ++i) {
+        ul_row *row = &(history->pending[i]);
+        for (int x = 0; x < history->cols; ++x) {
+            ul_attr_unref(row->cells[x].attr);
+        }
+        blank_cells(row->cells, history->cols);
+        row->len = 0;
+        row->flags = 0;
+    }
+    history->num_pending = 0;
+}
+
+static void drop_oldest_block(ul_history *history) {
+    ul_history_block *block = get_block(history, 0);
+
+    for (int i = 0; i < UL_HISTORY_CACHE_BLOCKS; ++i) {
+        if (history->cache[i].block == block) {
+            history->cache[i].block = NULL;
+        }
+    }
+
+    for (int i = 0; i < block->num_attrs; ++i) {
+        ul_attr_unref(block->attrs[i]);
+    }
+
+    --total_blocks;
+    total_lines -= UL_HISTORY_BLOCK_LINES;
+    total_raw_bytes -= get_raw_block_size(history);
+    total_compressed_bytes -= sizeof(ul_history_block) + block->size + block->num_attrs * sizeof(ul_attr_id);
+
+    if (block->is_spilled) {
+        ul_spill_free(block->spill_offset, block->size);
+    } else {
+        resident_bytes -= block->size;
+        free(block->data);
+    }
+    free(block->attrs);
+    free(block->filter);
+    total_filter_bytes -= UL_HISTORY_FILTER_BITS / 8;
+    memset(block, 0, sizeof(ul_history_block));
+
+    history->blocks_head = (history->blocks_head + 1) % history->blocks_capacity;
+    --history->num_blocks;
+}
+
+static void enforce_budget(ul_history *history) {
+    while (memory_budget > 0 && resident_bytes > memory_budget && history->num_blocks > 0) {
+        ul_history_block *lru = NULL;
+        for (int i = 0; i < history->num_blocks; ++i) {
+            ul_history_block *block = get_block(history, i);
+            if (!block->is_spilled && (!lru || block->last_use < lru->last_use)) {
+                lru = block;
+            }
+        }
+
+        if (lru && ul_spill_store(lru->data, lru->size, &(lru->spill_offset))) {
+            free(lru->data);
+            lru->data = NULL;
+            lru->is_spilled = true;
+            resident_bytes -= lru->size;
+            ++total_spills;
+            continue;
+        }
+
+        /* Nowhere to spill to, give up the oldest lines to keep memory bounded */
+        drop_oldest_block(history);
+        ++total_evictions;
+    }
+}
+
+static ul_history_cache_entry *thaw_block(ul_history *history, ul_history_block *block) {
+    ul_history_cache_entry *entry = NULL;
+
+    block->last_use = ++history->use_counter;
+
+    for (int i = 0; i < UL_HISTORY_CACHE_BLOCKS; ++i) {
+        ul_history_cache_entry *candidate = &(history->cache[i]);
+        if (candidate->block == block) {
+            candidate->last_use = history->use_counter;
+            return candidate;
+        }
+        if (!entry || !candidate->block || (entry->block && candidate->last_use < entry->last_use)) {
+            entry = candidate;
+        }
+    }
+
+    if (!entry->rows[0].cells) {
+        ul_cell *cells = malloc(UL_HISTORY_BLOCK_LINES * history->cols * sizeof(ul_cell));
+        if (!cells) {
+            ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for decompressed history");
+            return NULL;
+        }
+        for (int i = 0; i < UL_HISTORY_BLOCK_LINES; ++i) {
+            entry->rows[i].cells = cells + i * history->cols;
+            entry->rows[i].size = (uint16_t)history->cols;
+        }
+    }
+
+    uint8_t *raw = malloc(block->raw_size + 1);
+    size_t raw_size = 0;
+    const uint8_t *data = block->is_spilled ? ul_spill_load(block->spill_offset, block->size) : block->data;
+    bool is_decompressed = raw && ul_lz_decompress(data, block->size, raw, block->raw_size, &raw_size) && raw_size == block->raw_size;
+    if (block->is_spilled) {
+        ul_spill_release(block->spill_offset, block->size);
+    }
+    if (!is_decompressed) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not decompress history block");
+        free(raw);
+        return NULL;
+    }
+
+    int num_cells = (int)(raw_size - UL_HISTORY_BLOCK_LINES * ROW_HEADER_SIZE) / CELL_SIZE;
+    const uint8_t *header = raw;
+    const uint8_t *planes[CELL_SIZE];
+    for (int p = 0; p < CELL_SIZE; ++p) {
+        planes[p] = raw + UL_HISTORY_BLOCK_LINES * ROW_HEADER_SIZE + p * num_cells;
+    }
+
+    int c = 0;
+    for (int i = 0; i < UL_HISTORY_BLOCK_LINES; ++i) {
+        ul_row *row = &(entry->rows[i]);
+        row->len = (uint16_t)(header[0] | (header[1] << 8));
+        row->flags = header[2];
+        header += ROW_HEADER_SIZE;
+
+        for (int x = 0; x < row->len; ++x, ++c) {
+            row->cells[x].codepoint = (uint32_t)planes[0][c] | ((uint32_t)planes[1][c] << 8) | ((uint32_t)planes[2][c] << 16);
+            row->cells[x].attr = (ul_attr_id)(planes[3][c] | (planes[4][c] << 8));
+            row->cells[x].width = planes[5][c];
+            row->cells[x].reserved = 0;
+        }
+        blank_cells(row->cells + row->len, history->cols - row->len);
+    }
+
+    free(raw);
+
+    entry->block = block;
+    entry->last_use = history->use_counter;
+    ++total_decompressions;
+
+    return entry;
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_history_set_memory_budget(size_t bytes) {
+    memory_budget = bytes;
+}
+
+ul_history *ul_history_create(int cols, int max_lines) {
+    ul_history *history = calloc(1, sizeof(ul_history));
+    if (!history) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for history");
+        return NULL;
+    }
+
+    history->cols = cols;
+    history->max_lines = max_lines < 0 ? 0 : max_lines;
+    history->blocks_capacity = history->max_lines / UL_HISTORY_BLOCK_LINES + 2;
+    history->blocks = calloc(history->blocks_capacity, sizeof(ul_history_block));
+    if (!history->blocks) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for history blocks");
+        free(history);
+        return NULL;
+    }
+
+    for (int i = 0; i <= UL_HISTORY_BLOCK_LINES; ++i) {
+        ul_row *row = i < UL_HISTORY_BLOCK_LINES ? &(history->pending[i]) : &(history->blank);
+        row->cells = malloc(cols * sizeof(ul_cell));
+        if (!row->cells) {
+            ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for history lines");
+            ul_history_destroy(history);
+            return NULL;
+        }
+        blank_cells(row->cells, cols);
+        row->size = (uint16_t)cols;
+    }
+
+    return history;
+}
+
+void ul_history_destroy(ul_history *history) {
+    if (!history) {
+        return;
+    }
+
+    ul_history_clear(history);
+
+    for (int i = 0; i < UL_HISTORY_BLOCK_LINES; ++i) {
+        free(history->pending[i].cells);
+    }
+    for (int i = 0; i < UL_HISTORY_CACHE_BLOCKS; ++i) {
+        free(history->cache[i].rows[0].cells);
+    }
+    free(history->blank.cells);
+    free(history->blocks);
+    free(history);
+}
+
+void ul_history_clear(ul_history *history) {
+    while (history->num_blocks > 0) {
+        drop_oldest_block(history);
+    }
+    if (history->blank.cells) {
+        clear_pending(history);
+    }
+}
+
+void ul_history_push_row(ul_history *history, ul_row *row) {
+    ul_row *pending = &(history->pending[history->num_pending++]);
+
+    /* Take over the row's content together with its attribute references, the blanks
+     * after it are dropped */
+    memcpy(pending->cells, row->cells, row->len * sizeof(ul_cell));
+    pending->len = row->len;
+    pending->flags = row->flags & UL_ROW_FLAG_WRAPPED;
+    for (int x = row->len; x < row->size; ++x) {
+        ul_attr_unref(row->cells[x].attr);
+    }
+    blank_cells(row->cells, row->size);
+    row->len = 0;
+
+    if (history->num_pending == UL_HISTORY_BLOCK_LINES && !compress_pending(history)) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not compress history block, dropping %d lines", history->num_pending);
+        clear_pending(history);
+    }
+
+    while (history->num_blocks > 0 && ul_history_get_count(history) > history->max_lines) {
+        drop_oldest_block(history);
+    }
+}
+
+bool ul_history_set_cols(ul_history *history, int cols) {
+    if (cols <= history->cols) {
+        return true;
+    }
+
+    for (int i = 0; i <= UL_HISTORY_BLOCK_LINES; ++i) {
+        ul_row *row = i < UL_HISTORY_BLOCK_LINES ? &(history->pending[i]) : &(history->blank);
+        ul_cell *cells = realloc(row->cells, cols * sizeof(ul_cell));
+        if (!cells) {
+            ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for history lines");
+            return false;
+        }
+        blank_cells(cells + history->cols, cols - history->cols);
+        row->cells = cells;
+        row->size = (uint16_t)cols;
+    }
+
+    /* Decompressed blocks are reallocated at the new width on their next access */
+    for (int i = 0; i < UL_HISTORY_CACHE_BLOCKS; ++i) {
+        free(history->cache[i].rows[0].cells);
+        memset(&(history->cache[i]), 0, sizeof(ul_history_cache_entry));
+    }
+
+    total_raw_bytes += (size_t)history->num_blocks * UL_HISTORY_BLOCK_LINES * (cols - history->cols) * sizeof(ul_cell);
+    history->cols = cols;
+
+    return true;
+}
+
+int ul_history_get_count(const ul_history *history) {
+    return history->num_blocks * UL_HISTORY_BLOCK_LINES + history->num_pending;
+}
+
+ul_row *ul_history_get_row(ul_history *history, int index) {
+    int b = index / UL_HISTORY_BLOCK_LINES;
+    if (b >= history->num_blocks) {
+        return &(history->pending[index - history->num_blocks * UL_HISTORY_BLOCK_LINES]);
+    }
+
+    ul_history_cache_entry *entry = thaw_block(history, get_block(history, b));
+    if (!entry) {
+        return &(history->blank); /* Show an empty line rather than failing */
+    }
+
+    return &(entry->rows[index % UL_HISTORY_BLOCK_LINES]);
+}
+
+uint32_t ul_history_fold(uint32_t codepoint) {
+    if (codepoint >= 'A' && codepoint <= 'Z') {
+        return codepoint + ('a' - 'A');
+    }
+    if (codepoint == 0) {
+        return ' '; /* Blank cells match spaces */
+    }
+    return codepoint;
+}
+
+uint32_t ul_history_get_trigram_bit(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t h = a * 0x9e3779b1u;
+    h ^= (b + (h >> 16)) * 0x85ebca77u;
+    h ^= (c + (h >> 16)) * 0xc2b2ae3du;
+    h ^= h >> 15;
+    return h & (UL_HISTORY_FILTER_BITS - 1);
+}
+
+bool ul_history_may_contain(const ul_history *history, int index, const uint32_t *bits, int num_bits) {
+    int b = index / UL_HISTORY_BLOCK_LINES;
+    if (b >= history->num_blocks) {
+        return true;
+    }
+
+    const uint64_t *filter = get_const_block(history, b)->filter;
+    for (int i = 0; i < num_bits; ++i) {
+        if (!(filter[bits[i] / 64] & ((uint64_t)1 << (bits[i] % 64)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ul_history_get_stats(ul_history_stats *stats) {
+    stats->blocks = total_blocks;
+    stats->lines = total_lines;
+    stats->raw_bytes = total_raw_bytes;
+    stats->compressed_bytes = total_compressed_bytes;
+    stats->decompressions = total_decompressions;
+    stats->resident_bytes = resident_bytes;
+    stats->memory_budget = memory_budget;
+    stats->spills = total_spills;
+    stats->evictions = total_evictions;
+    stats->filter_bytes = total_filter_bytes;
+}
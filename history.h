@@ -0,0 +1,241 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_HISTORY_H
+#define UL_HISTORY_H
+
+#include "attr.h"
+#include "row.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Number of lines compressed together into one block */
+#define UL_HISTORY_BLOCK_LINES 128
+
+/* Number of decompressed blocks kept around for scrolling through history */
+#define UL_HISTORY_CACHE_BLOCKS 2
+
+/* Size of the per-block n-gram filter used for searching, must be a power of two */
+#define UL_HISTORY_FILTER_BITS 4096
+
+/**
+ * A compressed block of UL_HISTORY_BLOCK_LINES lines
+ */
+typedef struct {
+    /* Compressed row data, NULL if the block was spilled */
+    uint8_t *data;
+    /* Offset of the compressed data in the spill file */
+    size_t spill_offset;
+    /* True if the compressed data lives in the spill file rather than in memory */
+    bool is_spilled;
+    /* Value of the use counter when the block was last accessed */
+    unsigned long last_use;
+    /* Size of data in bytes */
+    uint32_t size;
+    /* Size of the row data before compression */
+    uint32_t raw_size;
+    /* Bloom filter of the case-folded characters, bigrams and trigrams occurring in the block's lines */
+    uint64_t *filter;
+    /* Distinct attribute sets used by the block, one reference is held on each */
+    ul_attr_id *attrs;
+    /* Number of entries in attrs */
+    uint16_t num_attrs;
+} ul_history_block;
+
+/**
+ * A decompressed block
+ */
+typedef struct {
+    /* Block the rows were decompressed from, NULL if the entry is unused */
+    ul_history_block *block;
+    /* Decompressed rows */
+    ul_row rows[UL_HISTORY_BLOCK_LINES];
+    /* Value of the use counter when the entry was last accessed */
+    unsigned long last_use;
+} ul_history_cache_entry;
+
+/**
+ * Cold scrollback: lines that dropped out of the screen's row ring. Lines are collected
+ * uncompressed until a block is complete, the block is then compressed and only
+ * decompressed again when its lines are accessed.
+ */
+typedef struct {
+    /* Maximum number of cells per line, grows with the screen width */
+    int cols;
+    /* Maximum number of lines, the oldest block is dropped when it is exceeded */
+    int max_lines;
+    /* Ring of compressed blocks, oldest first */
+    ul_history_block *blocks;
+    /* Capacity of blocks */
+    int blocks_capacity;
+    /* Index of the oldest block */
+    int blocks_head;
+    /* Number of blocks */
+    int num_blocks;
+    /* Lines of the block that is still being filled */
+    ul_row pending[UL_HISTORY_BLOCK_LINES];
+    /* Number of lines in pending */
+    int num_pending;
+    /* Decompressed blocks */
+    ul_history_cache_entry cache[UL_HISTORY_CACHE_BLOCKS];
+    /* Counter for finding the least recently used cache entry */
+    unsigned long use_counter;
+    /* Empty line returned in place of lines that can't be decompressed */
+    ul_row blank;
+} ul_history;
+
+/**
+ * Statistics of all histories
+ */
+typedef struct {
+    /* Number of compressed blocks */
+    int blocks;
+    /* Number of lines held in compressed blocks */
+    long lines;
+    /* Memory the compressed lines would occupy as uncompressed rows */
+    size_t raw_bytes;
+    /* Size of the compressed blocks, whether held in memory or in the spill file */
+    size_t compressed_bytes;
+    /* Compressed data currently held in memory rather than in the spill file */
+    size_t resident_bytes;
+    /* Limit for resident_bytes, 0 if unlimited */
+    size_t memory_budget;
+    /* Number of blocks moved into the spill file */
+    unsigned long spills;
+    /* Number of blocks dropped early to stay within the memory budget */
+    unsigned long evictions;
+    /* Memory occupied by the search filters of all blocks */
+    size_t filter_bytes;
+    /* Number of blocks decompressed because their lines were accessed */
+    unsigned long decompressions;
+} ul_history_stats;
+
+/**
+ * Limit the memory used by compressed history blocks of all histories. Once the limit is
+ * exceeded, the least recently used blocks are moved into the spill file. If no spill file
+ * is available or it is full, the oldest blocks are dropped.
+ *
+ * @param bytes maximum number of bytes, 0 for no limit
+ */
+void ul_history_set_memory_budget(size_t bytes);
+
+/**
+ * Create a history.
+ *
+ * @param cols number of columns per line
+ * @param max_lines maximum number of lines to keep
+ * @return the new history or NULL on failure
+ */
+ul_history *ul_history_create(int cols, int max_lines);
+
+/**
+ * Destroy a history and release all of its lines.
+ *
+ * @param history history to destroy
+ */
+void ul_history_destroy(ul_history *history);
+
+/**
+ * Drop all lines.
+ *
+ * @param history history
+ */
+void ul_history_clear(ul_history *history);
+
+/**
+ * Append a line. The history takes over the attribute references of the row's cells, which
+ * are left blank in the default rendition. The row's content must not be longer than the
+ * history's width.
+ *
+ * @param history history
+ * @param row row to take the content from
+ */
+void ul_history_push_row(ul_history *history, ul_row *row);
+
+/**
+ * Widen the lines of the history. Lines are never narrowed, so this does nothing if the
+ * history is already wide enough.
+ *
+ * @param history history
+ * @param cols new minimum number of cells per line
+ * @return true on success, false if memory is short
+ */
+bool ul_history_set_cols(ul_history *history, int cols);
+
+/**
+ * Get the number of lines in the history.
+ *
+ * @param history history
+ * @return number of lines
+ */
+int ul_history_get_count(const ul_history *history);
+
+/**
+ * Get a line, decompressing its block if needed. The returned row stays valid until
+ * lines from more than UL_HISTORY_CACHE_BLOCKS other blocks have been accessed or the
+ * history is modified.
+ *
+ * @param history history
+ * @param index line index (0 is the oldest line)
+ * @return the row
+ */
+ul_row *ul_history_get_row(ul_history *history, int index);
+
+/**
+ * Fold a code point for case-insensitive matching.
+ *
+ * @param codepoint code point
+ * @return the folded code point
+ */
+uint32_t ul_history_fold(uint32_t codepoint);
+
+/**
+ * Get the filter bit of a trigram of folded code points. Single characters and bigrams are
+ * indexed too, passing 0 for the missing trailing code points.
+ *
+ * @param a first code point
+ * @param b second code point or 0
+ * @param c third code point or 0
+ * @return bit index into a block's filter
+ */
+uint32_t ul_history_get_trigram_bit(uint32_t a, uint32_t b, uint32_t c);
+
+/**
+ * Check whether a line may contain all of a set of n-grams. Lines that are not part of a
+ * compressed block yet are always reported as possible matches.
+ *
+ * @param history history
+ * @param index line index (0 is the oldest line)
+ * @param bits filter bits of the n-grams (see ul_history_get_trigram_bit)
+ * @param num_bits number of entries in bits
+ * @return false if the line's block definitely doesn't contain one of the n-grams, true otherwise
+ */
+bool ul_history_may_contain(const ul_history *history, int index, const uint32_t *bits, int num_bits);
+
+/**
+ * Get statistics about all histories.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_history_get_stats(ul_history_stats *stats);
+
+#endif /* UL_HISTORY_H */
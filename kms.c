@@ -0,0 +1,665 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "kms.h"
+
+#include "lv_drv_conf.h"
+
+#if USE_DRM
+
+#include "log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+
+/**
+ * Defines
+ */
+
+#if LV_COLOR_DEPTH == 16
+#define BUFFER_BPP 16
+#define BUFFER_DEPTH 16
+#else
+#define BUFFER_BPP 32
+#define BUFFER_DEPTH 24
+#endif
+
+/* Number of separate areas tracked per frame before the whole frame counts as damaged */
+#define MAX_DAMAGE_AREAS 16
+
+/* Time to wait for a page flip before assuming that it was lost (in milliseconds) */
+#define FLIP_TIMEOUT_MS 1000
+
+
+/**
+ * Static variables
+ */
+
+/* A dumb buffer registered as framebuffer and mapped into memory */
+typedef struct {
+    uint32_t handle;
+    uint32_t pitch;
+    uint64_t size;
+    uint32_t fb_id;
+    uint8_t *map;
+} dumb_buffer;
+
+static int fd = -1;
+static uint32_t connector_id = 0;
+static uint32_t crtc_id = 0;
+static drmModeModeInfo mode;
+static uint32_t mm_width = 0;
+static drmModeCrtcPtr saved_crtc = NULL;
+
+static dumb_buffer buffers[2];
+static int front = 0;
+static bool is_double_buffered = false;
+static bool is_flip_pending = false;
+static lv_timer_t *paused_refr_timer = NULL;
+static lv_disp_draw_buf_t *direct_buf = NULL;
+
+static lv_area_t damage_areas[MAX_DAMAGE_AREAS];
+static int num_damage_areas = 0;
+static bool is_fully_damaged = false;
+
+static unsigned long num_flips = 0;
+static unsigned long num_flip_waits = 0;
+static unsigned long long copied_bytes = 0;
+static unsigned long long synced_bytes = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Find a connected connector with at least one mode.
+ *
+ * @param res device resources
+ * @param wanted_id ID of the connector to use or -1 for the first connected one
+ * @return the connector or NULL if none was found, to be freed with drmModeFreeConnector
+ */
+static drmModeConnectorPtr find_connector(const drmModeRes *res, int wanted_id);
+
+/**
+ * Find a CRTC that can drive a connector, preferring the one it is currently attached to.
+ *
+ * @param res device resources
+ * @param conn connector
+ * @return CRTC ID or 0 if none was found
+ */
+static uint32_t find_crtc(const drmModeRes *res, const drmModeConnector *conn);
+
+/**
+ * Create, register and map a dumb buffer of the output's size.
+ *
+ * @param buf buffer to initialise
+ * @return true on success, false otherwise
+ */
+static bool create_buffer(dumb_buffer *buf);
+
+/**
+ * Unmap, unregister and free a dumb buffer.
+ *
+ * @param buf buffer
+ */
+static void destroy_buffer(dumb_buffer *buf);
+
+/**
+ * Get the buffer that rendering goes into, i.e. the back buffer if double buffering and the
+ * scanned out buffer otherwise.
+ *
+ * @return the buffer
+ */
+static dumb_buffer *get_draw_buffer(void);
+
+/**
+ * Get the address of a pixel in a buffer.
+ *
+ * @param buf buffer
+ * @param x column
+ * @param y row
+ * @return the address
+ */
+static uint8_t *get_pixel(const dumb_buffer *buf, lv_coord_t x, lv_coord_t y);
+
+/**
+ * Clip an area to the output.
+ *
+ * @param area area to clip
+ * @param clipped pointer for writing the clipped area into
+ * @return true if any part of the area is visible, false otherwise
+ */
+static bool clip_to_screen(const lv_area_t *area, lv_area_t *clipped);
+
+/**
+ * Copy the pixels of an area from one buffer to another.
+ *
+ * @param dst destination buffer
+ * @param src source buffer
+ * @param area area to copy, clipped to the output
+ */
+static void copy_area(dumb_buffer *dst, const dumb_buffer *src, const lv_area_t *area);
+
+/**
+ * Add an area to the damage of the frame being drawn.
+ *
+ * @param area changed area, clipped to the output
+ */
+static void add_damage(const lv_area_t *area);
+
+/**
+ * Bring the back buffer up to date by copying the damage of the frame that was just shown.
+ */
+static void sync_back_buffer(void);
+
+/**
+ * Show the back buffer on the next vertical blank and stop refreshing the display until then.
+ *
+ * @param disp_drv display driver
+ */
+static void queue_flip(lv_disp_drv_t *disp_drv);
+
+/**
+ * Handle the completion of a page flip. Used as libdrm event callback.
+ *
+ * @param fd DRM device file descriptor
+ * @param sequence vertical blank counter
+ * @param tv_sec seconds of the flip's timestamp
+ * @param tv_usec microseconds of the flip's timestamp
+ * @param user_data unused
+ */
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec, void *user_data);
+
+/**
+ * Block until a pending page flip has completed.
+ */
+static void wait_for_flip(void);
+
+/**
+ * Stop double buffering after a failed page flip, showing the back buffer's content in the
+ * scanned out buffer from now on.
+ */
+static void fall_back_to_single_buffer(void);
+
+/**
+ * Point the direct draw buffer, if any, at the dumb buffer drawn into.
+ */
+static void update_direct_buffer(void);
+
+
+/**
+ * Static functions
+ */
+
+static drmModeConnectorPtr find_connector(const drmModeRes *res, int wanted_id) {
+    for (int i = 0; i < res->count_connectors; ++i) {
+        if (wanted_id >= 0 && res->connectors[i] != (uint32_t)wanted_id) {
+            continue;
+        }
+        drmModeConnectorPtr conn = drmModeGetConnector(fd, res->connectors[i]);
+        if (conn && conn->connection == DRM_MODE_CONNECTED && conn->count_modes > 0) {
+            return conn;
+        }
+        drmModeFreeConnector(conn);
+    }
+    return NULL;
+}
+
+static uint32_t find_crtc(const drmModeRes *res, const drmModeConnector *conn) {
+    if (conn->encoder_id) {
+        drmModeEncoderPtr enc = drmModeGetEncoder(fd, conn->encoder_id);
+        if (enc) {
+            uint32_t id = enc->crtc_id;
+            drmModeFreeEncoder(enc);
+            if (id) {
+                return id;
+            }
+        }
+    }
+
+    for (int i = 0; i < conn->count_encoders; ++i) {
+        drmModeEncoderPtr enc = drmModeGetEncoder(fd, conn->encoders[i]);
+        if (!enc) {
+            continue;
+        }
+        for (int j = 0; j < res->count_crtcs; ++j) {
+            if (enc->possible_crtcs & (1u << j)) {
+                drmModeFreeEncoder(enc);
+                return res->crtcs[j];
+            }
+        }
+        drmModeFreeEncoder(enc);
+    }
+
+    return 0;
+}
+
+static bool create_buffer(dumb_buffer *buf) {
+    memset(buf, 0, sizeof(*buf));
+
+    struct drm_mode_create_dumb create_req = { .width = mode.hdisplay, .height = mode.vdisplay, .bpp = BUFFER_BPP };
+    if (drmIoctl(fd, DRM_IOCTL_MODE_CREATE_DUMB, &create_req) < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not create dumb buffer: %s", strerror(errno));
+        return false;
+    }
+    buf->handle = create_req.handle;
+    buf->pitch = create_req.pitch;
+    buf->size = create_req.size;
+
+    if (drmModeAddFB(fd, mode.hdisplay, mode.vdisplay, BUFFER_DEPTH, BUFFER_BPP, buf->pitch, buf->handle, &(buf->fb_id)) < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not register dumb buffer: %s", strerror(errno));
+        destroy_buffer(buf);
+        return false;
+    }
+
+    struct drm_mode_map_dumb map_req = { .handle = buf->handle };
+    if (drmIoctl(fd, DRM_IOCTL_MODE_MAP_DUMB, &map_req) < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not prepare dumb buffer mapping: %s", strerror(errno));
+        destroy_buffer(buf);
+        return false;
+    }
+
+    void *map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, map_req.offset);
+    if (map == MAP_FAILED) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not map dumb buffer: %s", strerror(errno));
+        destroy_buffer(buf);
+        return false;
+    }
+    buf->map = map;
+    memset(buf->map, 0, buf->size);
+
+    return true;
+}
+
+static void destroy_buffer(dumb_buffer *buf) {
+    if (buf->map) {
+        munmap(buf->map, buf->size);
+    }
+    if (buf->fb_id) {
+        drmModeRmFB(fd, buf->fb_id);
+    }
+    if (buf->handle) {
+        struct drm_mode_destroy_dumb destroy_req = { .handle = buf->handle };
+        drmIoctl(fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy_req);
+    }
+    memset(buf, 0, sizeof(*buf));
+}
+
+static dumb_buffer *get_draw_buffer(void) {
+    return &(buffers[is_double_buffered ? 1 - front : front]);
+}
+
+static uint8_t *get_pixel(const dumb_buffer *buf, lv_coord_t x, lv_coord_t y) {
+    return buf->map + (size_t)y * buf->pitch + (size_t)x * (BUFFER_BPP / 8);
+}
+
+static bool clip_to_screen(const lv_area_t *area, lv_area_t *clipped) {
+    clipped->x1 = LV_MAX(area->x1, 0);
+    clipped->y1 = LV_MAX(area->y1, 0);
+    clipped->x2 = LV_MIN(area->x2, (lv_coord_t)mode.hdisplay - 1);
+    clipped->y2 = LV_MIN(area->y2, (lv_coord_t)mode.vdisplay - 1);
+    return clipped->x1 <= clipped->x2 && clipped->y1 <= clipped->y2;
+}
+
+static void copy_area(dumb_buffer *dst, const dumb_buffer *src, const lv_area_t *area) {
+    const size_t row_bytes = (size_t)lv_area_get_width(area) * (BUFFER_BPP / 8);
+    synced_bytes += row_bytes * lv_area_get_height(area);
+    if (row_bytes == dst->pitch) {
+        memcpy(get_pixel(dst, area->x1, area->y1), get_pixel(src, area->x1, area->y1), row_bytes * lv_area_get_height(area));
+        return;
+    }
+    for (lv_coord_t y = area->y1; y <= area->y2; ++y) {
+        memcpy(get_pixel(dst, area->x1, y), get_pixel(src, area->x1, y), row_bytes);
+    }
+}
+
+static void add_damage(const lv_area_t *area) {
+    if (is_fully_damaged) {
+        return;
+    }
+
+    /* Merge into an area that already covers most of it, as LVGL flushes in stripes */
+    for (int i = 0; i < num_damage_areas; ++i) {
+        if (_lv_area_is_in(area, &(damage_areas[i]), 0)) {
+            return;
+        }
+        lv_area_t joined;
+        _lv_area_join(&joined, &(damage_areas[i]), area);
+        if (lv_area_get_size(&joined) <= lv_area_get_size(&(damage_areas[i])) + lv_area_get_size(area)) {
+            damage_areas[i] = joined;
+            return;
+        }
+    }
+
+    if (num_damage_areas == MAX_DAMAGE_AREAS) {
+        is_fully_damaged = true;
+        return;
+    }
+    damage_areas[num_damage_areas++] = *area;
+}
+
+static void sync_back_buffer(void) {
+    dumb_buffer *back = &(buffers[1 - front]);
+    if (is_fully_damaged) {
+        memcpy(back->map, buffers[front].map, back->size);
+        synced_bytes += back->size;
+    } else {
+        for (int i = 0; i < num_damage_areas; ++i) {
+            copy_area(back, &(buffers[front]), &(damage_areas[i]));
+        }
+    }
+    num_damage_areas = 0;
+    is_fully_damaged = false;
+}
+
+static void queue_flip(lv_disp_drv_t *disp_drv) {
+    if (drmModePageFlip(fd, crtc_id, buffers[1 - front].fb_id, DRM_MODE_PAGE_FLIP_EVENT, NULL) < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not flip pages, falling back to a single buffer: %s", strerror(errno));
+        fall_back_to_single_buffer();
+        return;
+    }
+    is_flip_pending = true;
+
+    /* Don't render the next frame before this one is on screen */
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    if (disp && disp->driver == disp_drv && disp->refr_timer) {
+        paused_refr_timer = disp->refr_timer;
+        lv_timer_pause(paused_refr_timer);
+    }
+}
+
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec, void *user_data) {
+    LV_UNUSED(fd);
+    LV_UNUSED(sequence);
+    LV_UNUSED(tv_sec);
+    LV_UNUSED(tv_usec);
+    LV_UNUSED(user_data);
+
+    if (!is_flip_pending) {
+        return;
+    }
+
+    front = 1 - front;
+    is_flip_pending = false;
+    ++num_flips;
+    sync_back_buffer();
+    update_direct_buffer();
+
+    if (paused_refr_timer) {
+        lv_timer_resume(paused_refr_timer);
+        paused_refr_timer = NULL;
+    }
+}
+
+static void wait_for_flip(void) {
+    if (!is_flip_pending) {
+        return;
+    }
+
+    ++num_flip_waits;
+    ul_kms_handle_events(FLIP_TIMEOUT_MS);
+
+    if (is_flip_pending) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Page flip did not complete in time, falling back to a single buffer");
+        is_flip_pending = false;
+        fall_back_to_single_buffer();
+    }
+}
+
+static void fall_back_to_single_buffer(void) {
+    /* The back buffer holds the newest frame, make it the only one */
+    if (drmModeSetCrtc(fd, crtc_id, buffers[1 - front].fb_id, 0, 0, &connector_id, 1, &mode) == 0) {
+        front = 1 - front;
+    } else {
+        copy_area(&(buffers[front]), &(buffers[1 - front]), &(lv_area_t){ 0, 0, mode.hdisplay - 1, mode.vdisplay - 1 });
+    }
+    destroy_buffer(&(buffers[1 - front]));
+    is_double_buffered = false;
+    num_damage_areas = 0;
+    is_fully_damaged = false;
+    update_direct_buffer();
+
+    if (paused_refr_timer) {
+        lv_timer_resume(paused_refr_timer);
+        paused_refr_timer = NULL;
+    }
+}
+
+static void update_direct_buffer(void) {
+    if (direct_buf) {
+        direct_buf->buf1 = (lv_color_t *)get_draw_buffer()->map;
+        direct_buf->buf_act = direct_buf->buf1;
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_kms_init(const char *path, int wanted_connector_id) {
+    fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not open DRM device %s", path);
+        return false;
+    }
+
+    drmModeResPtr res = drmModeGetResources(fd);
+    if (!res) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not query resources of DRM device %s", path);
+        ul_kms_exit();
+        return false;
+    }
+
+    drmModeConnectorPtr conn = find_connector(res, wanted_connector_id);
+    if (!conn) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not find a connected display on DRM device %s", path);
+        drmModeFreeResources(res);
+        ul_kms_exit();
+        return false;
+    }
+
+    /* Use the preferred mode, falling back to the first one */
+    mode = conn->modes[0];
+    for (int i = 0; i < conn->count_modes; ++i) {
+        if (conn->modes[i].type & DRM_MODE_TYPE_PREFERRED) {
+            mode = conn->modes[i];
+            break;
+        }
+    }
+    connector_id = conn->connector_id;
+    mm_width = conn->mmWidth;
+    crtc_id = find_crtc(res, conn);
+    drmModeFreeConnector(conn);
+    drmModeFreeResources(res);
+
+    if (!crtc_id) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not find a CRTC for connector %u", connector_id);
+        ul_kms_exit();
+        return false;
+    }
+
+    front = 0;
+    if (!create_buffer(&(buffers[front]))) {
+        ul_kms_exit();
+        return false;
+    }
+
+    /* Without a second buffer, frames are drawn straight into the scanned out one */
+    is_double_buffered = create_buffer(&(buffers[1 - front]));
+
+    saved_crtc = drmModeGetCrtc(fd, crtc_id);
+    if (drmModeSetCrtc(fd, crtc_id, buffers[front].fb_id, 0, 0, &connector_id, 1, &mode) < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not set mode %s on connector %u: %s", mode.name, connector_id, strerror(errno));
+        ul_kms_exit();
+        return false;
+    }
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "DRM output is %ux%u on connector %u, %u bytes per line, %s",
+        mode.hdisplay, mode.vdisplay, connector_id, buffers[front].pitch, is_double_buffered ? "double buffered" : "single buffered");
+    return true;
+}
+
+bool ul_kms_init_direct_buffer(lv_disp_draw_buf_t *draw_buf) {
+    const dumb_buffer *buf = get_draw_buffer();
+    if (!buf->map || buf->pitch != mode.hdisplay * sizeof(lv_color_t)) {
+        return false;
+    }
+
+    lv_disp_draw_buf_init(draw_buf, (lv_color_t *)buf->map, NULL, (uint32_t)mode.hdisplay * mode.vdisplay);
+    direct_buf = draw_buf;
+    return true;
+}
+
+void ul_kms_exit(void) {
+    if (fd < 0) {
+        return;
+    }
+
+    if (is_flip_pending) {
+        ul_kms_handle_events(FLIP_TIMEOUT_MS);
+        is_flip_pending = false;
+    }
+
+    if (saved_crtc) {
+        drmModeSetCrtc(fd, saved_crtc->crtc_id, saved_crtc->buffer_id, saved_crtc->x, saved_crtc->y,
+            &connector_id, 1, &(saved_crtc->mode));
+        drmModeFreeCrtc(saved_crtc);
+        saved_crtc = NULL;
+    }
+
+    destroy_buffer(&(buffers[0]));
+    destroy_buffer(&(buffers[1]));
+    is_double_buffered = false;
+    direct_buf = NULL;
+    close(fd);
+    fd = -1;
+}
+
+void ul_kms_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi) {
+    *width = mode.hdisplay;
+    *height = mode.vdisplay;
+    if (dpi) {
+        *dpi = mm_width > 0 ? (mode.hdisplay * 254 + mm_width * 5) / (mm_width * 10) : 0;
+    }
+}
+
+void ul_kms_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    /* Refreshes forced outside of the paced timer must not draw into the buffer being shown */
+    wait_for_flip();
+
+    dumb_buffer *buf = get_draw_buffer();
+    lv_area_t clipped;
+    if (buf->map && clip_to_screen(area, &clipped)) {
+        /* In direct mode the pixels are already in place */
+        if (!direct_buf) {
+            const lv_coord_t src_width = lv_area_get_width(area);
+            const size_t row_bytes = (size_t)lv_area_get_width(&clipped) * sizeof(lv_color_t);
+            for (lv_coord_t y = clipped.y1; y <= clipped.y2; ++y) {
+                const lv_color_t *src = color_p + (size_t)(y - area->y1) * src_width + (clipped.x1 - area->x1);
+                memcpy(get_pixel(buf, clipped.x1, y), src, row_bytes);
+            }
+            copied_bytes += row_bytes * lv_area_get_height(&clipped);
+        }
+
+        if (is_double_buffered) {
+            add_damage(&clipped);
+        } else {
+            /* Some drivers only scan out changes they are told about, the others don't implement this */
+            drmModeClip clip = { .x1 = clipped.x1, .y1 = clipped.y1, .x2 = clipped.x2 + 1, .y2 = clipped.y2 + 1 };
+            drmModeDirtyFB(fd, buf->fb_id, &clip, 1);
+        }
+    }
+
+    if (is_double_buffered && lv_disp_flush_is_last(disp_drv) && (num_damage_areas > 0 || is_fully_damaged)) {
+        queue_flip(disp_drv);
+    }
+
+    lv_disp_flush_ready(disp_drv);
+}
+
+bool ul_kms_blit_scroll(const lv_area_t *area, lv_coord_t dy) {
+    /* The buffer that would be moved is still waiting to be shown */
+    if (is_flip_pending) {
+        return false;
+    }
+
+    dumb_buffer *buf = get_draw_buffer();
+    lv_area_t clipped;
+    if (!buf->map || dy <= 0 || !clip_to_screen(area, &clipped) || lv_area_get_height(&clipped) <= dy) {
+        return false;
+    }
+
+    const size_t row_bytes = (size_t)lv_area_get_width(&clipped) * (BUFFER_BPP / 8);
+    const lv_coord_t num_rows = lv_area_get_height(&clipped) - dy;
+
+    if (row_bytes == buf->pitch) {
+        /* Full-width rows are contiguous, the whole block moves at once */
+        memmove(get_pixel(buf, clipped.x1, clipped.y1), get_pixel(buf, clipped.x1, clipped.y1 + dy), row_bytes * num_rows);
+    } else {
+        /* Source and destination rows never overlap, moving top to bottom keeps the source intact */
+        for (lv_coord_t y = clipped.y1; y < clipped.y1 + num_rows; ++y) {
+            memcpy(get_pixel(buf, clipped.x1, y), get_pixel(buf, clipped.x1, y + dy), row_bytes);
+        }
+    }
+
+    lv_area_t moved = { .x1 = clipped.x1, .y1 = clipped.y1, .x2 = clipped.x2, .y2 = clipped.y1 + num_rows - 1 };
+    if (is_double_buffered) {
+        /* The exposed rows are redrawn by LVGL, which then flips the pages */
+        add_damage(&moved);
+    } else {
+        drmModeClip clip = { .x1 = moved.x1, .y1 = moved.y1, .x2 = moved.x2 + 1, .y2 = moved.y2 + 1 };
+        drmModeDirtyFB(fd, buf->fb_id, &clip, 1);
+    }
+
+    return true;
+}
+
+void ul_kms_handle_events(int timeout_ms) {
+    if (fd < 0) {
+        return;
+    }
+
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    if (poll(&pfd, 1, timeout_ms) <= 0 || !(pfd.revents & POLLIN)) {
+        return;
+    }
+
+    drmEventContext context = { .version = 2, .page_flip_handler = page_flip_handler };
+    drmHandleEvent(fd, &context);
+}
+
+void ul_kms_get_stats(ul_kms_stats *stats) {
+    stats->flips = num_flips;
+    stats->flip_waits = num_flip_waits;
+    stats->copied_bytes = copied_bytes;
+    stats->synced_bytes = synced_bytes;
+}
+
+#endif /* USE_DRM */
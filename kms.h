@@ -0,0 +1,113 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_KMS_H
+#define UL_KMS_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * DRM output statistics
+ */
+typedef struct {
+    /* Number of completed page flips */
+    unsigned long flips;
+    /* Number of times drawing had to wait for a page flip to complete */
+    unsigned long flip_waits;
+    /* Bytes copied from LVGL's draw buffer into dumb buffers */
+    unsigned long long copied_bytes;
+    /* Bytes copied between dumb buffers to bring the back buffer up to date */
+    unsigned long long synced_bytes;
+} ul_kms_stats;
+
+/**
+ * Open a DRM device, pick a connected output and show a dumb buffer on it. If a second dumb
+ * buffer can be created, frames are drawn into the one not shown and presented with page
+ * flips on vertical blank.
+ *
+ * @param path device path
+ * @param connector_id ID of the connector to use or -1 for the first connected one
+ * @return true on success, false otherwise
+ */
+bool ul_kms_init(const char *path, int connector_id);
+
+/**
+ * Let LVGL render straight into the dumb buffer drawn into, if its pixel layout matches
+ * LVGL's. The buffer is switched after every page flip. Requires the display driver to use
+ * direct mode.
+ *
+ * @param draw_buf draw buffer to initialise, must stay valid while the device is open
+ * @return true if the draw buffer was set up, false if a separate buffer is needed
+ */
+bool ul_kms_init_direct_buffer(lv_disp_draw_buf_t *draw_buf);
+
+/**
+ * Restore the previous display configuration and close the DRM device.
+ */
+void ul_kms_exit(void);
+
+/**
+ * Get the size of the output's display.
+ *
+ * @param width pointer for writing the horizontal resolution into
+ * @param height pointer for writing the vertical resolution into
+ * @param dpi pointer for writing the DPI into (0 if unknown), may be NULL
+ */
+void ul_kms_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi);
+
+/**
+ * Copy rendered pixels to the back buffer, unless they were rendered into it directly, and
+ * flip pages after the last area of a frame.
+ * Display refreshes are paused until the flip has completed. Used as LVGL flush callback.
+ *
+ * @param disp_drv display driver
+ * @param area area to write to
+ * @param color_p pixels of the area, row by row
+ */
+void ul_kms_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Move the pixels of an area of the buffer drawn into up, leaving the bottom rows unchanged.
+ * Fails while a page flip is pending.
+ *
+ * @param area area to scroll
+ * @param dy number of pixel rows to move the content by
+ * @return true if the pixels were moved, false otherwise
+ */
+bool ul_kms_blit_scroll(const lv_area_t *area, lv_coord_t dy);
+
+/**
+ * Wait for and handle events of the DRM device, such as completed page flips.
+ *
+ * @param timeout_ms maximum time to wait (in milliseconds), 0 to only handle pending events
+ */
+void ul_kms_handle_events(int timeout_ms);
+
+/**
+ * Get DRM output statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_kms_get_stats(ul_kms_stats *stats);
+
+#endif /* UL_KMS_H */
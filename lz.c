@@ -0,0 +1,273 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "lz.h"
+
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define HASH_BITS 12
+#define HASH_SIZE (1 << HASH_BITS)
+/* The last bytes of the input are always emitted as literals so that matching never reads past the end */
+#define LAST_LITERALS 5
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Read four bytes without alignment requirements.
+ *
+ * @param p pointer to the bytes
+ * @return the bytes as a native-endian integer
+ */
+static uint32_t read32(const uint8_t *p);
+
+/**
+ * Hash four bytes into the match table.
+ *
+ * @param p pointer to the bytes
+ * @return table index
+ */
+static uint32_t hash4(const uint8_t *p);
+
+/**
+ * Write a length extension (a run of 255 bytes followed by the remainder).
+ *
+ * @param op output position
+ * @param oend end of the output buffer
+ * @param len remaining length to encode
+ * @return new output position or NULL if the buffer is too small
+ */
+static uint8_t *write_length(uint8_t *op, const uint8_t *oend, size_t len);
+
+/**
+ * Emit a sequence of literals optionally followed by a back reference.
+ *
+ * @param op output position
+ * @param oend end of the output buffer
+ * @param literals first literal byte
+ * @param num_literals number of literal bytes
+ * @param offset match distance (ignored if match_len is 0)
+ * @param match_len match length (0 for the final literal-only sequence)
+ * @return new output position or NULL if the buffer is too small
+ */
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *oend, const uint8_t *literals, size_t num_literals, size_t offset, size_t match_len);
+
+/**
+ * Read a length extension.
+ *
+ * @param ip pointer to the input position, advanced past the extension
+ * @param iend end of the input
+ * @param len pointer to the length to extend
+ * @return true on success, false if the input ends prematurely
+ */
+static bool read_length(const uint8_t **ip, const uint8_t *iend, size_t *len);
+
+
+/**
+ * Static functions
+ */
+
+static uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash4(const uint8_t *p) {
+    return (read32(p) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint8_t *write_length(uint8_t *op, const uint8_t *oend, size_t len) {
+    while (len >= 255) {
+        if (op >= oend) {
+            return NULL;
+        }
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= oend) {
+        return NULL;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *oend, const uint8_t *literals, size_t num_literals, size_t offset, size_t match_len) {
+    if (op >= oend) {
+        return NULL;
+    }
+
+    uint8_t *token = op++;
+    *token = (uint8_t)((num_literals >= 15 ? 15 : num_literals) << 4);
+    if (num_literals >= 15 && !(op = write_length(op, oend, num_literals - 15))) {
+        return NULL;
+    }
+
+    if ((size_t)(oend - op) < num_literals) {
+        return NULL;
+    }
+    memcpy(op, literals, num_literals);
+    op += num_literals;
+
+    if (match_len == 0) {
+        return op;
+    }
+
+    if (oend - op < 2) {
+        return NULL;
+    }
+    *op++ = (uint8_t)(offset & 0xff);
+    *op++ = (uint8_t)(offset >> 8);
+
+    size_t len = match_len - MIN_MATCH;
+    *token |= (uint8_t)(len >= 15 ? 15 : len);
+    if (len >= 15 && !(op = write_length(op, oend, len - 15))) {
+        return NULL;
+    }
+
+    return op;
+}
+
+static bool read_length(const uint8_t **ip, const uint8_t *iend, size_t *len) {
+    uint8_t b;
+    do {
+        if (*ip >= iend) {
+            return false;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return true;
+}
+
+
+/**
+ * Public functions
+ */
+
+size_t ul_lz_compress_bound(size_t len) {
+    return len + len / 255 + 16;
+}
+
+size_t ul_lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity) {
+    uint32_t table[HASH_SIZE];
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *iend = src + len;
+    const uint8_t *mlimit = len > LAST_LITERALS + MIN_MATCH ? iend - LAST_LITERALS : src;
+    uint8_t *op = dst;
+    const uint8_t *oend = dst + capacity;
+
+    memset(table, 0, sizeof(table));
+
+    while (ip + MIN_MATCH <= mlimit) {
+        uint32_t h = hash4(ip);
+        const uint8_t *ref = src + table[h];
+        table[h] = (uint32_t)(ip - src);
+
+        if (ref >= ip || (size_t)(ip - ref) > MAX_OFFSET || read32(ref) != read32(ip)) {
+            ++ip;
+            continue;
+        }
+
+        /* Extend the match backwards over pending literals and forwards up to the limit */
+        while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+            --ip;
+            --ref;
+        }
+        size_t match_len = MIN_MATCH;
+        while (ip + match_len < mlimit && ip[match_len] == ref[match_len]) {
+            ++match_len;
+        }
+
+        op = write_sequence(op, oend, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), match_len);
+        if (!op) {
+            return 0;
+        }
+
+        ip += match_len;
+        anchor = ip;
+    }
+
+    op = write_sequence(op, oend, anchor, (size_t)(iend - anchor), 0, 0);
+    return op ? (size_t)(op - dst) : 0;
+}
+
+bool ul_lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity, size_t *out_len) {
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + len;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + capacity;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        size_t num_literals = token >> 4;
+        if (num_literals == 15 && !read_length(&ip, iend, &num_literals)) {
+            return false;
+        }
+        if ((size_t)(iend - ip) < num_literals || (size_t)(oend - op) < num_literals) {
+            return false;
+        }
+        memcpy(op, ip, num_literals);
+        ip += num_literals;
+        op += num_literals;
+
+        /* The final sequence has no back reference */
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+
+        size_t match_len = token & 0x0f;
+        if (match_len == 15 && !read_length(&ip, iend, &match_len)) {
+            return false;
+        }
+        match_len += MIN_MATCH;
+
+        if (offset == 0 || offset > (size_t)(op - dst) || (size_t)(oend - op) < match_len) {
+            return false;
+        }
+
+        /* Byte-wise copy, source and destination may overlap for short offsets */
+        const uint8_t *ref = op - offset;
+        for (size_t i = 0; i < match_len; ++i) {
+            op[i] = ref[i];
+        }
+        op += match_len;
+    }
+
+    *out_len = (size_t)(op - dst);
+    return true;
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_LZ_H
+#define UL_LZ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Get the worst-case size of compressed data.
+ *
+ * @param len number of input bytes
+ * @return maximum number of output bytes ul_lz_compress can produce
+ */
+size_t ul_lz_compress_bound(size_t len);
+
+/**
+ * Compress a buffer with a byte-oriented LZ77 codec (LZ4-style sequences of literals and
+ * back references, 64 KiB window). Speed is favoured over ratio.
+ *
+ * @param src input bytes
+ * @param len number of input bytes
+ * @param dst output buffer
+ * @param capacity size of dst, ul_lz_compress_bound(len) is always sufficient
+ * @return number of bytes written or 0 if dst is too small
+ */
+size_t ul_lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity);
+
+/**
+ * Decompress a buffer produced by ul_lz_compress.
+ *
+ * @param src compressed bytes
+ * @param len number of compressed bytes
+ * @param dst output buffer
+ * @param capacity size of dst
+ * @param out_len pointer for writing the number of decompressed bytes into
+ * @return true on success, false if the input is malformed or dst is too small
+ */
+bool ul_lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity, size_t *out_len);
+
+#endif /* UL_LZ_H */
@@ -20,9 +20,15 @@
  */
 
 
+#include "atlas.h"
+#include "attr.h"
 #include "backends.h"
+#include "blend.h"
 #include "command_line.h"
 #include "config.h"
+#include "convert.h"
+#include "flush.h"
+#include "font.h"
 #include "indev.h"
 #include "log.h"
 #include "furios-terminal.h"
@@ -30,18 +36,26 @@
 #include "theme.h"
 #include "themes.h"
 #include "lvm.h"
-#include "termstr.h"
+#include "parser.h"
+#include "render.h"
+#include "screen.h"
+#include "search.h"
+#include "snapshot.h"
+#include "spill.h"
+#include "stats.h"
+#include "termview.h"
+#include "vt.h"
 
 #include "lv_drv_conf.h"
 
 #if USE_FBDEV
-#include "lv_drivers/display/fbdev.h"
+#include "fbdev.h"
 #endif /* USE_FBDEV */
 #if USE_DRM
-#include "lv_drivers/display/drm.h"
+#include "kms.h"
 #endif /* USE_DRM */
 #if USE_MINUI
-#include "lv_drivers/display/minui.h"
+#include "minuifb.h"
 #endif /* USE_MINUI */
 
 #include "lvgl/lvgl.h"
@@ -70,6 +84,26 @@ bool is_keyboard_hidden = true;
 
 lv_obj_t *keyboard = NULL;
 lv_obj_t* t_box = NULL;
+static lv_obj_t *term_view = NULL;
+
+/* Screen model written by the parser, only accessed between ul_parser_lock and ul_parser_unlock */
+static ul_screen *screen = NULL;
+static ul_vt vt;
+
+/* Copy of the screen model's view that the terminal view renders, updated from snapshots */
+static ul_screen *view_screen = NULL;
+static ul_snapshot snapshot;
+
+static lv_coord_t view_drag_y = 0;
+
+static lv_obj_t *search_bar = NULL;
+static lv_obj_t *search_textarea = NULL;
+static ul_search search;
+static bool is_search_active = false;
+static bool search_older = true;
+static bool search_newer = false;
+
+static volatile sig_atomic_t stats_requested = 0;
 
 /**
  * Static prototypes
@@ -122,6 +156,32 @@ static void set_keyboard_hidden(bool is_hidden);
  */
 static void keyboard_anim_y_cb(void* obj, int32_t value);
 
+/**
+ * Callback for the end of the keyboard's slide in / out animation.
+ *
+ * @param anim the animation
+ */
+static void keyboard_anim_ready_cb(lv_anim_t *anim);
+
+/**
+ * Size the terminal box to the space left by the title and the keyboard.
+ */
+static void layout_terminal_box(void);
+
+/**
+ * Handle LV_EVENT_SIZE_CHANGED events from the active screen, e.g. after a rotation.
+ *
+ * @param event the event object
+ */
+static void screen_size_changed_cb(lv_event_t *event);
+
+/**
+ * Handle LV_EVENT_SIZE_CHANGED events from the terminal box by resizing the screen model.
+ *
+ * @param event the event object
+ */
+static void terminal_box_size_changed_cb(lv_event_t *event);
+
 /**
  * Handle LV_EVENT_CLICKED events from the factory reset failed messsage box
  */
@@ -177,15 +237,83 @@ static void shutdown(void);
  */
 static void sigaction_handler(int signum);
 
+/**
+ * Handle SIGUSR1 by scheduling a statistics dump from the main loop.
+ *
+ * @param signum the signal's number
+ */
+static void stats_signal_handler(int signum);
+
+/**
+ * Render the latest snapshot of the screen model, parsing pending output first unless the
+ * parser runs on its own thread.
+ *
+ * @param timer the timer object
+ */
 static void update_tty_loop(lv_timer_t* timer);
 
-static void update_tty(char * loc, int length, bool split);
+/**
+ * Apply the latest snapshot of the screen model and invalidate the cells of the terminal view
+ * that changed since the screen was last rendered.
+ */
+static void render_screen(void);
+
+/**
+ * Handle LV_EVENT_PRESSING events from the terminal box to scroll through the history.
+ *
+ * @param event the event object
+ */
+static void terminal_box_pressing_cb(lv_event_t *event);
+
+/**
+ * Handle LV_EVENT_DRAW_POST events from the terminal box to highlight visible search hits.
+ *
+ * @param event the event object
+ */
+static void terminal_box_draw_post_cb(lv_event_t *event);
+
+/**
+ * Handle LV_EVENT_CLICKED events from the search toggle button.
+ *
+ * @param event the event object
+ */
+static void toggle_search_btn_clicked_cb(lv_event_t *event);
+
+/**
+ * Show or hide the search bar. While it is shown, the on-screen keyboard types into the
+ * search field instead of the shell.
+ *
+ * @param is_active true to show the search bar, false to hide it
+ */
+static void set_search_active(bool is_active);
+
+/**
+ * Handle LV_EVENT_VALUE_CHANGED events from the search field to search as the user types.
+ *
+ * @param event the event object
+ */
+static void search_textarea_value_changed_cb(lv_event_t *event);
 
-static void clear_top_tty(char* loc);
+/**
+ * Handle LV_EVENT_CLICKED events from the previous / next match buttons.
+ *
+ * @param event the event object, the user data points to true for older matches
+ */
+static void search_btn_clicked_cb(lv_event_t *event);
 
-static void split_and_add_tty();
+/**
+ * Jump to the next search match.
+ *
+ * @param older true to search towards older lines, false towards newer ones
+ */
+static void find_next_match(bool older);
 
-static void clean_illegal_chars(char *loc);
+/**
+ * Type a key of the on-screen keyboard into the search field.
+ *
+ * @param text text of the pressed key
+ */
+static void type_into_search(const char *text);
 
 /**
  * Static functions
@@ -216,8 +344,14 @@ static void toggle_keyboard_hidden(void) {
 }
 
 static void set_keyboard_hidden(bool is_hidden) {
+    /* The terminal shrinks before the keyboard slides in and grows once it has slid out */
+    if (!is_hidden) {
+        layout_terminal_box();
+    }
+
     if (!conf_opts.general.animations) {
         lv_obj_set_y(keyboard, is_hidden ? lv_obj_get_height(keyboard) : 0);
+        layout_terminal_box();
         return;
     }
 
@@ -228,6 +362,7 @@ static void set_keyboard_hidden(bool is_hidden) {
     lv_anim_set_path_cb(&keyboard_anim, lv_anim_path_ease_out);
     lv_anim_set_time(&keyboard_anim, 500);
     lv_anim_set_exec_cb(&keyboard_anim, keyboard_anim_y_cb);
+    lv_anim_set_ready_cb(&keyboard_anim, keyboard_anim_ready_cb);
     lv_anim_start(&keyboard_anim);
 }
 
@@ -235,6 +370,60 @@ static void keyboard_anim_y_cb(void* obj, int32_t value) {
     lv_obj_set_y(obj, value);
 }
 
+static void keyboard_anim_ready_cb(lv_anim_t *anim) {
+    LV_UNUSED(anim);
+    layout_terminal_box();
+}
+
+static void layout_terminal_box(void) {
+    if (!term_view || !keyboard) {
+        return;
+    }
+
+    const lv_coord_t keyboard_height = is_keyboard_hidden ? 0 : lv_obj_get_height(keyboard);
+    const lv_coord_t height = lv_obj_get_height(lv_scr_act()) - 100 - keyboard_height;
+    lv_coord_t cell_width;
+    lv_coord_t cell_height;
+    ul_termview_get_cell_size(term_view, &cell_width, &cell_height);
+    lv_obj_set_size(term_view, lv_obj_get_width(lv_scr_act()), LV_MAX(height, cell_height));
+}
+
+static void screen_size_changed_cb(lv_event_t *event) {
+    LV_UNUSED(event);
+
+    const lv_coord_t hor_res = lv_obj_get_width(lv_scr_act());
+    const lv_coord_t ver_res = lv_obj_get_height(lv_scr_act());
+    const lv_coord_t keyboard_height = ver_res > hor_res ? ver_res / 3 : ver_res / 2;
+
+    lv_obj_set_size(keyboard, hor_res, keyboard_height);
+    lv_obj_set_y(keyboard, is_keyboard_hidden ? keyboard_height : 0);
+    lv_obj_set_width(search_bar, hor_res);
+    layout_terminal_box();
+}
+
+static void terminal_box_size_changed_cb(lv_event_t *event) {
+    LV_UNUSED(event);
+
+    int cols;
+    int rows;
+    ul_termview_get_grid_size(term_view, &cols, &rows);
+    /* The parser never changes the size, so it can be read without locking */
+    if (!screen || (cols == screen->cols && rows == screen->rows)) {
+        return;
+    }
+
+    ul_parser_lock();
+    const bool is_resized = ul_screen_resize(screen, cols, rows);
+    ul_parser_unlock();
+    if (!is_resized) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not resize terminal to %dx%d", cols, rows);
+        return;
+    }
+
+    ul_terminal_resize(cols, rows);
+    render_screen();
+}
+
 static void close_mbox_cb(lv_event_t *event) {
     lv_obj_t *mbox = lv_event_get_current_target(event);
     lv_msgbox_close(mbox);
@@ -253,7 +442,18 @@ static void keyboard_value_changed_cb(lv_event_t *event) {
         return;
     }
 
+    if (is_search_active) {
+        type_into_search(lv_btnmatrix_get_btn_text(kb, btn_id));
+        return;
+    }
+
     lv_keyboard_def_event_cb(event);
+
+    /* The textarea only routes key presses to the shell, the terminal view shows the echo */
+    lv_textarea_set_text(t_box, "");
+    if (term_view) {
+        ul_termview_wake_cursor(term_view);
+    }
 }
 
 static void keyboard_ready_cb(lv_event_t *event) {
@@ -281,17 +481,17 @@ static void decrypt(void) {
     switch (conf_opts.general.backend) {
 #if USE_FBDEV
     case UL_BACKENDS_BACKEND_FBDEV:
-        fbdev_get_sizes(&hor_res, &ver_res, &dpi);
+        ul_fbdev_get_sizes(&hor_res, &ver_res, &dpi);
         break;
 #endif /* USE_FBDEV */
 #if USE_DRM
     case UL_BACKENDS_BACKEND_DRM:
-        drm_get_sizes((lv_coord_t *)&hor_res, (lv_coord_t *)&ver_res, &dpi);
+        ul_kms_get_sizes(&hor_res, &ver_res, &dpi);
         break;
 #endif /* USE_DRM */
 #if USE_MINUI
     case UL_BACKENDS_BACKEND_MINUI:
-        minui_get_sizes(&hor_res, &ver_res, &dpi);
+        ul_minuifb_get_sizes(&hor_res, &ver_res, &dpi);
         break;
 #endif /* USE_MINUI */
     default:
@@ -408,81 +608,147 @@ static void sigaction_handler(int signum) {
     exit(0);
 }
 
+static void stats_signal_handler(int signum) {
+    LV_UNUSED(signum);
+    stats_requested = 1;
+}
+
 static void update_tty_loop(lv_timer_t* timer) {
-    update_tty(ul_terminal_update_interpret_buffer(),BUFFER_SIZE,true);
-}
-
-static void update_tty(char *loc,int length, bool split)
-{
-    if (term_needs_update && length > 0) {
-        int maxlen = length == BUFFER_SIZE ? 9314 : 4096;
-        if (strstr(loc, "\033[2J") != NULL)
-            lv_textarea_set_text(t_box, "");
-        if (split) {
-            if ((strlen(lv_textarea_get_text(t_box)) + strlen(loc) >= 4096) && loc == ul_terminal_update_interpret_buffer()) {
-                split_and_add_tty();
-                return;
-            }
+    LV_UNUSED(timer);
+
+    ul_parser_update();
+    render_screen();
+}
+
+static void render_screen(void) {
+    if (ul_snapshot_apply(&snapshot, view_screen)) {
+        ul_termview_wake_cursor(term_view);
+    }
+
+    /* Cursor movements don't damage any cells, the cursor is checked on every call */
+    ul_render_invalidate_damage(term_view, view_screen);
+    ul_screen_present(view_screen);
+}
+
+static void terminal_box_pressing_cb(lv_event_t *event) {
+    LV_UNUSED(event);
+
+    lv_point_t vect;
+    lv_indev_get_vect(lv_indev_get_act(), &vect);
+    view_drag_y += vect.y;
+
+    lv_coord_t cell_width;
+    lv_coord_t cell_height;
+    ul_termview_get_cell_size(term_view, &cell_width, &cell_height);
+
+    /* Dragging down reveals older lines */
+    int lines = view_drag_y / cell_height;
+    if (lines != 0) {
+        view_drag_y -= lines * cell_height;
+        ul_parser_lock();
+        ul_screen_scroll_view(screen, lines);
+        ul_parser_unlock();
+        render_screen();
+    }
+}
+
+static void terminal_box_draw_post_cb(lv_event_t *event) {
+    if (!is_search_active || search.query_len == 0) {
+        return;
+    }
+
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(event);
+
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+    rect_dsc.bg_opa = LV_OPA_50;
+
+    /* Only rows in view are searched, hits further up or down are found on demand. The rows and
+     * the position of the current match come from the same snapshot, the model isn't touched. */
+    int match_x;
+    int match_y;
+    const bool has_match = ul_snapshot_get_mark(&snapshot, &match_x, &match_y);
+    for (int y = 0; y < view_screen->rows; ++y) {
+        const ul_row *row = ul_screen_get_view_row(view_screen, y);
+        for (int col = ul_search_find_in_row(&search, row, 0); col >= 0; col = ul_search_find_in_row(&search, row, col + search.query_len)) {
+            const bool is_current = has_match && match_y == y && match_x == col;
+            rect_dsc.bg_color = lv_palette_main(is_current ? LV_PALETTE_ORANGE : LV_PALETTE_YELLOW);
+
+            lv_area_t area;
+            ul_termview_get_cell_area(term_view, y, col, LV_MIN(col + search.query_len, view_screen->cols), &area);
+            lv_draw_rect(draw_ctx, &rect_dsc, &area);
         }
-        if (strlen(lv_textarea_get_text(t_box)) >= maxlen)
-            clear_top_tty(loc);
-        
-        remove_escape_codes(loc);
-        
-        clean_illegal_chars(loc);
-        
-        lv_textarea_add_text(t_box, loc);
-        
-        if (split)
-            term_needs_update = false;
-        for (char* i = loc; i < length + loc; i++)
-            *i = '\0';
-    }
-}
-
-static void split_and_add_tty()
-{
-    int j = ((strlen(lv_textarea_get_text(t_box)) + strlen(ul_terminal_update_interpret_buffer())) / 4096) + 1;
-    int section_size = strlen(ul_terminal_update_interpret_buffer()) / j;
-
-    for (int i = j; i >=1; i--) {
-        char* text_section = (char*)malloc(section_size+1);
-        memcpy(text_section, ul_terminal_update_interpret_buffer() + ((j - i) * section_size), section_size);
-        text_section[section_size] = '\0';
-        update_tty(text_section,section_size,false);
-        if (text_section != NULL) {
-            free(text_section);
-            text_section = NULL;
+    }
+}
+
+static void toggle_search_btn_clicked_cb(lv_event_t *event) {
+    LV_UNUSED(event);
+    set_search_active(!is_search_active);
+}
+
+static void set_search_active(bool is_active) {
+    is_search_active = is_active;
+
+    if (is_active) {
+        lv_obj_clear_flag(search_bar, LV_OBJ_FLAG_HIDDEN);
+        if (is_keyboard_hidden) {
+            toggle_keyboard_hidden();
         }
+    } else {
+        lv_obj_add_flag(search_bar, LV_OBJ_FLAG_HIDDEN);
+        lv_textarea_set_text(search_textarea, "");
+        ul_search_set_query(&search, "");
+        ul_parser_lock();
+        ul_snapshot_set_mark(&snapshot, false, 0, 0);
+        ul_screen_scroll_view(screen, -screen->view_offset);
+        ul_parser_unlock();
+        render_screen();
     }
 
-    term_needs_update = false;
+    lv_obj_invalidate(term_view);
 }
 
-static void clear_top_tty(char* loc)
-{
-    char text_buffer[9314];
+static void search_textarea_value_changed_cb(lv_event_t *event) {
+    LV_UNUSED(event);
 
-    strcpy(text_buffer,lv_textarea_get_text(t_box));
+    /* Start over from the newest line whenever the query changes */
+    ul_search_set_query(&search, lv_textarea_get_text(search_textarea));
+    find_next_match(true);
+}
 
-    char *new_text = text_buffer+strlen(loc);
+static void search_btn_clicked_cb(lv_event_t *event) {
+    find_next_match(*(const bool *)lv_event_get_user_data(event));
+}
 
-    lv_textarea_set_text(t_box,new_text);
+static void find_next_match(bool older) {
+    /* The match is published along with the view scrolled to it */
+    ul_parser_lock();
+    ul_search_find(&search, screen, older);
+    ul_snapshot_set_mark(&snapshot, search.has_match, search.match.line, search.match.col);
+    ul_parser_unlock();
+    render_screen();
+    lv_obj_invalidate(term_view);
 }
 
-static void clean_illegal_chars(char *loc)
-{
-    char *src = loc, *dst = loc;
+static void type_into_search(const char *text) {
+    if (!text) {
+        return;
+    }
 
-    while (*src != 0) {
-        if (isalnum((unsigned char)*src) || ispunct((unsigned char)*src) || isspace((unsigned char)*src)) {
-            *dst++ = *src;
-        }
-        src++;
+    if (strcmp(text, LV_SYMBOL_BACKSPACE) == 0) {
+        lv_textarea_del_char(search_textarea);
+    } else if (strcmp(text, LV_SYMBOL_OK) == 0) {
+        find_next_match(true);
+    } else if (strcmp(text, LV_SYMBOL_LEFT) == 0) {
+        lv_textarea_cursor_left(search_textarea);
+    } else if (strcmp(text, LV_SYMBOL_RIGHT) == 0) {
+        lv_textarea_cursor_right(search_textarea);
+    } else {
+        lv_textarea_add_text(search_textarea, text);
     }
-    *dst = '\0';
 }
 
+
 /**
  * Main
  */
@@ -499,9 +765,33 @@ int main(int argc, char *argv[]) {
     /* Announce ourselves */
     ul_log(UL_LOG_LEVEL_VERBOSE, "furios-terminal %s", UL_VERSION);
 
+    /* Pick the fastest glyph blending kernels for this CPU */
+    ul_blend_init();
+    if (cli_opts.benchmark) {
+        const bool is_blending_identical = ul_blend_run_benchmark();
+        printf("\n");
+        const bool is_converting_identical = ul_convert_run_benchmark();
+        exit(is_blending_identical && is_converting_identical ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
     /* Parse config files */
     ul_config_parse(cli_opts.config_files, cli_opts.num_config_files, &conf_opts);
 
+    /* Set up the shared table of cell attributes */
+    ul_attr_table_init();
+
+    /* Bound the memory used by compressed scrollback, spilling the rest to a file if configured */
+    ul_history_set_memory_budget((size_t)conf_opts.terminal.history_memory * 1024);
+    if (conf_opts.terminal.spill_directory) {
+        ul_spill_init(conf_opts.terminal.spill_directory, (size_t)conf_opts.terminal.spill_size * 1024 * 1024);
+    }
+
+    /* Bound the memory used by rasterised glyphs */
+    ul_atlas_set_budget((size_t)conf_opts.terminal.glyph_cache * 1024);
+
+    /* Dump statistics on demand */
+    signal(SIGUSR1, stats_signal_handler);
+
     /* Initialise LVGL and set up logging callback */
     lv_init();
 
@@ -514,26 +804,43 @@ int main(int argc, char *argv[]) {
     uint32_t ver_res = 0;
     uint32_t dpi = 0;
 
+    /* Backends that only need to write pixels can flush on a worker thread */
+    ul_flush_write_cb_t flush_write_cb = NULL;
+
     switch (conf_opts.general.backend) {
 #if USE_FBDEV
     case UL_BACKENDS_BACKEND_FBDEV:
-        fbdev_init();
-        fbdev_get_sizes(&hor_res, &ver_res, &dpi);
-        disp_drv.flush_cb = fbdev_flush;
+        if (!ul_fbdev_init(FBDEV_PATH, conf_opts.terminal.scroll == UL_CONFIG_SCROLL_PAN)) {
+            exit(EXIT_FAILURE);
+        }
+        ul_fbdev_get_sizes(&hor_res, &ver_res, &dpi);
+        flush_write_cb = ul_fbdev_write;
+        disp_drv.flush_cb = ul_flush_cb;
+        disp_drv.wait_cb = ul_flush_wait_cb;
+        if (conf_opts.terminal.scroll != UL_CONFIG_SCROLL_REDRAW) {
+            ul_render_set_blit_cb(ul_fbdev_blit_scroll);
+        }
         break;
 #endif /* USE_FBDEV */
 #if USE_DRM
     case UL_BACKENDS_BACKEND_DRM:
-        drm_init();
-        drm_get_sizes((lv_coord_t *)&hor_res, (lv_coord_t *)&ver_res, &dpi);
-        disp_drv.flush_cb = drm_flush;
+        if (!ul_kms_init(DRM_CARD, DRM_CONNECTOR_ID)) {
+            exit(EXIT_FAILURE);
+        }
+        ul_kms_get_sizes(&hor_res, &ver_res, &dpi);
+        disp_drv.flush_cb = ul_kms_flush;
+        if (conf_opts.terminal.scroll != UL_CONFIG_SCROLL_REDRAW) {
+            ul_render_set_blit_cb(ul_kms_blit_scroll);
+        }
         break;
 #endif /* USE_DRM */
 #if USE_MINUI
     case UL_BACKENDS_BACKEND_MINUI:
-        minui_init();
-        minui_get_sizes(&hor_res, &ver_res, &dpi);
-        disp_drv.flush_cb = minui_flush;
+        if (!ul_minuifb_init()) {
+            exit(EXIT_FAILURE);
+        }
+        ul_minuifb_get_sizes(&hor_res, &ver_res, &dpi);
+        disp_drv.flush_cb = ul_minuifb_flush;
         break;
 #endif /* USE_MINUI */
     default:
@@ -552,19 +859,49 @@ int main(int argc, char *argv[]) {
         dpi = cli_opts.dpi;
     }
 
-    /* Prepare display buffer */
-    const size_t buf_size = hor_res * ver_res / 10; /* At least 1/10 of the display size is recommended */
-    lv_disp_draw_buf_t disp_buf;
-    lv_color_t *buf = (lv_color_t *)malloc(buf_size * sizeof(lv_color_t));
-    lv_disp_draw_buf_init(&disp_buf, buf, NULL, buf_size);
+    /* Render straight into the framebuffer if possible, saving a copy of every redrawn pixel */
+    static lv_disp_draw_buf_t disp_buf;
+    bool is_direct = false;
+    if (conf_opts.general.direct_rendering && cli_opts.hor_res <= 0 && cli_opts.ver_res <= 0
+            && cli_opts.x_offset == 0 && cli_opts.y_offset == 0) {
+        switch (conf_opts.general.backend) {
+#if USE_FBDEV
+        case UL_BACKENDS_BACKEND_FBDEV:
+            is_direct = ul_fbdev_init_direct_buffer(&disp_buf);
+            break;
+#endif /* USE_FBDEV */
+#if USE_DRM
+        case UL_BACKENDS_BACKEND_DRM:
+            is_direct = ul_kms_init_direct_buffer(&disp_buf);
+            break;
+#endif /* USE_DRM */
+        default:
+            break;
+        }
+    }
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Rendering %s", is_direct ? "directly into the framebuffer" : "into a separate buffer");
+
+    /* Otherwise prepare display buffers, with two LVGL renders into one while the other is flushed */
+    const bool is_async_flush = !is_direct && flush_write_cb && conf_opts.general.draw_buffers > 1;
+    if (!is_direct) {
+        const size_t buf_size = hor_res * ver_res * conf_opts.general.draw_buffer / 100; /* draw-buffer percent of the display */
+        lv_color_t *buf1 = (lv_color_t *)malloc(buf_size * sizeof(lv_color_t));
+        lv_color_t *buf2 = is_async_flush ? (lv_color_t *)malloc(buf_size * sizeof(lv_color_t)) : NULL;
+        lv_disp_draw_buf_init(&disp_buf, buf1, buf2, buf_size);
+    }
+    if (flush_write_cb) {
+        ul_flush_init(flush_write_cb, is_async_flush);
+    }
 
     /* Register display driver */
     disp_drv.draw_buf = &disp_buf;
+    disp_drv.direct_mode = is_direct;
     disp_drv.hor_res = hor_res;
     disp_drv.ver_res = ver_res;
     disp_drv.offset_x = cli_opts.x_offset;
     disp_drv.offset_y = cli_opts.y_offset;
     disp_drv.dpi = dpi;
+    disp_drv.monitor_cb = ul_render_monitor_cb;
     lv_disp_drv_register(&disp_drv);
 
     /* Connect input devices */
@@ -579,6 +916,8 @@ int main(int argc, char *argv[]) {
     const int padding = keyboard_height / 8;
     const int label_width = hor_res - 2 * padding;
 
+    /* Scale the terminal font by whole pixels so that it stays crisp on dense displays */
+    ul_theme_set_terminal_font(ul_font_get_terminal(ul_font_get_scale_for_dpi(disp_drv.dpi)));
     ul_theme_apply(&(ul_themes_themes[0]));
 
     /* Main flexbox */
@@ -607,17 +946,78 @@ int main(int argc, char *argv[]) {
     lv_obj_align(furios_label, LV_ALIGN_TOP_MID, 0, 50);
 
     /* Terminal box */
+    term_view = ul_termview_create(lv_scr_act());
+    static lv_style_t term_view_style;
+    lv_style_init(&term_view_style);
+    lv_style_set_bg_color(&term_view_style, lv_color_black());
+    lv_style_set_text_color(&term_view_style, lv_color_white());
+    lv_style_set_border_color(&term_view_style, lv_color_black());
+    lv_obj_add_style(term_view, &term_view_style, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_refresh_style(term_view, LV_PART_MAIN,LV_STYLE_PROP_ANY);
+    lv_obj_align(term_view, LV_ALIGN_TOP_MID, 0, 100);
+    lv_obj_set_size(term_view, hor_res, ver_res-100-keyboard_height);
+    lv_obj_add_event_cb(term_view, terminal_box_pressing_cb, LV_EVENT_PRESSING, NULL);
+    lv_obj_add_event_cb(term_view, terminal_box_draw_post_cb, LV_EVENT_DRAW_POST, NULL);
+    lv_obj_add_event_cb(term_view, terminal_box_size_changed_cb, LV_EVENT_SIZE_CHANGED, NULL);
+    lv_obj_add_state(term_view, LV_STATE_FOCUSED);
+    ul_termview_set_cursor_blink(term_view, (uint32_t)conf_opts.terminal.cursor_blink_idle * 1000);
+
+    /* Hidden textarea that the on-screen keyboard types into, its cursor animation would keep LVGL busy */
     t_box = lv_textarea_create(lv_scr_act());
-    static lv_style_t t_box_style;
-    lv_style_init(&t_box_style);
-    lv_style_set_bg_color(&t_box_style, lv_color_black());
-    lv_style_set_text_color(&t_box_style, lv_color_white());
-    lv_style_set_border_color(&t_box_style, lv_color_black());
-    lv_obj_add_style(t_box, &t_box_style, LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_obj_refresh_style(t_box, LV_PART_MAIN,LV_STYLE_PROP_ANY);
-    lv_obj_align(t_box, LV_ALIGN_TOP_MID, 0, 100);
-    lv_obj_set_size(t_box, hor_res, ver_res-100-keyboard_height);
-    lv_event_send(t_box, LV_EVENT_FOCUSED, NULL);
+    lv_obj_add_flag(t_box, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_style_anim_time(t_box, 0, LV_PART_CURSOR | LV_STATE_FOCUSED);
+
+    /* Screen model sized to the terminal box */
+    lv_obj_update_layout(term_view);
+    int term_cols;
+    int term_rows;
+    ul_termview_get_grid_size(term_view, &term_cols, &term_rows);
+
+    screen = ul_screen_create(term_cols, term_rows, conf_opts.terminal.scrollback);
+    view_screen = ul_screen_create(term_cols, term_rows, 0);
+    if (!screen || !view_screen) {
+        exit(EXIT_FAILURE);
+    }
+    ul_vt_init(&vt, screen);
+    ul_snapshot_init(&snapshot);
+    ul_termview_set_screen(term_view, view_screen);
+
+    /* Search toggle button */
+    lv_obj_t *toggle_search_btn = lv_btn_create(top_label_container);
+    lv_obj_align(toggle_search_btn, LV_ALIGN_TOP_RIGHT, 0, 40);
+    lv_obj_add_event_cb(toggle_search_btn, toggle_search_btn_clicked_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *toggle_search_btn_label = lv_label_create(toggle_search_btn);
+    lv_label_set_text(toggle_search_btn_label, "Find");
+    lv_obj_center(toggle_search_btn_label);
+
+    /* Search bar, shown on top of the title while searching */
+    search_bar = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(search_bar, hor_res, 100);
+    lv_obj_align(search_bar, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_flex_flow(search_bar, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(search_bar, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(search_bar, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(search_bar, LV_OBJ_FLAG_HIDDEN);
+
+    search_textarea = lv_textarea_create(search_bar);
+    lv_textarea_set_one_line(search_textarea, true);
+    lv_textarea_set_placeholder_text(search_textarea, "Search history...");
+    lv_obj_set_flex_grow(search_textarea, 1);
+    lv_obj_add_event_cb(search_textarea, search_textarea_value_changed_cb, LV_EVENT_VALUE_CHANGED, NULL);
+
+    /* Previous (older) / next (newer) match and close buttons */
+    const int search_btn_size = lv_obj_get_height(search_textarea);
+    const char *search_btn_symbols[] = { LV_SYMBOL_UP, LV_SYMBOL_DOWN, LV_SYMBOL_CLOSE };
+    for (int i = 0; i < 3; ++i) {
+        lv_obj_t *btn = lv_btn_create(search_bar);
+        lv_obj_set_size(btn, search_btn_size, search_btn_size);
+        lv_obj_t *btn_label = lv_label_create(btn);
+        lv_label_set_text(btn_label, search_btn_symbols[i]);
+        lv_obj_center(btn_label);
+    }
+    lv_obj_add_event_cb(lv_obj_get_child(search_bar, 1), search_btn_clicked_cb, LV_EVENT_CLICKED, &search_older);
+    lv_obj_add_event_cb(lv_obj_get_child(search_bar, 2), search_btn_clicked_cb, LV_EVENT_CLICKED, &search_newer);
+    lv_obj_add_event_cb(lv_obj_get_child(search_bar, 3), toggle_search_btn_clicked_cb, LV_EVENT_CLICKED, NULL);
 
     /* Keyboard */
     keyboard = lv_keyboard_create(lv_scr_act());
@@ -630,13 +1030,21 @@ int main(int argc, char *argv[]) {
     lv_obj_set_size(keyboard, hor_res, keyboard_height);
     ul_theme_prepare_keyboard(keyboard);
 
+    /* Follow rotations of the display */
+    lv_obj_add_event_cb(lv_scr_act(), screen_size_changed_cb, LV_EVENT_SIZE_CHANGED, NULL);
+
     toggle_keyboard_hidden();
 
 
-    if (!ul_terminal_prepare_current_terminal((int)lv_obj_get_width(t_box),(int)lv_obj_get_height(t_box)))
-        lv_textarea_add_text(t_box, "Could not prepare the terminal!");
-       
-    lv_timer_t* tty_update = lv_timer_create(update_tty_loop, 50, NULL);
+    if (!ul_terminal_prepare_current_terminal(term_cols, term_rows)) {
+        const char *error = "Could not prepare the terminal!";
+        ul_vt_feed(&vt, error, strlen(error));
+    }
+
+    /* Parsing on another core keeps floods of output from holding up rendering */
+    ul_parser_start(&vt, screen, &snapshot, sysconf(_SC_NPROCESSORS_ONLN) > 1);
+
+    lv_timer_create(update_tty_loop, 50, NULL);
 
     /* Run lvgl in "tickless" mode */
     uint32_t timeout = conf_opts.general.timeout * 1000; /* ms */
@@ -646,6 +1054,17 @@ int main(int argc, char *argv[]) {
         } else if (timeout) {
             shutdown();
         }
+        if (stats_requested) {
+            stats_requested = 0;
+            ul_stats_log();
+        }
+#if USE_DRM
+        if (conf_opts.general.backend == UL_BACKENDS_BACKEND_DRM) {
+            /* Sleep until a page flip completes, which lets the display refresh again */
+            ul_kms_handle_events(5);
+            continue;
+        }
+#endif /* USE_DRM */
         usleep(5000);
     }
 
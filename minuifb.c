@@ -0,0 +1,180 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "minuifb.h"
+
+#if USE_MINUI
+
+#include "convert.h"
+#include "log.h"
+
+#include <minui/minui.h>
+#include <stdlib.h>
+
+
+/**
+ * Static variables
+ */
+
+static bool is_initialised = false;
+static GRSurface shadow;
+static ul_convert_format format = UL_CONVERT_FORMAT_XBGR8888;
+
+static lv_area_t frame_damage;
+static bool has_frame_damage = false;
+static lv_area_t prev_frame_damage;
+static bool has_prev_frame_damage = false;
+
+static unsigned long long copied_bytes = 0;
+static unsigned long long blitted_bytes = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Clip an area to the display.
+ *
+ * @param area area to clip
+ * @param clipped pointer for writing the clipped area into
+ * @return true if any part of the area is visible, false otherwise
+ */
+static bool clip_to_screen(const lv_area_t *area, lv_area_t *clipped);
+
+/**
+ * Copy an area of the shadow surface into minui's draw surface.
+ *
+ * @param area area to copy, clipped to the display
+ */
+static void blit_area(const lv_area_t *area);
+
+
+/**
+ * Static functions
+ */
+
+static bool clip_to_screen(const lv_area_t *area, lv_area_t *clipped) {
+    clipped->x1 = LV_MAX(area->x1, 0);
+    clipped->y1 = LV_MAX(area->y1, 0);
+    clipped->x2 = LV_MIN(area->x2, (lv_coord_t)shadow.width - 1);
+    clipped->y2 = LV_MIN(area->y2, (lv_coord_t)shadow.height - 1);
+    return clipped->x1 <= clipped->x2 && clipped->y1 <= clipped->y2;
+}
+
+static void blit_area(const lv_area_t *area) {
+    gr_blit(&shadow, area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area), area->x1, area->y1);
+    blitted_bytes += (unsigned long long)lv_area_get_size(area) * shadow.pixel_bytes;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_minuifb_init(void) {
+    if (gr_init() != 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not initialise minui");
+        return false;
+    }
+    is_initialised = true;
+
+    /* minui's draw surface always has 32 bit pixels. It stores red in the first byte, unless
+     * the build swaps red and blue for panels that expect BGRA. */
+#if MINUI_IS_BGRA
+    format = UL_CONVERT_FORMAT_XRGB8888;
+#else
+    format = UL_CONVERT_FORMAT_XBGR8888;
+#endif /* MINUI_IS_BGRA */
+
+    shadow.width = gr_fb_width();
+    shadow.height = gr_fb_height();
+    shadow.pixel_bytes = (int)ul_convert_get_bytes_per_pixel(format);
+    shadow.row_bytes = shadow.width * shadow.pixel_bytes;
+    shadow.data = calloc((size_t)shadow.height, (size_t)shadow.row_bytes);
+    if (!shadow.data) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate %dx%d shadow surface", shadow.width, shadow.height);
+        ul_minuifb_exit();
+        return false;
+    }
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "minui display is %dx%d in %s", shadow.width, shadow.height, ul_convert_get_format_name(format));
+    return true;
+}
+
+void ul_minuifb_exit(void) {
+    free(shadow.data);
+    shadow.data = NULL;
+    if (is_initialised) {
+        gr_exit();
+        is_initialised = false;
+    }
+}
+
+void ul_minuifb_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi) {
+    *width = (uint32_t)shadow.width;
+    *height = (uint32_t)shadow.height;
+    if (dpi) {
+        *dpi = 0; /* minui doesn't know the panel's physical size */
+    }
+}
+
+void ul_minuifb_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    lv_area_t clipped;
+    if (shadow.data && clip_to_screen(area, &clipped)) {
+        const lv_coord_t src_width = lv_area_get_width(area);
+        const lv_coord_t width = lv_area_get_width(&clipped);
+        for (lv_coord_t y = clipped.y1; y <= clipped.y2; ++y) {
+            const lv_color_t *src = color_p + (size_t)(y - area->y1) * src_width + (clipped.x1 - area->x1);
+            ul_convert_row(format, shadow.data + (size_t)y * shadow.row_bytes + (size_t)clipped.x1 * shadow.pixel_bytes, src, (size_t)width);
+        }
+        copied_bytes += (unsigned long long)lv_area_get_size(&clipped) * shadow.pixel_bytes;
+
+        if (has_frame_damage) {
+            _lv_area_join(&frame_damage, &frame_damage, &clipped);
+        } else {
+            frame_damage = clipped;
+            has_frame_damage = true;
+        }
+    }
+
+    if (lv_disp_flush_is_last(disp_drv) && has_frame_damage) {
+        /* minui flips between two draw surfaces, the one drawn into now last showed the frame
+         * before the previous one and misses that frame's changes too */
+        blit_area(&frame_damage);
+        if (has_prev_frame_damage && !_lv_area_is_in(&prev_frame_damage, &frame_damage, 0)) {
+            blit_area(&prev_frame_damage);
+        }
+        gr_flip();
+
+        prev_frame_damage = frame_damage;
+        has_prev_frame_damage = true;
+        has_frame_damage = false;
+    }
+
+    lv_disp_flush_ready(disp_drv);
+}
+
+void ul_minuifb_get_stats(ul_minuifb_stats *stats) {
+    stats->copied_bytes = copied_bytes;
+    stats->blitted_bytes = blitted_bytes;
+}
+
+#endif /* USE_MINUI */
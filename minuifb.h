@@ -0,0 +1,77 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_MINUIFB_H
+#define UL_MINUIFB_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * minui output statistics
+ */
+typedef struct {
+    /* Bytes converted from LVGL's draw buffer into the shadow surface */
+    unsigned long long copied_bytes;
+    /* Bytes blitted from the shadow surface into minui's draw surface */
+    unsigned long long blitted_bytes;
+} ul_minuifb_stats;
+
+/**
+ * Initialise minui and allocate a shadow surface of the display's size.
+ *
+ * @return true on success, false otherwise
+ */
+bool ul_minuifb_init(void);
+
+/**
+ * Free the shadow surface and shut minui down.
+ */
+void ul_minuifb_exit(void);
+
+/**
+ * Get the size of minui's display.
+ *
+ * @param width pointer for writing the horizontal resolution into
+ * @param height pointer for writing the vertical resolution into
+ * @param dpi pointer for writing the DPI into (0 if unknown), may be NULL
+ */
+void ul_minuifb_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi);
+
+/**
+ * Convert rendered pixels into the shadow surface and, after the last area of a frame, blit
+ * the changed parts into minui's draw surface and flip. Used as LVGL flush callback.
+ *
+ * @param disp_drv display driver
+ * @param area area to write to
+ * @param color_p pixels of the area, row by row
+ */
+void ul_minuifb_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Get minui output statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_minuifb_get_stats(ul_minuifb_stats *stats);
+
+#endif /* UL_MINUIFB_H */
@@ -0,0 +1,162 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "parser.h"
+
+#include "clock.h"
+#include "log.h"
+#include "terminal.h"
+
+#include <pthread.h>
+
+
+/**
+ * Defines
+ */
+
+/* Time the thread sleeps without output before retrying a failed publish */
+#define WAIT_TIMEOUT_MS 100
+
+
+/**
+ * Static variables
+ */
+
+static ul_vt *parser_vt = NULL;
+static ul_screen *parser_screen = NULL;
+static ul_snapshot *parser_snapshot = NULL;
+static bool is_threaded = false;
+
+/* Guards the screen model */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long num_chunks = 0;
+static unsigned long long num_bytes = 0;
+static unsigned long long parse_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Feed waiting output into the screen model and publish it.
+ *
+ * @param timeout_ms maximum time to wait for output in milliseconds
+ */
+static void parse_output(int timeout_ms);
+
+/**
+ * Parse output as it arrives.
+ *
+ * @param arg unused
+ * @return never returns
+ */
+static void *parser_thread(void *arg);
+
+
+/**
+ * Static functions
+ */
+
+static void parse_output(int timeout_ms) {
+    const bool has_output = ul_terminal_wait_for_output(timeout_ms);
+
+    pthread_mutex_lock(&mutex);
+    const int64_t start_us = ul_clock_get_us();
+    if (has_output) {
+        const int len = ul_terminal_get_interpret_buffer_length();
+        ul_vt_feed(parser_vt, ul_terminal_update_interpret_buffer(), len);
+        ul_terminal_release_output();
+        ++num_chunks;
+        num_bytes += (unsigned long long)len;
+    }
+
+    /* The shell reads its next output while the view is copied */
+    ul_snapshot_publish(parser_snapshot, parser_screen);
+    parse_us += (unsigned long long)(ul_clock_get_us() - start_us);
+    pthread_mutex_unlock(&mutex);
+}
+
+static void *parser_thread(void *arg) {
+    (void)arg;
+
+    while (1) {
+        parse_output(WAIT_TIMEOUT_MS);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_parser_start(ul_vt *vt, ul_screen *screen, ul_snapshot *snapshot, bool threaded) {
+    parser_vt = vt;
+    parser_screen = screen;
+    parser_snapshot = snapshot;
+    is_threaded = false;
+
+    /* Show whatever was written to the screen before */
+    ul_snapshot_publish(snapshot, screen);
+
+    if (!threaded) {
+        return true;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, parser_thread, NULL) != 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not start parser thread, parsing on the main loop");
+        return false;
+    }
+    pthread_detach(thread);
+    is_threaded = true;
+
+    return true;
+}
+
+void ul_parser_update(void) {
+    if (!parser_screen || is_threaded) {
+        return;
+    }
+    parse_output(0);
+}
+
+void ul_parser_lock(void) {
+    pthread_mutex_lock(&mutex);
+}
+
+void ul_parser_unlock(void) {
+    if (parser_screen) {
+        ul_snapshot_publish(parser_snapshot, parser_screen);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void ul_parser_get_stats(ul_parser_stats *stats) {
+    pthread_mutex_lock(&mutex);
+    stats->chunks = num_chunks;
+    stats->bytes = num_bytes;
+    stats->parse_us = parse_us;
+    stats->is_threaded = is_threaded;
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,82 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_PARSER_H
+#define UL_PARSER_H
+
+#include "screen.h"
+#include "snapshot.h"
+#include "vt.h"
+
+#include <stdbool.h>
+
+/**
+ * Parsing statistics
+ */
+typedef struct {
+    /* Number of output chunks fed into the screen model */
+    unsigned long chunks;
+    /* Number of output bytes fed into the screen model */
+    unsigned long long bytes;
+    /* Time spent parsing output and publishing the screen (in microseconds) */
+    unsigned long long parse_us;
+    /* True if output is parsed on its own thread */
+    bool is_threaded;
+} ul_parser_stats;
+
+/**
+ * Hand the screen model over to the parser, which feeds the shell's output into it and
+ * publishes its view into a snapshot. From now on the screen may only be accessed between
+ * ul_parser_lock and ul_parser_unlock.
+ *
+ * @param vt escape sequence parser writing into screen
+ * @param screen screen model
+ * @param snapshot snapshot to publish the screen into
+ * @param threaded if true, parse on a thread of its own so that rendering never waits for it
+ * @return true on success, false if the thread could not be started and output is parsed in
+ * ul_parser_update
+ */
+bool ul_parser_start(ul_vt *vt, ul_screen *screen, ul_snapshot *snapshot, bool threaded);
+
+/**
+ * Parse pending output and publish the screen if the parser has no thread of its own. Call
+ * this periodically from the main loop.
+ */
+void ul_parser_update(void);
+
+/**
+ * Get exclusive access to the screen model, e.g. for scrolling or searching it. Blocks while
+ * a chunk of output is parsed.
+ */
+void ul_parser_lock(void);
+
+/**
+ * Give up access to the screen model and publish any changes made to it.
+ */
+void ul_parser_unlock(void);
+
+/**
+ * Get parsing statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_parser_get_stats(ul_parser_stats *stats);
+
+#endif /* UL_PARSER_H */
@@ -0,0 +1,371 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "reflow.h"
+
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/* Number of logical line slots allocated upfront */
+#define INITIAL_CAPACITY 64
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get the number of display rows a logical line occupies.
+ *
+ * @param line logical line
+ * @param cols display width
+ * @return number of rows, at least 1
+ */
+static int rows_for(const ul_reflow_line *line, int cols);
+
+/**
+ * Add a value to a slot of the Fenwick tree.
+ *
+ * @param reflow index
+ * @param slot slot index (0-based)
+ * @param delta value to add
+ */
+static void tree_add(ul_reflow *reflow, int slot, int delta);
+
+/**
+ * Get the sum of the display rows of all slots before a slot.
+ *
+ * @param reflow index
+ * @param slot slot index (0-based)
+ * @return number of rows
+ */
+static int tree_prefix(const ul_reflow *reflow, int slot);
+
+/**
+ * Recompute the Fenwick tree from the live logical lines in O(n).
+ *
+ * @param reflow index
+ */
+static void rebuild_tree(ul_reflow *reflow);
+
+/**
+ * Make sure there is a free slot after the last logical line, moving the live lines to
+ * the front or growing the arrays as needed.
+ *
+ * @param reflow index
+ * @return true on success, false if memory is short
+ */
+static bool make_room(ul_reflow *reflow);
+
+
+/**
+ * Static functions
+ */
+
+static int rows_for(const ul_reflow_line *line, int cols) {
+    return line->len == 0 ? 1 : (int)((line->len + cols - 1) / cols);
+}
+
+static void tree_add(ul_reflow *reflow, int slot, int delta) {
+    for (int i = slot + 1; i <= reflow->capacity; i += i & -i) {
+        reflow->tree[i] += delta;
+    }
+}
+
+static int tree_prefix(const ul_reflow *reflow, int slot) {
+    int sum = 0;
+    for (int i = slot; i > 0; i -= i & -i) {
+        sum += reflow->tree[i];
+    }
+    return sum;
+}
+
+static void rebuild_tree(ul_reflow *reflow) {
+    memset(reflow->tree, 0, (reflow->capacity + 1) * sizeof(int32_t));
+
+    reflow->num_rows = 0;
+    for (int slot = reflow->head; slot < reflow->head + reflow->count; ++slot) {
+        int rows = rows_for(&(reflow->lines[slot]), reflow->cols);
+        reflow->tree[slot + 1] = rows;
+        reflow->num_rows += rows;
+    }
+
+    /* Push each node's sum up to its parent */
+    for (int i = 1; i <= reflow->capacity; ++i) {
+        int parent = i + (i & -i);
+        if (parent <= reflow->capacity) {
+            reflow->tree[parent] += reflow->tree[i];
+        }
+    }
+}
+
+static bool make_room(ul_reflow *reflow) {
+    if (reflow->head + reflow->count < reflow->capacity) {
+        return true;
+    }
+
+    /* Grow while at least half the slots are live so that compacting stays amortised O(1) */
+    if (reflow->count >= reflow->capacity / 2) {
+        int capacity = reflow->capacity * 2;
+        ul_reflow_line *lines = realloc(reflow->lines, capacity * sizeof(ul_reflow_line));
+        if (!lines) {
+            return false;
+        }
+        reflow->lines = lines;
+
+        int32_t *tree = realloc(reflow->tree, (capacity + 1) * sizeof(int32_t));
+        if (!tree) {
+            return false;
+        }
+        reflow->tree = tree;
+        reflow->capacity = capacity;
+    }
+
+    memmove(reflow->lines, reflow->lines + reflow->head, reflow->count * sizeof(ul_reflow_line));
+    reflow->head = 0;
+    rebuild_tree(reflow);
+
+    return true;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_reflow_init(ul_reflow *reflow, int cols) {
+    memset(reflow, 0, sizeof(ul_reflow));
+    reflow->cols = cols < 1 ? 1 : cols;
+    reflow->capacity = INITIAL_CAPACITY;
+    reflow->lines = malloc(reflow->capacity * sizeof(ul_reflow_line));
+    reflow->tree = calloc(reflow->capacity + 1, sizeof(int32_t));
+    if (!reflow->lines || !reflow->tree) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for line index");
+        ul_reflow_free(reflow);
+        return false;
+    }
+    return true;
+}
+
+void ul_reflow_free(ul_reflow *reflow) {
+    free(reflow->lines);
+    free(reflow->tree);
+    reflow->lines = NULL;
+    reflow->tree = NULL;
+    reflow->capacity = 0;
+    reflow->head = 0;
+    reflow->count = 0;
+}
+
+void ul_reflow_clear(ul_reflow *reflow) {
+    reflow->oldest_line += reflow->num_lines;
+    reflow->num_lines = 0;
+    reflow->head = 0;
+    reflow->count = 0;
+    reflow->num_rows = 0;
+    reflow->is_open = false;
+    if (reflow->tree) {
+        memset(reflow->tree, 0, (reflow->capacity + 1) * sizeof(int32_t));
+    }
+}
+
+void ul_reflow_push_line(ul_reflow *reflow, int len, int width, bool is_wrapped) {
+    ul_reflow_line *last = reflow->count > 0 ? &(reflow->lines[reflow->head + reflow->count - 1]) : NULL;
+    bool is_continuation = reflow->is_open && last && last->width == width;
+
+    len = MIN(len, width);
+    reflow->is_open = is_wrapped;
+    ++reflow->num_lines;
+
+    if (!is_continuation && !make_room(reflow)) {
+        /* Out of slots: keep the line reachable by appending it to the previous one */
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not grow line index, joining lines");
+        is_continuation = last != NULL;
+        if (!is_continuation) {
+            return;
+        }
+    }
+
+    if (is_continuation) {
+        int slot = reflow->head + reflow->count - 1;
+        last = &(reflow->lines[slot]); /* The slots may have moved while making room */
+        int old_rows = rows_for(last, reflow->cols);
+        last->len = last->num_lines * last->width + len;
+        ++last->num_lines;
+        int rows = rows_for(last, reflow->cols);
+        tree_add(reflow, slot, rows - old_rows);
+        reflow->num_rows += rows - old_rows;
+        return;
+    }
+
+    int slot = reflow->head + reflow->count++;
+    ul_reflow_line *line = &(reflow->lines[slot]);
+    line->first_line = reflow->oldest_line + (uint32_t)(reflow->num_lines - 1);
+    line->num_lines = 1;
+    line->len = (uint32_t)len;
+    line->width = (uint16_t)width;
+
+    int rows = rows_for(line, reflow->cols);
+    tree_add(reflow, slot, rows);
+    reflow->num_rows += rows;
+}
+
+void ul_reflow_drop_lines(ul_reflow *reflow, int n) {
+    n = MIN(n, reflow->num_lines);
+    reflow->num_lines -= n;
+    reflow->oldest_line += (uint32_t)n;
+
+    while (n > 0 && reflow->count > 0) {
+        ul_reflow_line *line = &(reflow->lines[reflow->head]);
+        int old_rows = rows_for(line, reflow->cols);
+
+        if (line->num_lines <= (uint32_t)n) {
+            n -= (int)line->num_lines;
+            tree_add(reflow, reflow->head, -old_rows);
+            reflow->num_rows -= old_rows;
+            ++reflow->head;
+            --reflow->count;
+            continue;
+        }
+
+        /* The line's first physical lines are gone, keep the rest */
+        uint32_t dropped_cells = (uint32_t)n * line->width;
+        line->first_line += (uint32_t)n;
+        line->num_lines -= (uint32_t)n;
+        line->len = line->len > dropped_cells ? line->len - dropped_cells : 0;
+        int rows = rows_for(line, reflow->cols);
+        tree_add(reflow, reflow->head, rows - old_rows);
+        reflow->num_rows += rows - old_rows;
+        n = 0;
+    }
+
+    if (reflow->count == 0) {
+        reflow->head = 0;
+        reflow->is_open = false;
+    }
+}
+
+void ul_reflow_pop_lines(ul_reflow *reflow, int n) {
+    n = MIN(n, reflow->num_lines);
+    reflow->num_lines -= n;
+
+    while (n > 0 && reflow->count > 0) {
+        int slot = reflow->head + reflow->count - 1;
+        ul_reflow_line *line = &(reflow->lines[slot]);
+        int old_rows = rows_for(line, reflow->cols);
+
+        if (line->num_lines <= (uint32_t)n) {
+            n -= (int)line->num_lines;
+            tree_add(reflow, slot, -old_rows);
+            reflow->num_rows -= old_rows;
+            --reflow->count;
+            reflow->is_open = false;
+            continue;
+        }
+
+        /* The line's last physical lines are gone, the remaining ones all wrapped */
+        line->num_lines -= (uint32_t)n;
+        line->len = line->num_lines * line->width;
+        int rows = rows_for(line, reflow->cols);
+        tree_add(reflow, slot, rows - old_rows);
+        reflow->num_rows += rows - old_rows;
+        reflow->is_open = true;
+        n = 0;
+    }
+
+    if (reflow->count == 0) {
+        reflow->head = 0;
+    }
+}
+
+void ul_reflow_set_cols(ul_reflow *reflow, int cols) {
+    cols = cols < 1 ? 1 : cols;
+    if (cols == reflow->cols) {
+        return;
+    }
+    reflow->cols = cols;
+    rebuild_tree(reflow);
+}
+
+int ul_reflow_get_row_count(const ul_reflow *reflow) {
+    return reflow->num_rows;
+}
+
+bool ul_reflow_get_span(const ul_reflow *reflow, int row, ul_reflow_span *span) {
+    if (row < 0 || row >= reflow->num_rows) {
+        return false;
+    }
+
+    /* Descend the tree to the last slot whose prefix sum doesn't exceed the row */
+    int step = 1;
+    while (step * 2 <= reflow->capacity) {
+        step *= 2;
+    }
+
+    int pos = 0;
+    int remainder = row;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= reflow->capacity && reflow->tree[pos + step] <= remainder) {
+            pos += step;
+            remainder -= reflow->tree[pos];
+        }
+    }
+
+    const ul_reflow_line *line = &(reflow->lines[pos]);
+    span->line = (int)(line->first_line - reflow->oldest_line);
+    span->width = line->width;
+    span->start = remainder * reflow->cols;
+    span->len = (int)line->len > span->start ? MIN(reflow->cols, (int)line->len - span->start) : 0;
+
+    return true;
+}
+
+int ul_reflow_get_row_of(const ul_reflow *reflow, int line, int col) {
+    if (reflow->count == 0) {
+        return 0;
+    }
+
+    /* Binary search for the last logical line starting at or before the physical line */
+    int lo = reflow->head;
+    int hi = reflow->head + reflow->count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if ((int)(reflow->lines[mid].first_line - reflow->oldest_line) <= line) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    const ul_reflow_line *found = &(reflow->lines[lo]);
+    int offset = (line - (int)(found->first_line - reflow->oldest_line)) * found->width + col;
+    int row = offset < 0 ? 0 : MIN(offset / reflow->cols, rows_for(found, reflow->cols) - 1);
+
+    return tree_prefix(reflow, lo) + row;
+}
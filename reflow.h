@@ -0,0 +1,171 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_REFLOW_H
+#define UL_REFLOW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A logical line: a run of physical lines joined by automatic wraps, all written at the
+ * same width
+ */
+typedef struct {
+    /* Sequence number of the first physical line */
+    uint32_t first_line;
+    /* Number of physical lines */
+    uint32_t num_lines;
+    /* Number of cells, every physical line except the last one counts as full */
+    uint32_t len;
+    /* Number of columns the physical lines were written at */
+    uint16_t width;
+} ul_reflow_line;
+
+/**
+ * Part of a logical line that makes up one display row
+ */
+typedef struct {
+    /* Index of the logical line's first physical line */
+    int line;
+    /* Number of columns the physical lines were written at */
+    int width;
+    /* Offset of the row's first cell in the logical line */
+    int start;
+    /* Number of cells in the row */
+    int len;
+} ul_reflow_span;
+
+/**
+ * Index mapping display rows at the current width to the logical lines of the scrollback.
+ * Physical lines are appended as they scroll off and dropped from the front. Each logical
+ * line occupies ceil(len / cols) display rows; these counts are kept in a Fenwick tree so
+ * that a display row is located in O(log n) and a width change only rebuilds the counts
+ * in O(n) without touching any cells.
+ */
+typedef struct {
+    /* Logical lines, the live ones start at head */
+    ul_reflow_line *lines;
+    /* Fenwick tree over the display row counts of all slots of lines (1-based) */
+    int32_t *tree;
+    /* Number of slots in lines and tree */
+    int capacity;
+    /* Slot of the oldest live logical line */
+    int head;
+    /* Number of live logical lines */
+    int count;
+    /* Current display width */
+    int cols;
+    /* Total number of display rows */
+    int num_rows;
+    /* Sequence number of the oldest physical line */
+    uint32_t oldest_line;
+    /* Number of physical lines */
+    int num_lines;
+    /* True if the last logical line continues with the next physical line */
+    bool is_open;
+} ul_reflow;
+
+/**
+ * Initialise an empty index.
+ *
+ * @param reflow index to initialise
+ * @param cols display width
+ * @return true on success, false otherwise
+ */
+bool ul_reflow_init(ul_reflow *reflow, int cols);
+
+/**
+ * Release an index.
+ *
+ * @param reflow index
+ */
+void ul_reflow_free(ul_reflow *reflow);
+
+/**
+ * Drop all lines.
+ *
+ * @param reflow index
+ */
+void ul_reflow_clear(ul_reflow *reflow);
+
+/**
+ * Append a physical line.
+ *
+ * @param reflow index
+ * @param len number of cells holding content
+ * @param width number of columns the line was written at
+ * @param is_wrapped true if the line continues on the next physical line
+ */
+void ul_reflow_push_line(ul_reflow *reflow, int len, int width, bool is_wrapped);
+
+/**
+ * Drop the oldest physical lines.
+ *
+ * @param reflow index
+ * @param n number of lines
+ */
+void ul_reflow_drop_lines(ul_reflow *reflow, int n);
+
+/**
+ * Drop the newest physical lines, e.g. to append them again at another width.
+ *
+ * @param reflow index
+ * @param n number of lines
+ */
+void ul_reflow_pop_lines(ul_reflow *reflow, int n);
+
+/**
+ * Change the display width.
+ *
+ * @param reflow index
+ * @param cols new display width
+ */
+void ul_reflow_set_cols(ul_reflow *reflow, int cols);
+
+/**
+ * Get the number of display rows at the current width.
+ *
+ * @param reflow index
+ * @return number of rows
+ */
+int ul_reflow_get_row_count(const ul_reflow *reflow);
+
+/**
+ * Locate a display row.
+ *
+ * @param reflow index
+ * @param row display row (0 is the oldest)
+ * @param span pointer for writing the row's part of its logical line into
+ * @return true on success, false if the row is out of range
+ */
+bool ul_reflow_get_span(const ul_reflow *reflow, int row, ul_reflow_span *span);
+
+/**
+ * Get the display row that shows a cell of a physical line.
+ *
+ * @param reflow index
+ * @param line physical line index (0 is the oldest)
+ * @param col column in the physical line
+ * @return display row
+ */
+int ul_reflow_get_row_of(const ul_reflow *reflow, int line, int col);
+
+#endif /* UL_REFLOW_H */
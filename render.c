@@ -0,0 +1,266 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "render.h"
+
+#include "clock.h"
+#include "flush.h"
+
+
+/**
+ * Static variables
+ */
+
+static ul_render_blit_cb_t blit_cb = NULL;
+
+static int drawn_cursor_x = -1;
+static int drawn_cursor_y = -1;
+
+static unsigned long num_frames = 0;
+static unsigned long long repainted_pixels = 0;
+static unsigned long long changed_pixels = 0;
+static uint32_t last_repainted_pixels = 0;
+static uint32_t last_changed_pixels = 0;
+static uint32_t pending_changed_pixels = 0;
+static unsigned long num_blit_scrolls = 0;
+static unsigned long num_blit_rows = 0;
+static unsigned long long blit_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Invalidate a range of cells of a terminal view.
+ *
+ * @param view terminal view
+ * @param y row
+ * @param x0 first column
+ * @param x1 column after the last one
+ */
+static void invalidate_cells(lv_obj_t *view, int y, int x0, int x1);
+
+/**
+ * Check if any pending invalidation of a display overlaps an area.
+ *
+ * @param disp display
+ * @param area area in display coordinates
+ * @return true if part of the area is waiting to be redrawn, false otherwise
+ */
+static bool is_area_pending(const lv_disp_t *disp, const lv_area_t *area);
+
+/**
+ * Invalidate the parts of a scrolled area that an object drawn on top of it covered before
+ * and after the pixels were moved.
+ *
+ * @param view terminal view that was scrolled
+ * @param obj object that may overlap the view
+ * @param area scrolled area in display coordinates
+ * @param dy number of pixel rows the content was moved up by
+ */
+static void invalidate_overlay(lv_obj_t *view, lv_obj_t *obj, const lv_area_t *area, lv_coord_t dy);
+
+/**
+ * Invalidate all objects drawn on top of a terminal view where they overlap a scrolled area.
+ *
+ * @param view terminal view that was scrolled
+ * @param area scrolled area in display coordinates
+ * @param dy number of pixel rows the content was moved up by
+ */
+static void invalidate_overlays(lv_obj_t *view, const lv_area_t *area, lv_coord_t dy);
+
+/**
+ * Move the presented rows of a terminal view up on the display if the screen scrolled since
+ * it was last presented.
+ *
+ * @param view terminal view showing the screen
+ * @param screen screen
+ */
+static void blit_scroll(lv_obj_t *view, ul_screen *screen);
+
+
+/**
+ * Static functions
+ */
+
+static void invalidate_cells(lv_obj_t *view, int y, int x0, int x1) {
+    lv_area_t area;
+    ul_termview_get_cell_area(view, y, x0, x1, &area);
+    lv_obj_invalidate_area(view, &area);
+
+    pending_changed_pixels += (uint32_t)(lv_area_get_size(&area));
+}
+
+static bool is_area_pending(const lv_disp_t *disp, const lv_area_t *area) {
+    for (uint16_t i = 0; i < disp->inv_p; ++i) {
+        if (!disp->inv_area_joined[i] && _lv_area_is_on(&(disp->inv_areas[i]), area)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void invalidate_overlay(lv_obj_t *view, lv_obj_t *obj, const lv_area_t *area, lv_coord_t dy) {
+    if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN)) {
+        return;
+    }
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    const lv_coord_t ext = _lv_obj_get_ext_draw_size(obj);
+    lv_area_increase(&coords, ext, ext);
+
+    /* The object's pixels were moved up along with the text and text was moved under the object */
+    lv_area_t overlap;
+    if (_lv_area_intersect(&overlap, &coords, area)) {
+        lv_obj_invalidate_area(view, &overlap);
+    }
+    lv_area_move(&coords, 0, -dy);
+    if (_lv_area_intersect(&overlap, &coords, area)) {
+        lv_obj_invalidate_area(view, &overlap);
+    }
+}
+
+static void invalidate_overlays(lv_obj_t *view, const lv_area_t *area, lv_coord_t dy) {
+    /* Siblings of the view and its ancestors that come later are drawn on top */
+    lv_obj_t *obj = view;
+    for (lv_obj_t *parent = lv_obj_get_parent(obj); parent; obj = parent, parent = lv_obj_get_parent(parent)) {
+        const uint32_t num_children = lv_obj_get_child_cnt(parent);
+        for (uint32_t i = lv_obj_get_index(obj) + 1; i < num_children; ++i) {
+            invalidate_overlay(view, lv_obj_get_child(parent, i), area, dy);
+        }
+    }
+
+    lv_obj_t *layers[] = { lv_layer_top(), lv_layer_sys() };
+    for (size_t i = 0; i < sizeof(layers) / sizeof(layers[0]); ++i) {
+        const uint32_t num_children = lv_obj_get_child_cnt(layers[i]);
+        for (uint32_t j = 0; j < num_children; ++j) {
+            invalidate_overlay(view, lv_obj_get_child(layers[i], j), area, dy);
+        }
+    }
+}
+
+static void blit_scroll(lv_obj_t *view, ul_screen *screen) {
+    const int n = ul_screen_get_scroll(screen);
+    if (!blit_cb || n == 0) {
+        return;
+    }
+
+    /* Rotated displays don't store rows contiguously */
+    lv_disp_t *disp = lv_obj_get_disp(view);
+    if (disp->driver->rotated != LV_DISP_ROT_NONE) {
+        return;
+    }
+
+    lv_area_t top;
+    lv_area_t bottom;
+    ul_termview_get_cell_area(view, 0, 0, screen->cols, &top);
+    ul_termview_get_cell_area(view, screen->rows - 1, 0, screen->cols, &bottom);
+    lv_area_t area = { .x1 = top.x1, .y1 = top.y1, .x2 = bottom.x2, .y2 = bottom.y2 };
+    const lv_coord_t dy = (lv_coord_t)(n * lv_area_get_height(&top));
+
+    /* The display must show exactly what was presented, redraws that are still pending
+     * would render the new content and be moved once more */
+    if (!lv_obj_area_is_visible(view, &area) || lv_area_get_height(&area) <= dy || is_area_pending(disp, &area)) {
+        return;
+    }
+
+    /* Pixels still on their way to the display would land on the moved rows */
+    ul_flush_wait_idle();
+
+    const int64_t start_us = ul_clock_get_us();
+    const bool is_moved = blit_cb(&area, dy);
+    blit_us += (unsigned long long)(ul_clock_get_us() - start_us);
+    if (!is_moved) {
+        return;
+    }
+
+    lv_area_t exposed = area;
+    exposed.y1 = area.y2 - dy + 1;
+    lv_obj_invalidate_area(view, &exposed);
+    invalidate_overlays(view, &area, dy);
+
+    ul_screen_scroll_drawn(screen, n);
+    if (drawn_cursor_y >= 0) {
+        drawn_cursor_y = drawn_cursor_y >= n ? drawn_cursor_y - n : -1;
+    }
+
+    ++num_blit_scrolls;
+    num_blit_rows += (unsigned long)(screen->rows - n);
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_render_set_blit_cb(ul_render_blit_cb_t cb) {
+    blit_cb = cb;
+}
+
+void ul_render_invalidate_damage(lv_obj_t *view, ul_screen *screen) {
+    blit_scroll(view, screen);
+
+    for (int y = 0; y < screen->rows; ++y) {
+        ul_screen_span span;
+        if (ul_screen_get_damage(screen, y, &span)) {
+            invalidate_cells(view, y, span.x0, span.x1);
+        }
+    }
+
+    /* The cursor is drawn on top of the text, both its old and its new cell change when it moves */
+    const int cursor_x = ul_screen_is_cursor_visible(screen) ? screen->cursor_x : -1;
+    const int cursor_y = ul_screen_is_cursor_visible(screen) ? screen->cursor_y : -1;
+    if (cursor_x != drawn_cursor_x || cursor_y != drawn_cursor_y) {
+        if (drawn_cursor_y >= 0 && drawn_cursor_y < screen->rows) {
+            invalidate_cells(view, drawn_cursor_y, drawn_cursor_x, drawn_cursor_x + 1);
+        }
+        if (cursor_y >= 0) {
+            invalidate_cells(view, cursor_y, cursor_x, cursor_x + 1);
+        }
+        drawn_cursor_x = cursor_x;
+        drawn_cursor_y = cursor_y;
+    }
+}
+
+void ul_render_monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px) {
+    LV_UNUSED(disp_drv);
+    LV_UNUSED(time);
+
+    ++num_frames;
+    repainted_pixels += px;
+    changed_pixels += pending_changed_pixels;
+    last_repainted_pixels = px;
+    last_changed_pixels = pending_changed_pixels;
+    pending_changed_pixels = 0;
+    ul_termview_end_refresh();
+}
+
+void ul_render_get_stats(ul_render_stats *stats) {
+    stats->frames = num_frames;
+    stats->repainted_pixels = repainted_pixels;
+    stats->changed_pixels = changed_pixels;
+    stats->last_repainted_pixels = last_repainted_pixels;
+    stats->last_changed_pixels = last_changed_pixels;
+    stats->blit_scrolls = num_blit_scrolls;
+    stats->blit_rows = num_blit_rows;
+    stats->blit_us = blit_us;
+}
@@ -0,0 +1,97 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_RENDER_H
+#define UL_RENDER_H
+
+#include "screen.h"
+#include "termview.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdint.h>
+
+/**
+ * Rendering statistics
+ */
+typedef struct {
+    /* Number of display refreshes that drew anything */
+    unsigned long frames;
+    /* Pixels redrawn by LVGL over all frames */
+    unsigned long long repainted_pixels;
+    /* Pixels of terminal cells that changed in the screen model over all frames */
+    unsigned long long changed_pixels;
+    /* Pixels redrawn in the last frame */
+    uint32_t last_repainted_pixels;
+    /* Pixels of changed cells in the last frame */
+    uint32_t last_changed_pixels;
+    /* Number of scrolls handled by moving pixels on the display */
+    unsigned long blit_scrolls;
+    /* Number of terminal rows moved instead of redrawn */
+    unsigned long blit_rows;
+    /* Time spent moving pixels for scrolls (in microseconds) */
+    unsigned long long blit_us;
+} ul_render_stats;
+
+/**
+ * Callback for moving the pixels of a display area up in place
+ *
+ * @param area area to scroll in display coordinates
+ * @param dy number of pixel rows to move the content by
+ * @return true if the pixels were moved, false if the area has to be redrawn
+ */
+typedef bool (*ul_render_blit_cb_t)(const lv_area_t *area, lv_coord_t dy);
+
+/**
+ * Set the callback used to scroll the terminal view on the display instead of redrawing it.
+ *
+ * @param cb callback or NULL to always redraw
+ */
+void ul_render_set_blit_cb(ul_render_blit_cb_t cb);
+
+/**
+ * Invalidate only the parts of a terminal view that show the changed cells of a screen's
+ * view and the old and new cursor cells. Call this before presenting the screen. If the
+ * screen scrolled and a blit callback is set, the presented pixels are moved first so that
+ * only the rows that scrolled in are redrawn.
+ *
+ * @param view terminal view showing the screen
+ * @param screen screen
+ */
+void ul_render_invalidate_damage(lv_obj_t *view, ul_screen *screen);
+
+/**
+ * Display driver monitor callback that counts the pixels LVGL redraws per refresh and ends
+ * the terminal view's timing of the refresh.
+ *
+ * @param disp_drv display driver
+ * @param time duration of the refresh in milliseconds
+ * @param px number of pixels redrawn
+ */
+void ul_render_monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
+
+/**
+ * Get rendering statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_render_get_stats(ul_render_stats *stats);
+
+#endif /* UL_RENDER_H */
@@ -0,0 +1,52 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_ROW_H
+#define UL_ROW_H
+
+#include "attr.h"
+
+#include <stdint.h>
+
+/**
+ * Row flags
+ */
+typedef enum {
+    /* The logical line continues on the next row (automatic wrap) */
+    UL_ROW_FLAG_WRAPPED = 1 << 0
+} ul_row_flag;
+
+/**
+ * A single row of cells
+ */
+typedef struct {
+    /* Cells, one per column */
+    ul_cell *cells;
+    /* Number of leading cells that hold content, trailing cells are blank */
+    uint16_t len;
+    /* Number of allocated cells, rows are never narrowed so that no content is lost on resize */
+    uint16_t size;
+    /* Combination of ul_row_flag values */
+    uint8_t flags;
+    /* Sum of the hashes of all cells, kept up to date for the rows of the live screen */
+    uint32_t hash;
+} ul_row;
+
+#endif /* UL_ROW_H */
@@ -0,0 +1,1748 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "screen.h"
+
+#include "clock.h"
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CLAMP(v, lo, hi) MIN(MAX(v, lo), hi)
+
+
+/**
+ * Static variables
+ */
+
+static unsigned long num_damaged_rows = 0;
+static unsigned long num_unchanged_rows = 0;
+
+/* How the primary screen's rows are re-wrapped on resize */
+typedef struct {
+    /* Number of visible rows appended to the line index for planning */
+    int num_pushed;
+    /* Index of the first line to rebuild, it starts a logical line */
+    int first_line;
+    /* Display row of first_line at the new width */
+    int first_row;
+    /* Display row shown at the top of the resized screen */
+    int top_row;
+    /* Number of rows to build from first_row on, including blank rows below the last display row */
+    int num_rows;
+    /* Cursor column on the resized screen */
+    int cursor_x;
+    /* Cursor row on the resized screen */
+    int cursor_y;
+} rewrap_plan;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Map a logical ring position to an index into the ring's row array.
+ *
+ * @param ring row ring
+ * @param i logical position (0 is the oldest row)
+ * @return array index
+ */
+static int ring_index(const ul_row_ring *ring, int i);
+
+/**
+ * Hash a cell together with its column and rendition.
+ *
+ * @param cell cell
+ * @param x column of the cell
+ * @return hash value
+ */
+static uint32_t hash_cell(const ul_cell *cell, int x);
+
+/**
+ * Sum the hashes of a range of cells of a row. As the sum doesn't depend on the order,
+ * a row's hash is updated for a changed range by subtracting the range's old sum and
+ * adding its new one.
+ *
+ * @param row row
+ * @param x0 first column
+ * @param x1 column after the last one
+ * @return sum of the cell hashes
+ */
+static uint32_t hash_cells(const ul_row *row, int x0, int x1);
+
+/**
+ * Recompute the hashes of the visible rows of a ring.
+ *
+ * @param screen screen
+ * @param ring row ring
+ */
+static void rehash_rows(const ul_screen *screen, ul_row_ring *ring);
+
+/**
+ * Allocate a row of blank cells.
+ *
+ * @param cols number of cells
+ * @return the new row or NULL on failure
+ */
+static ul_row *create_row(int cols);
+
+/**
+ * Release a row and the attribute references held by its cells.
+ *
+ * @param row row to destroy
+ */
+static void destroy_row(ul_row *row);
+
+/**
+ * Allocate a row ring and fill it with blank rows.
+ *
+ * @param ring row ring to initialise
+ * @param capacity maximum number of rows
+ * @param num_rows number of rows to allocate upfront
+ * @param cols number of cells per row
+ * @return true on success, false otherwise
+ */
+static bool init_ring(ul_row_ring *ring, int capacity, int num_rows, int cols);
+
+/**
+ * Release a row ring and all of its rows.
+ *
+ * @param ring row ring
+ */
+static void free_ring(ul_row_ring *ring);
+
+/**
+ * Allocate the scratch rows for re-wrapped scrollback lines.
+ *
+ * @param screen screen
+ * @param cols number of cells per row
+ * @param rows number of rows
+ * @return true on success, false otherwise
+ */
+static bool alloc_view_rows(ul_screen *screen, int cols, int rows);
+
+/**
+ * Release the attribute references held by a range of cells.
+ *
+ * @param cells first cell
+ * @param n number of cells
+ */
+static void release_cells(ul_cell *cells, int n);
+
+/**
+ * Fill a range of cells with blanks in the screen's erase rendition. The cells must not
+ * hold any attribute references.
+ *
+ * @param screen screen
+ * @param cells first cell
+ * @param n number of cells
+ */
+static void fill_blank(const ul_screen *screen, ul_cell *cells, int n);
+
+/**
+ * Erase a column range of a visible row.
+ *
+ * @param screen screen
+ * @param y row index
+ * @param x0 first column
+ * @param x1 column after the last one
+ */
+static void erase_range(ul_screen *screen, int y, int x0, int x1);
+
+/**
+ * Blank a whole row, releasing its old content.
+ *
+ * @param screen screen
+ * @param row row to blank
+ */
+static void clear_row(ul_screen *screen, ul_row *row);
+
+/**
+ * Hand a row that drops out of the primary ring over to the history, or drop it if there
+ * is none, and keep the line index in step.
+ *
+ * @param screen screen
+ * @param row row to retire, left blank but not released
+ */
+static void retire_row(ul_screen *screen, ul_row *row);
+
+/**
+ * Scroll the whole screen up by one row, moving the top row into the scrollback.
+ *
+ * @param screen screen
+ */
+static void scroll_into_history(ul_screen *screen);
+
+/**
+ * Get the number of physical lines held in scrollback.
+ *
+ * @param screen screen
+ * @return number of lines
+ */
+static int get_scrollback_lines(const ul_screen *screen);
+
+/**
+ * Get a scrollback row at the current width, re-wrapping its logical line if it was
+ * written at another width.
+ *
+ * @param screen screen
+ * @param index display row (0 is the oldest)
+ * @param scratch row to assemble re-wrapped cells in
+ * @return the row
+ */
+static const ul_row *get_scrollback_row(const ul_screen *screen, int index, ul_row *scratch);
+
+/**
+ * Get the display row that shows a cell of a line.
+ *
+ * @param screen screen
+ * @param index line index (0 is the oldest scrollback line)
+ * @param col column in the line
+ * @return display row (0 is the oldest scrollback row)
+ */
+static int get_display_row(const ul_screen *screen, int index, int col);
+
+/**
+ * Widen all rows of a ring. Rows are never narrowed so that scrollback lines keep their content.
+ *
+ * @param ring row ring
+ * @param cols new minimum number of cells per row
+ * @return true on success, false if memory is short
+ */
+static bool widen_ring(ul_row_ring *ring, int cols);
+
+/**
+ * Cut the visible rows of a ring down to a width. Used for the alternate screen, whose
+ * programs redraw it at the new size, and for rows that can't be re-wrapped.
+ *
+ * @param screen screen
+ * @param ring row ring
+ * @param cols new number of columns
+ */
+static void truncate_rows(ul_screen *screen, ul_row_ring *ring, int cols);
+
+/**
+ * Give a ring a new number of visible rows. Rows below the cursor are dropped first when
+ * shrinking, then rows move off the top. Growing adds blank rows at the bottom.
+ *
+ * @param screen screen, with cols already set to the new width
+ * @param ring row ring
+ * @param rows new number of visible rows
+ * @param capacity new capacity of the ring
+ * @param slots array for the new ring of at least MAX(capacity, ring->count + added rows) entries
+ * @param fresh blank rows to add if the ring grows
+ * @param cursor_y pointer to the cursor row to keep on screen
+ * @param is_primary true if rows moving off the top enter the scrollback
+ */
+static void reshape_ring(ul_screen *screen, ul_row_ring *ring, int rows, int capacity, ul_row **slots,
+    ul_row **fresh, int *cursor_y, bool is_primary);
+
+/**
+ * Make an array of rows the content of a ring, dropping the oldest rows beyond its capacity.
+ *
+ * @param screen screen
+ * @param ring row ring, its old row array is released
+ * @param slots rows oldest first, the array is taken over by the ring
+ * @param count number of rows in slots
+ * @param capacity new capacity of the ring
+ * @param is_primary true if dropped rows enter the history
+ */
+static void install_slots(ul_screen *screen, ul_row_ring *ring, ul_row **slots, int count, int capacity, bool is_primary);
+
+/**
+ * Plan re-wrapping the visible rows of the primary screen at a new size. The rows are
+ * appended to the line index, which is switched to the new width. A screen filled to the
+ * bottom stays aligned to it, so that lines are pulled back from the scrollback when it
+ * grows and pushed into it when it shrinks, otherwise the top row stays in place. The
+ * cursor is kept on screen either way.
+ *
+ * @param screen screen, still at the old size
+ * @param ring primary row ring
+ * @param cols new number of columns
+ * @param rows new number of visible rows
+ * @param cursor_x cursor column on the primary screen
+ * @param cursor_y cursor row on the primary screen
+ * @param plan pointer for writing the plan into
+ * @return true on success, false if the cursor's logical line starts in the compressed
+ * history and the index was left unchanged
+ */
+static bool plan_rewrap(ul_screen *screen, const ul_row_ring *ring, int cols, int rows, int cursor_x, int cursor_y,
+    rewrap_plan *plan);
+
+/**
+ * Revert the changes made to the line index while planning.
+ *
+ * @param screen screen, still at the old size
+ * @param plan plan
+ */
+static void undo_rewrap(ul_screen *screen, const rewrap_plan *plan);
+
+/**
+ * Copy a display row of the line index into a new row, taking references on its cells.
+ *
+ * @param screen screen
+ * @param ring primary row ring holding the row's lines
+ * @param index display row at the new width
+ * @param row blank row of the new width
+ */
+static void rewrap_row(const ul_screen *screen, const ul_row_ring *ring, int index, ul_row *row);
+
+/**
+ * Replace the rebuilt lines of the primary ring with rows of the new width. Rows above the
+ * new top row return to the scrollback, the others become the visible rows.
+ *
+ * @param screen screen, with cols already set to the new width
+ * @param ring primary row ring
+ * @param plan plan
+ * @param capacity new capacity of the ring
+ * @param slots array for the new ring of at least MAX(capacity, rows kept + plan->num_rows) entries
+ * @param built plan->num_rows blank rows of the new width
+ * @param cursor_x pointer to the cursor column to update
+ * @param cursor_y pointer to the cursor row to update
+ */
+static void rewrap_ring(ul_screen *screen, ul_row_ring *ring, const rewrap_plan *plan, int capacity, ul_row **slots,
+    ul_row **built, int *cursor_x, int *cursor_y);
+
+/**
+ * Reverse the order of a range of visible row pointers.
+ *
+ * @param screen screen
+ * @param first first row of the range
+ * @param last last row of the range (inclusive)
+ */
+static void reverse_rows(ul_screen *screen, int first, int last);
+
+/**
+ * Rotate the row pointers of a range of visible rows and blank the rows that wrap around.
+ * No cell data is moved.
+ *
+ * @param screen screen
+ * @param top first row of the range
+ * @param bottom last row of the range (inclusive)
+ * @param n number of lines to scroll, positive values move content up, negative ones down
+ */
+static void rotate_rows(ul_screen *screen, int top, int bottom, int n);
+
+/**
+ * Check whether the scroll region spans the whole screen.
+ *
+ * @param screen screen
+ * @return true if the region covers all rows, false otherwise
+ */
+static bool is_full_region(const ul_screen *screen);
+
+/**
+ * Drop all scrollback lines.
+ *
+ * @param screen screen
+ */
+static void clear_scrollback(ul_screen *screen);
+
+/**
+ * Allocate the damage bitmap and spans for a number of rows, marking all rows as damaged.
+ *
+ * @param screen screen
+ * @param rows number of rows
+ * @return true on success, false otherwise
+ */
+static bool alloc_damage(ul_screen *screen, int rows);
+
+/**
+ * Record a change to a column range of a visible row. The range is mapped into the view,
+ * changes to rows that are scrolled out of view are ignored.
+ *
+ * @param screen screen
+ * @param y row index
+ * @param x0 first column
+ * @param x1 column after the last one
+ */
+static void damage(ul_screen *screen, int y, int x0, int x1);
+
+/**
+ * Mark all rows of the view as changed.
+ *
+ * @param screen screen
+ */
+static void mark_view_dirty(ul_screen *screen);
+
+/**
+ * Check whether a view row shows the same content as when the screen was last presented.
+ *
+ * @param screen screen
+ * @param y row index in the view
+ * @return true if the row's hash is unchanged, false if it changed or can't be compared
+ */
+static bool is_row_unchanged(const ul_screen *screen, int y);
+
+/**
+ * Encode a code point as UTF-8.
+ *
+ * @param codepoint code point to encode
+ * @param out buffer of at least 4 bytes
+ * @return number of bytes written
+ */
+static int encode_utf8(uint32_t codepoint, char *out);
+
+
+/**
+ * Static functions
+ */
+
+static int ring_index(const ul_row_ring *ring, int i) {
+    return (ring->head + i) % ring->capacity;
+}
+
+static uint32_t hash_cell(const ul_cell *cell, int x) {
+    const ul_attr *attr = ul_attr_get(cell->attr);
+
+    uint32_t h = cell->codepoint;
+    h = h * 0x9e3779b1u + (uint32_t)x;
+    h = h * 0x85ebca6bu + attr->fg;
+    h = h * 0xc2b2ae35u + attr->bg;
+    h = h * 0x27d4eb2fu + ((uint32_t)attr->flags << 8 | cell->width);
+
+    /* Finalise so that neighbouring inputs spread over all bits before they are summed */
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+
+    return h;
+}
+
+static uint32_t hash_cells(const ul_row *row, int x0, int x1) {
+    uint32_t sum = 0;
+    for (int x = x0; x < x1; ++x) {
+        sum += hash_cell(&(row->cells[x]), x);
+    }
+    return sum;
+}
+
+static void rehash_rows(const ul_screen *screen, ul_row_ring *ring) {
+    for (int i = MAX(ring->count - screen->rows, 0); i < ring->count; ++i) {
+        ul_row *row = ring->rows[ring_index(ring, i)];
+        row->hash = hash_cells(row, 0, row->size);
+    }
+}
+
+static ul_row *create_row(int cols) {
+    ul_row *row = malloc(sizeof(ul_row));
+    if (!row) {
+        return NULL;
+    }
+
+    row->cells = malloc(cols * sizeof(ul_cell));
+    if (!row->cells) {
+        free(row);
+        return NULL;
+    }
+
+    for (int i = 0; i < cols; ++i) {
+        row->cells[i] = (ul_cell){ .codepoint = 0, .attr = UL_ATTR_DEFAULT_ID, .width = 1, .reserved = 0 };
+    }
+    row->len = 0;
+    row->size = (uint16_t)cols;
+    row->flags = 0;
+    row->hash = hash_cells(row, 0, cols);
+
+    return row;
+}
+
+static void destroy_row(ul_row *row) {
+    release_cells(row->cells, row->size);
+    free(row->cells);
+    free(row);
+}
+
+static bool init_ring(ul_row_ring *ring, int capacity, int num_rows, int cols) {
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = 0;
+    ring->rows = calloc(capacity, sizeof(ul_row *));
+    if (!ring->rows) {
+        return false;
+    }
+
+    for (int i = 0; i < num_rows; ++i) {
+        ring->rows[i] = create_row(cols);
+        if (!ring->rows[i]) {
+            free_ring(ring);
+            return false;
+        }
+        ++ring->count;
+    }
+
+    return true;
+}
+
+static void free_ring(ul_row_ring *ring) {
+    for (int i = 0; i < ring->count; ++i) {
+        destroy_row(ring->rows[ring_index(ring, i)]);
+    }
+
+    free(ring->rows);
+    ring->rows = NULL;
+    ring->capacity = 0;
+    ring->head = 0;
+    ring->count = 0;
+}
+
+static bool alloc_view_rows(ul_screen *screen, int cols, int rows) {
+    ul_row *view_rows = calloc(rows, sizeof(ul_row));
+    ul_cell *cells = calloc((size_t)rows * cols, sizeof(ul_cell));
+    if (!view_rows || !cells) {
+        free(view_rows);
+        free(cells);
+        return false;
+    }
+
+    for (int y = 0; y < rows; ++y) {
+        view_rows[y].cells = cells + y * cols;
+        view_rows[y].size = (uint16_t)cols;
+    }
+
+    if (screen->view_rows) {
+        free(screen->view_rows[0].cells);
+        free(screen->view_rows);
+    }
+    screen->view_rows = view_rows;
+
+    return true;
+}
+
+static void release_cells(ul_cell *cells, int n) {
+    for (int i = 0; i < n; ++i) {
+        ul_attr_unref(cells[i].attr);
+    }
+}
+
+static void fill_blank(const ul_screen *screen, ul_cell *cells, int n) {
+    for (int i = 0; i < n; ++i) {
+        cells[i] = (ul_cell){ .codepoint = 0, .attr = screen->erase_id, .width = 1, .reserved = 0 };
+        ul_attr_ref(screen->erase_id);
+    }
+}
+
+static void erase_range(ul_screen *screen, int y, int x0, int x1) {
+    ul_row *row = ul_screen_get_row(screen, y);
+    x0 = CLAMP(x0, 0, screen->cols);
+    x1 = CLAMP(x1, x0, screen->cols);
+    if (x0 == x1) {
+        return;
+    }
+
+    row->hash -= hash_cells(row, x0, x1);
+    release_cells(row->cells + x0, x1 - x0);
+    fill_blank(screen, row->cells + x0, x1 - x0);
+    row->hash += hash_cells(row, x0, x1);
+
+    if (screen->erase_id != UL_ATTR_DEFAULT_ID) {
+        if (row->len < x1) {
+            row->len = (uint16_t)x1;
+        }
+    } else if (row->len <= x1 && row->len > x0) {
+        row->len = (uint16_t)x0;
+    }
+
+    damage(screen, y, x0, x1);
+}
+
+static void clear_row(ul_screen *screen, ul_row *row) {
+    release_cells(row->cells, row->size);
+    fill_blank(screen, row->cells, row->size);
+    row->len = screen->erase_id != UL_ATTR_DEFAULT_ID ? (uint16_t)screen->cols : 0;
+    row->flags = 0;
+    row->hash = hash_cells(row, 0, row->size);
+}
+
+static void retire_row(ul_screen *screen, ul_row *row) {
+    if (!screen->history) {
+        ul_reflow_drop_lines(&(screen->reflow), 1);
+        return;
+    }
+
+    /* The history may drop whole blocks of its oldest lines to make room */
+    int num_lines = ul_history_get_count(screen->history);
+    ul_history_push_row(screen->history, row);
+    ul_reflow_drop_lines(&(screen->reflow), num_lines + 1 - ul_history_get_count(screen->history));
+}
+
+static void scroll_into_history(ul_screen *screen) {
+    ul_row_ring *ring = &(screen->ring);
+    ul_row *row = NULL;
+    int num_rows = ul_screen_get_scrollback_count(screen);
+
+    /* The top row moves into the scrollback, its line is indexed before it can be recycled */
+    if (!screen->is_alternate) {
+        const ul_row *top = ul_screen_get_row(screen, 0);
+        ul_reflow_push_line(&(screen->reflow), top->len, screen->cols, top->flags & UL_ROW_FLAG_WRAPPED);
+    }
+
+    if (ring->count < ring->capacity) {
+        row = create_row(screen->cols);
+    }
+
+    if (row) {
+        ring->rows[ring_index(ring, ring->count)] = row;
+        ++ring->count;
+    } else {
+        /* Ring is full (or memory is short): recycle the oldest line as the new bottom row,
+         * handing its content over to the compressed history first */
+        row = ring->rows[ring->head];
+        ring->head = ring_index(ring, 1);
+        if (!screen->is_alternate) {
+            retire_row(screen, row);
+        }
+    }
+
+    clear_row(screen, row);
+
+    /* Keep a scrolled-back view anchored to the same content */
+    if (screen->view_offset > 0) {
+        int new_rows = ul_screen_get_scrollback_count(screen);
+        screen->view_offset = CLAMP(screen->view_offset + new_rows - num_rows, 0, new_rows);
+    }
+
+    mark_view_dirty(screen);
+}
+
+static int get_scrollback_lines(const ul_screen *screen) {
+    int count = screen->ring.count - screen->rows;
+    if (screen->history && !screen->is_alternate) {
+        count += ul_history_get_count(screen->history);
+    }
+    return count;
+}
+
+static const ul_row *get_scrollback_row(const ul_screen *screen, int index, ul_row *scratch) {
+    ul_reflow_span span;
+    if (!ul_reflow_get_span(&(screen->reflow), index, &span)) {
+        span = (ul_reflow_span){ .line = 0, .width = screen->cols, .start = 0, .len = 0 };
+    }
+
+    /* Lines written at the current width are shown as they are */
+    if (span.width == screen->cols) {
+        return ul_screen_get_line(screen, span.line + span.start / span.width);
+    }
+
+    /* Otherwise assemble the slice of the logical line, it may span two physical lines */
+    const ul_row *row = NULL;
+    int row_line = -1;
+    scratch->len = 0;
+    for (int x = 0; x < screen->cols; ++x) {
+        ul_cell cell = { .codepoint = 0, .attr = UL_ATTR_DEFAULT_ID, .width = 1, .reserved = 0 };
+        if (x < span.len) {
+            int offset = span.start + x;
+            int col = offset % span.width;
+            if (span.line + offset / span.width != row_line) {
+                row_line = span.line + offset / span.width;
+                row = ul_screen_get_line(screen, row_line);
+            }
+            if (col < row->len) {
+                cell = row->cells[col];
+                scratch->len = (uint16_t)(x + 1);
+            }
+        }
+        scratch->cells[x] = cell;
+    }
+
+    return scratch;
+}
+
+static int get_display_row(const ul_screen *screen, int index, int col) {
+    int num_lines = get_scrollback_lines(screen);
+    if (index >= num_lines) {
+        return ul_screen_get_scrollback_count(screen) + index - num_lines;
+    }
+    return ul_reflow_get_row_of(&(screen->reflow), index, col);
+}
+
+static bool widen_ring(ul_row_ring *ring, int cols) {
+    for (int i = 0; i < ring->count; ++i) {
+        ul_row *row = ring->rows[ring_index(ring, i)];
+        if (row->size >= cols) {
+            continue;
+        }
+
+        ul_cell *cells = realloc(row->cells, cols * sizeof(ul_cell));
+        if (!cells) {
+            return false;
+        }
+        for (int x = row->size; x < cols; ++x) {
+            cells[x] = (ul_cell){ .codepoint = 0, .attr = UL_ATTR_DEFAULT_ID, .width = 1, .reserved = 0 };
+        }
+        row->cells = cells;
+        row->size = (uint16_t)cols;
+    }
+
+    return true;
+}
+
+static void truncate_rows(ul_screen *screen, ul_row_ring *ring, int cols) {
+    for (int i = ring->count - screen->rows; i < ring->count; ++i) {
+        ul_row *row = ring->rows[ring_index(ring, i)];
+        if (row->len > cols) {
+            release_cells(row->cells + cols, row->len - cols);
+            for (int x = cols; x < row->len; ++x) {
+                row->cells[x] = (ul_cell){ .codepoint = 0, .attr = UL_ATTR_DEFAULT_ID, .width = 1, .reserved = 0 };
+            }
+            row->len = (uint16_t)cols;
+        }
+    }
+}
+
+static void reshape_ring(ul_screen *screen, ul_row_ring *ring, int rows, int capacity, ul_row **slots,
+        ul_row **fresh, int *cursor_y, bool is_primary) {
+    int old_rows = screen->rows;
+    int count = 0;
+
+    for (int i = 0; i < ring->count; ++i) {
+        slots[count++] = ring->rows[ring_index(ring, i)];
+    }
+    for (int i = 0; i < rows - old_rows; ++i) {
+        slots[count++] = fresh[i];
+    }
+
+    if (rows < old_rows) {
+        /* Blank space below the cursor goes first, then the top rows scroll off */
+        int below = MIN(old_rows - rows, old_rows - 1 - *cursor_y);
+        for (int i = 0; i < below; ++i) {
+            destroy_row(slots[--count]);
+        }
+        int above = old_rows - rows - below;
+        *cursor_y -= above;
+
+        for (int i = count - rows - above; is_primary && i < count - rows; ++i) {
+            ul_reflow_push_line(&(screen->reflow), slots[i]->len, screen->cols, slots[i]->flags & UL_ROW_FLAG_WRAPPED);
+        }
+    }
+
+    install_slots(screen, ring, slots, count, capacity, is_primary);
+}
+
+static void install_slots(ul_screen *screen, ul_row_ring *ring, ul_row **slots, int count, int capacity, bool is_primary) {
+    int first = 0;
+    while (count - first > capacity) {
+        ul_row *row = slots[first++];
+        if (is_primary) {
+            retire_row(screen, row);
+        }
+        destroy_row(row);
+    }
+
+    memmove(slots, slots + first, (count - first) * sizeof(ul_row *));
+    free(ring->rows);
+    ring->rows = slots;
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = count - first;
+}
+
+static bool plan_rewrap(ul_screen *screen, const ul_row_ring *ring, int cols, int rows, int cursor_x, int cursor_y,
+        rewrap_plan *plan) {
+    ul_reflow *reflow = &(screen->reflow);
+    int old_rows = screen->rows;
+    int num_cold = screen->history ? ul_history_get_count(screen->history) : 0;
+    int base = num_cold + ring->count - old_rows;
+
+    /* Blank rows below the cursor are left out, all others become lines of the index */
+    int last = old_rows - 1;
+    while (last > cursor_y && ring->rows[ring_index(ring, ring->count - old_rows + last)]->len == 0) {
+        --last;
+    }
+    for (int y = 0; y <= last; ++y) {
+        const ul_row *row = ring->rows[ring_index(ring, ring->count - old_rows + y)];
+        ul_reflow_push_line(reflow, row->len, screen->cols, row->flags & UL_ROW_FLAG_WRAPPED);
+    }
+    plan->num_pushed = last + 1;
+    ul_reflow_set_cols(reflow, cols);
+
+    int num_rows = ul_reflow_get_row_count(reflow);
+    int cursor_row = ul_reflow_get_row_of(reflow, base + cursor_y, cursor_x);
+    int top = last == old_rows - 1 ? num_rows - rows : ul_reflow_get_row_of(reflow, base, 0);
+    top = MAX(CLAMP(top, cursor_row - rows + 1, cursor_row), 0);
+
+    /* Rebuild from the start of the top row's logical line. Lines that start in the
+     * compressed history can't be taken back from it and are skipped. */
+    ul_reflow_span span;
+    ul_reflow_get_span(reflow, top, &span);
+    int first = top - span.start / cols;
+    while (span.line < num_cold) {
+        do {
+            ++first;
+        } while (first <= cursor_row && ul_reflow_get_span(reflow, first, &span) && span.start > 0);
+
+        if (first > cursor_row) {
+            undo_rewrap(screen, plan);
+            return false;
+        }
+    }
+
+    plan->first_line = span.line;
+    plan->first_row = first;
+    plan->top_row = MAX(top, first);
+    plan->num_rows = plan->top_row + rows - first;
+
+    ul_reflow_get_span(reflow, cursor_row, &span);
+    int offset = (base + cursor_y - span.line) * span.width + cursor_x;
+    plan->cursor_x = CLAMP(offset - span.start, 0, cols - 1);
+    plan->cursor_y = cursor_row - plan->top_row;
+
+    return true;
+}
+
+static void undo_rewrap(ul_screen *screen, const rewrap_plan *plan) {
+    ul_reflow_pop_lines(&(screen->reflow), plan->num_pushed);
+    ul_reflow_set_cols(&(screen->reflow), screen->cols);
+}
+
+static void rewrap_row(const ul_screen *screen, const ul_row_ring *ring, int index, ul_row *row) {
+    const ul_reflow *reflow = &(screen->reflow);
+    int num_cold = screen->history ? ul_history_get_count(screen->history) : 0;
+    ul_reflow_span span;
+    ul_reflow_get_span(reflow, index, &span);
+
+    for (int x = 0; x < span.len; ++x) {
+        int offset = span.start + x;
+        int col = offset % span.width;
+        const ul_row *src = ring->rows[ring_index(ring, span.line + offset / span.width - num_cold)];
+        if (col < src->len) {
+            ul_attr_ref(src->cells[col].attr);
+            row->cells[x] = src->cells[col];
+            row->len = (uint16_t)(x + 1);
+        }
+    }
+
+    /* The row wraps if the next display row continues its logical line */
+    ul_reflow_span next;
+    bool is_wrapped = ul_reflow_get_span(reflow, index + 1, &next) ? next.line == span.line : reflow->is_open;
+    row->flags = is_wrapped ? UL_ROW_FLAG_WRAPPED : 0;
+    row->hash = hash_cells(row, 0, row->size);
+}
+
+static void rewrap_ring(ul_screen *screen, ul_row_ring *ring, const rewrap_plan *plan, int capacity, ul_row **slots,
+        ul_row **built, int *cursor_x, int *cursor_y) {
+    int num_cold = screen->history ? ul_history_get_count(screen->history) : 0;
+    int num_rows = ul_reflow_get_row_count(&(screen->reflow));
+
+    /* Copy the cells while the old lines are still indexed, rows past the last display row stay blank */
+    for (int i = 0; i < plan->num_rows && plan->first_row + i < num_rows; ++i) {
+        rewrap_row(screen, ring, plan->first_row + i, built[i]);
+    }
+
+    /* Swap the old lines for the rebuilt ones above the screen */
+    ul_reflow_pop_lines(&(screen->reflow), screen->reflow.num_lines - plan->first_line);
+    for (int i = 0; i < plan->top_row - plan->first_row; ++i) {
+        ul_reflow_push_line(&(screen->reflow), built[i]->len, screen->cols, built[i]->flags & UL_ROW_FLAG_WRAPPED);
+    }
+
+    int count = 0;
+    for (int i = 0; i < ring->count; ++i) {
+        ul_row *row = ring->rows[ring_index(ring, i)];
+        if (i < plan->first_line - num_cold) {
+            slots[count++] = row;
+        } else {
+            destroy_row(row);
+        }
+    }
+    for (int i = 0; i < plan->num_rows; ++i) {
+        slots[count++] = built[i];
+    }
+
+    install_slots(screen, ring, slots, count, capacity, true);
+    *cursor_x = plan->cursor_x;
+    *cursor_y = plan->cursor_y;
+}
+
+static void reverse_rows(ul_screen *screen, int first, int last) {
+    ul_row_ring *ring = &(screen->ring);
+    int base = ring->count - screen->rows;
+
+    while (first < last) {
+        int a = ring_index(ring, base + first++);
+        int b = ring_index(ring, base + last--);
+        ul_row *row = ring->rows[a];
+        ring->rows[a] = ring->rows[b];
+        ring->rows[b] = row;
+    }
+}
+
+static void rotate_rows(ul_screen *screen, int top, int bottom, int n) {
+    int height = bottom - top + 1;
+    if (n == 0 || height < 1) {
+        return;
+    }
+
+    int count = CLAMP(n < 0 ? -n : n, 1, height);
+    int shift = n > 0 ? count : height - count;
+
+    /* Left rotation by `shift` rows using three reversals */
+    if (shift > 0 && shift < height) {
+        reverse_rows(screen, top, top + shift - 1);
+        reverse_rows(screen, top + shift, bottom);
+        reverse_rows(screen, top, bottom);
+    }
+
+    /* The rows that wrapped around become the new blank lines */
+    int first_blank = n > 0 ? bottom - count + 1 : top;
+    for (int y = first_blank; y < first_blank + count; ++y) {
+        clear_row(screen, ul_screen_get_row(screen, y));
+    }
+
+    /* Only the region changed */
+    for (int y = top; y <= bottom; ++y) {
+        damage(screen, y, 0, screen->cols);
+    }
+}
+
+static bool is_full_region(const ul_screen *screen) {
+    return screen->scroll_top == 0 && screen->scroll_bottom == screen->rows - 1;
+}
+
+static void clear_scrollback(ul_screen *screen) {
+    ul_row_ring *ring = &(screen->ring);
+    int num_lines = ring->count - screen->rows;
+
+    if (screen->history) {
+        ul_history_clear(screen->history);
+    }
+
+    for (int i = 0; i < num_lines; ++i) {
+        destroy_row(ring->rows[ring_index(ring, i)]);
+    }
+
+    ring->head = ring_index(ring, num_lines);
+    ring->count -= num_lines;
+    ul_reflow_clear(&(screen->reflow));
+    screen->view_offset = 0;
+
+    mark_view_dirty(screen);
+}
+
+static bool alloc_damage(ul_screen *screen, int rows) {
+    uint32_t *bits = calloc((rows + 31) / 32, sizeof(uint32_t));
+    ul_screen_span *spans = calloc(rows, sizeof(ul_screen_span));
+    uint32_t *hashes = calloc(rows, sizeof(uint32_t));
+    if (!bits || !spans || !hashes) {
+        free(bits);
+        free(spans);
+        free(hashes);
+        return false;
+    }
+
+    free(screen->damage);
+    free(screen->damage_spans);
+    free(screen->drawn_hashes);
+    screen->damage = bits;
+    screen->damage_spans = spans;
+    screen->drawn_hashes = hashes;
+    screen->has_drawn_hashes = false;
+    screen->scrolled_rows = 0;
+
+    return true;
+}
+
+static void damage(ul_screen *screen, int y, int x0, int x1) {
+    int view_y = y + screen->view_offset;
+    if (view_y < 0 || view_y >= screen->rows || x0 >= x1) {
+        return;
+    }
+
+    ul_screen_span *span = &(screen->damage_spans[view_y]);
+    uint32_t bit = (uint32_t)1 << (view_y % 32);
+    if (screen->damage[view_y / 32] & bit) {
+        span->x0 = (uint16_t)MIN(span->x0, x0);
+        span->x1 = (uint16_t)MAX(span->x1, x1);
+    } else {
+        screen->damage[view_y / 32] |= bit;
+        span->x0 = (uint16_t)x0;
+        span->x1 = (uint16_t)x1;
+    }
+    screen->is_dirty = true;
+}
+
+static void mark_view_dirty(ul_screen *screen) {
+    for (int y = 0; y < screen->rows; ++y) {
+        screen->damage[y / 32] |= (uint32_t)1 << (y % 32);
+        screen->damage_spans[y] = (ul_screen_span){ .x0 = 0, .x1 = (uint16_t)screen->cols };
+    }
+    screen->is_dirty = true;
+}
+
+static bool is_row_unchanged(const ul_screen *screen, int y) {
+    /* Rows of a scrolled-back view may be assembled on the fly and carry no hash */
+    return screen->has_drawn_hashes && screen->view_offset == 0 && ul_screen_get_row(screen, y)->hash == screen->drawn_hashes[y];
+}
+
+static int encode_utf8(uint32_t codepoint, char *out) {
+    if (codepoint < 0x80) {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char)(0xc0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3f));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char)(0xe0 | (codepoint >> 12));
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (codepoint & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (codepoint >> 18));
+    out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (codepoint & 0x3f));
+    return 4;
+}
+
+
+/**
+ * Public functions
+ */
+
+ul_screen *ul_screen_create(int cols, int rows, int scrollback) {
+    if (cols < 1 || rows < 1 || cols > UINT16_MAX) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Invalid screen size %dx%d", cols, rows);
+        return NULL;
+    }
+
+    ul_screen *screen = calloc(1, sizeof(ul_screen));
+    if (!screen) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for screen");
+        return NULL;
+    }
+
+    screen->cols = cols;
+    screen->rows = rows;
+    screen->scrollback = scrollback < 0 ? 0 : scrollback;
+    ul_attr_reset(&(screen->pen));
+    ul_attr_reset(&(screen->saved.pen));
+    screen->pen_id = UL_ATTR_DEFAULT_ID;
+    screen->erase_id = UL_ATTR_DEFAULT_ID;
+    screen->scroll_top = 0;
+    screen->scroll_bottom = rows - 1;
+
+    /* Visible rows are allocated upfront, scrollback rows as lines scroll off */
+    int hot_lines = MIN(screen->scrollback, UL_SCREEN_HOT_SCROLLBACK);
+    if (!init_ring(&(screen->ring), rows + hot_lines, rows, cols)) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for %d screen rows", rows);
+        free(screen);
+        return NULL;
+    }
+
+    if (!ul_reflow_init(&(screen->reflow), cols) || !alloc_view_rows(screen, cols, rows) || !alloc_damage(screen, rows)) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for screen view");
+        ul_screen_destroy(screen);
+        return NULL;
+    }
+
+    /* Older lines are compressed, if that fails only the recent lines are kept */
+    if (screen->scrollback > hot_lines) {
+        screen->history = ul_history_create(cols, screen->scrollback - hot_lines);
+        if (!screen->history) {
+            ul_log(UL_LOG_LEVEL_WARNING, "Could not create history, keeping only %d scrollback lines", hot_lines);
+        }
+    }
+    mark_view_dirty(screen);
+
+    return screen;
+}
+
+void ul_screen_destroy(ul_screen *screen) {
+    if (!screen) {
+        return;
+    }
+
+    free_ring(&(screen->ring));
+    free_ring(&(screen->inactive_ring));
+    ul_history_destroy(screen->history);
+    ul_reflow_free(&(screen->reflow));
+    free(screen->damage);
+    free(screen->damage_spans);
+    free(screen->drawn_hashes);
+    if (screen->view_rows) {
+        free(screen->view_rows[0].cells);
+        free(screen->view_rows);
+    }
+
+    ul_attr_unref(screen->pen_id);
+    ul_attr_unref(screen->erase_id);
+    free(screen);
+}
+
+ul_row *ul_screen_get_row(const ul_screen *screen, int y) {
+    return screen->ring.rows[ring_index(&(screen->ring), screen->ring.count - screen->rows + y)];
+}
+
+const ul_row *ul_screen_get_view_row(const ul_screen *screen, int y) {
+    int num_rows = ul_screen_get_scrollback_count(screen);
+    int index = num_rows - screen->view_offset + y;
+
+    if (index >= num_rows) {
+        return ul_screen_get_row(screen, index - num_rows);
+    }
+    return get_scrollback_row(screen, index, &(screen->view_rows[y]));
+}
+
+void ul_screen_get_view_position(const ul_screen *screen, int y, int x, int *line, int *col) {
+    int num_rows = ul_screen_get_scrollback_count(screen);
+    int index = num_rows - screen->view_offset + y;
+    ul_reflow_span span;
+
+    if (index >= num_rows || !ul_reflow_get_span(&(screen->reflow), index, &span)) {
+        *line = get_scrollback_lines(screen) + index - num_rows;
+        *col = x;
+        return;
+    }
+
+    int offset = span.start + x;
+    *line = span.line + offset / span.width;
+    *col = offset % span.width;
+}
+
+bool ul_screen_get_line_view_position(const ul_screen *screen, int index, int col, int *y, int *x) {
+    int num_rows = ul_screen_get_scrollback_count(screen);
+    int row = get_display_row(screen, index, col);
+    *y = row - (num_rows - screen->view_offset);
+    *x = col;
+    if (*y < 0 || *y >= screen->rows) {
+        return false;
+    }
+
+    /* Scrollback lines may be re-wrapped, the column is counted from the start of the display row */
+    ul_reflow_span span;
+    if (row < num_rows && ul_reflow_get_span(&(screen->reflow), row, &span)) {
+        *x = (index - span.line) * span.width + col - span.start;
+    }
+    return *x >= 0 && *x < screen->cols;
+}
+
+int ul_screen_get_line_count(const ul_screen *screen) {
+    return get_scrollback_lines(screen) + screen->rows;
+}
+
+const ul_row *ul_screen_get_line(const ul_screen *screen, int index) {
+    int num_cold = screen->history && !screen->is_alternate ? ul_history_get_count(screen->history) : 0;
+
+    index = CLAMP(index, 0, ul_screen_get_line_count(screen) - 1);
+    if (index < num_cold) {
+        return ul_history_get_row(screen->history, index);
+    }
+    return screen->ring.rows[ring_index(&(screen->ring), index - num_cold)];
+}
+
+uint32_t ul_screen_get_line_sequence(const ul_screen *screen, int index) {
+    return screen->reflow.oldest_line + (uint32_t)index;
+}
+
+int ul_screen_find_line(const ul_screen *screen, uint32_t sequence) {
+    uint32_t index = sequence - screen->reflow.oldest_line;
+    if (index >= (uint32_t)ul_screen_get_line_count(screen)) {
+        return -1;
+    }
+    return (int)index;
+}
+
+void ul_screen_show_line(ul_screen *screen, int index, int col) {
+    int num_rows = ul_screen_get_scrollback_count(screen);
+    int row = get_display_row(screen, index, col);
+    int top = num_rows - screen->view_offset;
+    if (row >= top && row < top + screen->rows) {
+        return;
+    }
+
+    ul_screen_scroll_view(screen, num_rows - (row - screen->rows / 2) - screen->view_offset);
+}
+
+int ul_screen_get_scrollback_count(const ul_screen *screen) {
+    return screen->is_alternate ? 0 : ul_reflow_get_row_count(&(screen->reflow));
+}
+
+bool ul_screen_resize(ul_screen *screen, int cols, int rows) {
+    if (cols < 1 || rows < 1 || cols > UINT16_MAX) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Invalid screen size %dx%d", cols, rows);
+        return false;
+    }
+    if (cols == screen->cols && rows == screen->rows) {
+        return true;
+    }
+
+    const int64_t start_us = ul_clock_get_us();
+    ul_row_ring *primary = screen->is_alternate ? &(screen->inactive_ring) : &(screen->ring);
+    int *primary_x = screen->is_alternate ? &(screen->inactive_saved.x) : &(screen->cursor_x);
+    int *primary_y = screen->is_alternate ? &(screen->inactive_saved.y) : &(screen->cursor_y);
+    int primary_capacity = primary->capacity - screen->rows + rows;
+    int num_added = MAX(rows - screen->rows, 0);
+
+    /* Remember the line at the top of a scrolled-back view by its sequence number, its
+     * index shifts if old lines are dropped */
+    bool is_anchored = screen->view_offset > 0;
+    uint32_t anchor_line = 0;
+    int anchor_col = 0;
+    if (is_anchored) {
+        int line;
+        ul_screen_get_view_position(screen, 0, 0, &line, &anchor_col);
+        anchor_line = screen->reflow.oldest_line + (uint32_t)line;
+    }
+
+    /* The inactive alternate screen is recreated at the new size when it's shown again */
+    if (!screen->is_alternate) {
+        free_ring(&(screen->inactive_ring));
+    }
+
+    /* The primary screen's rows are re-wrapped through the line index so that no text is lost.
+     * The plan tells how many rows to build for it. */
+    rewrap_plan plan;
+    bool is_rewrapped = plan_rewrap(screen, primary, cols, rows, *primary_x, *primary_y, &plan);
+    int num_kept = is_rewrapped ? plan.first_line - (screen->history ? ul_history_get_count(screen->history) : 0) : primary->count;
+    int num_primary_fresh = is_rewrapped ? plan.num_rows : num_added;
+    int num_alternate_fresh = screen->is_alternate ? num_added : 0;
+
+    /* Allocate everything upfront so that a failure leaves the screen untouched */
+    ul_row **primary_slots = calloc(MAX(primary_capacity, num_kept + num_primary_fresh), sizeof(ul_row *));
+    ul_row **alternate_slots = screen->is_alternate ? calloc(MAX(rows, screen->ring.count) + num_added, sizeof(ul_row *)) : NULL;
+    ul_row **fresh = calloc(num_primary_fresh + num_alternate_fresh + 1, sizeof(ul_row *));
+    bool is_allocated = primary_slots && (!screen->is_alternate || alternate_slots) && fresh;
+    for (int i = 0; is_allocated && i < num_primary_fresh + num_alternate_fresh; ++i) {
+        fresh[i] = create_row(cols);
+        is_allocated = fresh[i] != NULL;
+    }
+    is_allocated = is_allocated && widen_ring(primary, cols) && (!screen->is_alternate || widen_ring(&(screen->ring), cols))
+        && (!screen->history || ul_history_set_cols(screen->history, cols)) && alloc_view_rows(screen, cols, rows)
+        && alloc_damage(screen, rows);
+    if (!is_allocated) {
+        for (int i = 0; fresh && fresh[i]; ++i) {
+            destroy_row(fresh[i]);
+        }
+        free(primary_slots);
+        free(alternate_slots);
+        free(fresh);
+        if (is_rewrapped) {
+            undo_rewrap(screen, &plan);
+        }
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for resizing screen to %dx%d", cols, rows);
+        return false;
+    }
+
+    if (cols < screen->cols) {
+        if (!is_rewrapped) {
+            truncate_rows(screen, primary, cols);
+        }
+        if (screen->is_alternate) {
+            truncate_rows(screen, &(screen->ring), cols);
+        }
+    }
+
+    screen->cols = cols;
+    ul_reflow_set_cols(&(screen->reflow), cols);
+    if (is_rewrapped) {
+        rewrap_ring(screen, primary, &plan, primary_capacity, primary_slots, fresh, primary_x, primary_y);
+    } else {
+        reshape_ring(screen, primary, rows, primary_capacity, primary_slots, fresh, primary_y, true);
+    }
+    if (screen->is_alternate) {
+        reshape_ring(screen, &(screen->ring), rows, rows, alternate_slots, fresh + num_primary_fresh, &(screen->cursor_y), false);
+    }
+    free(fresh);
+    screen->rows = rows;
+
+    /* Rows were widened or cut without updating their hashes */
+    rehash_rows(screen, primary);
+    if (screen->is_alternate) {
+        rehash_rows(screen, &(screen->ring));
+    }
+
+    screen->scroll_top = 0;
+    screen->scroll_bottom = rows - 1;
+    screen->saved.x = CLAMP(screen->saved.x, 0, cols - 1);
+    screen->saved.y = CLAMP(screen->saved.y, 0, rows - 1);
+    screen->inactive_saved.x = CLAMP(screen->inactive_saved.x, 0, cols - 1);
+    screen->inactive_saved.y = CLAMP(screen->inactive_saved.y, 0, rows - 1);
+    ul_screen_move_cursor(screen, screen->cursor_x, screen->cursor_y);
+
+    /* Scrollback lines are re-wrapped lazily, only the anchor is mapped back to a display row */
+    screen->view_offset = 0;
+    if (is_anchored) {
+        int line = (int)(anchor_line - screen->reflow.oldest_line);
+        int num_rows = ul_screen_get_scrollback_count(screen);
+        screen->view_offset = CLAMP(num_rows - get_display_row(screen, MAX(line, 0), anchor_col), 0, num_rows);
+    }
+    mark_view_dirty(screen);
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Resized screen to %dx%d with %d scrollback lines in %ld us", cols, rows,
+        get_scrollback_lines(screen), (long)(ul_clock_get_us() - start_us));
+
+    return true;
+}
+
+void ul_screen_put_char(ul_screen *screen, uint32_t codepoint) {
+    if (screen->wrap_pending) {
+        ul_screen_get_row(screen, screen->cursor_y)->flags |= UL_ROW_FLAG_WRAPPED;
+        ul_screen_carriage_return(screen);
+        ul_screen_linefeed(screen);
+    }
+
+    ul_row *row = ul_screen_get_row(screen, screen->cursor_y);
+    ul_cell *cell = &(row->cells[screen->cursor_x]);
+
+    row->hash -= hash_cell(cell, screen->cursor_x);
+    ul_attr_unref(cell->attr);
+    ul_attr_ref(screen->pen_id);
+    cell->codepoint = codepoint;
+    cell->attr = screen->pen_id;
+    cell->width = 1;
+    row->hash += hash_cell(cell, screen->cursor_x);
+
+    if (row->len <= screen->cursor_x) {
+        row->len = (uint16_t)(screen->cursor_x + 1);
+    }
+    damage(screen, screen->cursor_y, screen->cursor_x, screen->cursor_x + 1);
+
+    if (screen->cursor_x == screen->cols - 1) {
+        screen->wrap_pending = true;
+    } else {
+        ++screen->cursor_x;
+    }
+}
+
+void ul_screen_carriage_return(ul_screen *screen) {
+    screen->cursor_x = 0;
+    screen->wrap_pending = false;
+}
+
+void ul_screen_linefeed(ul_screen *screen) {
+    screen->wrap_pending = false;
+    if (screen->cursor_y == screen->scroll_bottom) {
+        ul_screen_scroll_up(screen, 1);
+    } else if (screen->cursor_y < screen->rows - 1) {
+        ++screen->cursor_y;
+    }
+}
+
+void ul_screen_reverse_linefeed(ul_screen *screen) {
+    screen->wrap_pending = false;
+    if (screen->cursor_y == screen->scroll_top) {
+        ul_screen_scroll_down(screen, 1);
+    } else if (screen->cursor_y > 0) {
+        --screen->cursor_y;
+    }
+}
+
+void ul_screen_set_scroll_region(ul_screen *screen, int top, int bottom) {
+    if (top < 0 || bottom >= screen->rows || top >= bottom) {
+        top = 0;
+        bottom = screen->rows - 1;
+    }
+    screen->scroll_top = top;
+    screen->scroll_bottom = bottom;
+    ul_screen_move_cursor(screen, 0, 0);
+}
+
+void ul_screen_scroll_up(ul_screen *screen, int n) {
+    n = CLAMP(n, 1, screen->rows);
+
+    if (is_full_region(screen)) {
+        /* Advancing the ring is a rotation of the whole screen that also feeds the scrollback */
+        for (int i = 0; i < n; ++i) {
+            scroll_into_history(screen);
+        }
+        screen->scrolled_rows = MIN(screen->scrolled_rows + n, screen->rows);
+        return;
+    }
+
+    rotate_rows(screen, screen->scroll_top, screen->scroll_bottom, n);
+}
+
+void ul_screen_scroll_down(ul_screen *screen, int n) {
+    rotate_rows(screen, screen->scroll_top, screen->scroll_bottom, -CLAMP(n, 1, screen->rows));
+}
+
+void ul_screen_insert_lines(ul_screen *screen, int n) {
+    if (screen->cursor_y < screen->scroll_top || screen->cursor_y > screen->scroll_bottom) {
+        return;
+    }
+    rotate_rows(screen, screen->cursor_y, screen->scroll_bottom, -CLAMP(n, 1, screen->rows));
+    ul_screen_carriage_return(screen);
+}
+
+void ul_screen_delete_lines(ul_screen *screen, int n) {
+    if (screen->cursor_y < screen->scroll_top || screen->cursor_y > screen->scroll_bottom) {
+        return;
+    }
+    rotate_rows(screen, screen->cursor_y, screen->scroll_bottom, CLAMP(n, 1, screen->rows));
+    ul_screen_carriage_return(screen);
+}
+
+void ul_screen_backspace(ul_screen *screen) {
+    screen->wrap_pending = false;
+    if (screen->cursor_x > 0) {
+        --screen->cursor_x;
+    }
+}
+
+void ul_screen_tab(ul_screen *screen) {
+    int x = (screen->cursor_x / UL_SCREEN_TAB_WIDTH + 1) * UL_SCREEN_TAB_WIDTH;
+    screen->cursor_x = CLAMP(x, 0, screen->cols - 1);
+}
+
+void ul_screen_move_cursor(ul_screen *screen, int x, int y) {
+    screen->cursor_x = CLAMP(x, 0, screen->cols - 1);
+    screen->cursor_y = CLAMP(y, 0, screen->rows - 1);
+    screen->wrap_pending = false;
+}
+
+void ul_screen_erase_display(ul_screen *screen, int mode) {
+    switch (mode) {
+    case 0:
+        ul_screen_erase_line(screen, 0);
+        for (int y = screen->cursor_y + 1; y < screen->rows; ++y) {
+            erase_range(screen, y, 0, screen->cols);
+        }
+        break;
+    case 1:
+        for (int y = 0; y < screen->cursor_y; ++y) {
+            erase_range(screen, y, 0, screen->cols);
+        }
+        ul_screen_erase_line(screen, 1);
+        break;
+    case 3:
+        clear_scrollback(screen);
+        break;
+    case 2:
+        for (int y = 0; y < screen->rows; ++y) {
+            erase_range(screen, y, 0, screen->cols);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void ul_screen_erase_line(ul_screen *screen, int mode) {
+    int y = screen->cursor_y;
+
+    switch (mode) {
+    case 0:
+        erase_range(screen, y, screen->cursor_x, screen->cols);
+        break;
+    case 1:
+        erase_range(screen, y, 0, screen->cursor_x + 1);
+        break;
+    case 2:
+        erase_range(screen, y, 0, screen->cols);
+        break;
+    default:
+        break;
+    }
+}
+
+void ul_screen_erase_chars(ul_screen *screen, int n) {
+    n = n < 1 ? 1 : n;
+    erase_range(screen, screen->cursor_y, screen->cursor_x, screen->cursor_x + n);
+}
+
+void ul_screen_insert_chars(ul_screen *screen, int n) {
+    ul_row *row = ul_screen_get_row(screen, screen->cursor_y);
+    int x = screen->cursor_x;
+    n = CLAMP(n, 1, screen->cols - x);
+
+    row->hash -= hash_cells(row, x, screen->cols);
+    release_cells(row->cells + screen->cols - n, n);
+    memmove(row->cells + x + n, row->cells + x, (screen->cols - x - n) * sizeof(ul_cell));
+    fill_blank(screen, row->cells + x, n);
+    row->hash += hash_cells(row, x, screen->cols);
+
+    if (row->len > x) {
+        row->len = (uint16_t)MIN(row->len + n, screen->cols);
+    }
+    damage(screen, screen->cursor_y, x, screen->cols);
+    screen->wrap_pending = false;
+}
+
+void ul_screen_delete_chars(ul_screen *screen, int n) {
+    ul_row *row = ul_screen_get_row(screen, screen->cursor_y);
+    int x = screen->cursor_x;
+    n = CLAMP(n, 1, screen->cols - x);
+
+    row->hash -= hash_cells(row, x, screen->cols);
+    release_cells(row->cells + x, n);
+    memmove(row->cells + x, row->cells + x + n, (screen->cols - x - n) * sizeof(ul_cell));
+    fill_blank(screen, row->cells + screen->cols - n, n);
+    row->hash += hash_cells(row, x, screen->cols);
+
+    if (screen->erase_id != UL_ATTR_DEFAULT_ID) {
+        row->len = (uint16_t)screen->cols;
+    } else if (row->len > x) {
+        row->len = (uint16_t)MAX(row->len - n, x);
+    }
+    damage(screen, screen->cursor_y, x, screen->cols);
+    screen->wrap_pending = false;
+}
+
+void ul_screen_set_pen(ul_screen *screen, const ul_attr *attr) {
+    ul_attr_id pen_id = ul_attr_intern(attr);
+    ul_attr_unref(screen->pen_id);
+    screen->pen = *attr;
+    screen->pen_id = pen_id;
+
+    ul_attr erase;
+    ul_attr_reset(&erase);
+    erase.bg = attr->bg;
+    ul_attr_id erase_id = ul_attr_intern(&erase);
+    ul_attr_unref(screen->erase_id);
+    screen->erase_id = erase_id;
+}
+
+void ul_screen_save_cursor(ul_screen *screen) {
+    screen->saved.x = screen->cursor_x;
+    screen->saved.y = screen->cursor_y;
+    screen->saved.pen = screen->pen;
+}
+
+void ul_screen_restore_cursor(ul_screen *screen) {
+    ul_screen_move_cursor(screen, screen->saved.x, screen->saved.y);
+    ul_screen_set_pen(screen, &(screen->saved.pen));
+}
+
+bool ul_screen_set_alternate(ul_screen *screen, bool enable, bool clear) {
+    if (enable != screen->is_alternate) {
+        /* The alternate rows are allocated on first use. Its ring holds exactly the visible
+         * rows, so scrolling recycles them and nothing ever reaches the scrollback. */
+        if (enable && !screen->inactive_ring.rows) {
+            if (!init_ring(&(screen->inactive_ring), screen->rows, screen->rows, screen->cols)) {
+                ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for alternate screen");
+                return false;
+            }
+            screen->inactive_saved = screen->saved;
+        }
+
+        ul_row_ring ring = screen->ring;
+        screen->ring = screen->inactive_ring;
+        screen->inactive_ring = ring;
+
+        ul_screen_cursor_state saved = screen->saved;
+        screen->saved = screen->inactive_saved;
+        screen->inactive_saved = saved;
+
+        screen->is_alternate = enable;
+        screen->view_offset = 0;
+        screen->wrap_pending = false;
+        mark_view_dirty(screen);
+    }
+
+    if (enable && clear) {
+        ul_screen_erase_display(screen, 2);
+    }
+
+    return true;
+}
+
+void ul_screen_scroll_view(ul_screen *screen, int delta) {
+    int offset = CLAMP(screen->view_offset + delta, 0, ul_screen_get_scrollback_count(screen));
+    if (offset == screen->view_offset) {
+        return;
+    }
+    screen->view_offset = offset;
+    mark_view_dirty(screen);
+}
+
+bool ul_screen_is_cursor_visible(const ul_screen *screen) {
+    return !screen->is_cursor_hidden && screen->view_offset == 0;
+}
+
+void ul_screen_set_cursor_visible(ul_screen *screen, bool is_visible) {
+    screen->is_cursor_hidden = !is_visible;
+}
+
+void ul_screen_set_row(ul_screen *screen, int y, const ul_row *src) {
+    ul_row *row = ul_screen_get_row(screen, y);
+    int x0 = screen->cols;
+    int x1 = 0;
+
+    for (int x = 0; x < screen->cols; ++x) {
+        ul_cell *cell = &(row->cells[x]);
+        if (memcmp(cell, &(src->cells[x]), sizeof(ul_cell)) == 0) {
+            continue;
+        }
+
+        row->hash -= hash_cell(cell, x);
+        ul_attr_ref(src->cells[x].attr);
+        ul_attr_unref(cell->attr);
+        *cell = src->cells[x];
+        row->hash += hash_cell(cell, x);
+
+        x0 = MIN(x0, x);
+        x1 = x + 1;
+    }
+
+    row->len = (uint16_t)MIN(src->len, screen->cols);
+    row->flags = src->flags;
+    damage(screen, y, x0, x1);
+}
+
+size_t ul_screen_get_view_text(const ul_screen *screen, char *buf, size_t size, int *cursor_pos, int *row_starts) {
+    size_t pos = 0;
+    int num_chars = 0;
+    int cursor_y = ul_screen_is_cursor_visible(screen) ? screen->cursor_y : -1;
+
+    *cursor_pos = -1;
+    for (int y = 0; row_starts && y < screen->rows; ++y) {
+        row_starts[y] = -1;
+    }
+
+    if (size == 0) {
+        return 0;
+    }
+
+    for (int y = 0; y < screen->rows; ++y) {
+        const ul_row *row = ul_screen_get_view_row(screen, y);
+
+        if (row_starts) {
+            row_starts[y] = num_chars;
+        }
+
+        /* Trim trailing blanks but keep the line long enough to hold the cursor */
+        int len = row->len;
+        while (len > 0 && (row->cells[len - 1].codepoint == 0 || row->cells[len - 1].codepoint == ' ')) {
+            --len;
+        }
+        if (y == cursor_y && len < screen->cursor_x) {
+            len = screen->cursor_x;
+        }
+
+        for (int x = 0; x < len; ++x) {
+            uint32_t codepoint = row->cells[x].codepoint;
+            char utf8[4];
+            int num_bytes = encode_utf8(codepoint < ' ' ? ' ' : codepoint, utf8);
+            if (pos + num_bytes >= size) {
+                goto out;
+            }
+            memcpy(buf + pos, utf8, num_bytes);
+            pos += num_bytes;
+
+            if (y == cursor_y && x == screen->cursor_x) {
+                *cursor_pos = num_chars;
+            }
+            ++num_chars;
+        }
+
+        if (y == cursor_y && *cursor_pos < 0) {
+            *cursor_pos = num_chars;
+        }
+
+        if (y < screen->rows - 1) {
+            if (pos + 1 >= size) {
+                goto out;
+            }
+            buf[pos++] = '\n';
+            ++num_chars;
+        }
+    }
+
+out:
+    buf[pos] = '\0';
+    return pos;
+}
+
+bool ul_screen_get_damage(const ul_screen *screen, int y, ul_screen_span *span) {
+    if (!(screen->damage[y / 32] & ((uint32_t)1 << (y % 32))) || is_row_unchanged(screen, y)) {
+        return false;
+    }
+    *span = screen->damage_spans[y];
+    return true;
+}
+
+void ul_screen_present(ul_screen *screen) {
+    for (int y = 0; y < screen->rows; ++y) {
+        if (screen->damage[y / 32] & ((uint32_t)1 << (y % 32))) {
+            ++num_damaged_rows;
+            if (is_row_unchanged(screen, y)) {
+                ++num_unchanged_rows;
+            }
+        }
+    }
+
+    /* Only rows of the live screen carry hashes */
+    screen->has_drawn_hashes = screen->view_offset == 0;
+    for (int y = 0; screen->has_drawn_hashes && y < screen->rows; ++y) {
+        screen->drawn_hashes[y] = ul_screen_get_row(screen, y)->hash;
+    }
+
+    memset(screen->damage, 0, (screen->rows + 31) / 32 * sizeof(uint32_t));
+    screen->scrolled_rows = 0;
+    screen->is_dirty = false;
+}
+
+void ul_screen_clear_damage(ul_screen *screen) {
+    memset(screen->damage, 0, (screen->rows + 31) / 32 * sizeof(uint32_t));
+    screen->scrolled_rows = 0;
+    screen->is_dirty = false;
+}
+
+int ul_screen_get_scroll(const ul_screen *screen) {
+    int n = screen->scrolled_rows;
+    if (!screen->has_drawn_hashes || screen->view_offset != 0 || n <= 0 || n >= screen->rows) {
+        return 0;
+    }
+
+    int num_shifted = 0;
+    int num_unshifted = 0;
+    for (int y = 0; y < screen->rows; ++y) {
+        uint32_t hash = ul_screen_get_row(screen, y)->hash;
+        if (y + n < screen->rows && hash == screen->drawn_hashes[y + n]) {
+            ++num_shifted;
+        }
+        if (hash == screen->drawn_hashes[y]) {
+            ++num_unshifted;
+        }
+    }
+
+    return num_shifted > num_unshifted ? n : 0;
+}
+
+void ul_screen_scroll_drawn(ul_screen *screen, int n) {
+    if (!screen->has_drawn_hashes || n <= 0 || n >= screen->rows) {
+        return;
+    }
+
+    memmove(screen->drawn_hashes, screen->drawn_hashes + n, (size_t)(screen->rows - n) * sizeof(uint32_t));
+
+    /* The rows moved in at the bottom still show stale pixels and must never match */
+    for (int y = screen->rows - n; y < screen->rows; ++y) {
+        screen->drawn_hashes[y] = ~ul_screen_get_row(screen, y)->hash;
+    }
+}
+
+void ul_screen_get_stats(ul_screen_stats *stats) {
+    stats->damaged_rows = num_damaged_rows;
+    stats->unchanged_rows = num_unchanged_rows;
+}
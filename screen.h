@@ -0,0 +1,548 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_SCREEN_H
+#define UL_SCREEN_H
+
+#include "attr.h"
+#include "history.h"
+#include "reflow.h"
+#include "row.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Number of scrollback lines kept if not configured otherwise */
+#define UL_SCREEN_DEFAULT_SCROLLBACK 1000
+
+/* Number of recent scrollback lines kept uncompressed, older lines move into the history */
+#define UL_SCREEN_HOT_SCROLLBACK 256
+
+/* Distance between tab stops */
+#define UL_SCREEN_TAB_WIDTH 8
+
+/**
+ * Ring of row pointers. Rotating the ring moves rows without touching their cells.
+ */
+typedef struct {
+    /* Row pointers, capacity entries */
+    ul_row **rows;
+    /* Maximum number of rows */
+    int capacity;
+    /* Index of the oldest row */
+    int head;
+    /* Number of rows currently in the ring */
+    int count;
+} ul_row_ring;
+
+/**
+ * Range of damaged columns in a row
+ */
+typedef struct {
+    /* First column */
+    uint16_t x0;
+    /* Column after the last one */
+    uint16_t x1;
+} ul_screen_span;
+
+/**
+ * Screen statistics
+ */
+typedef struct {
+    /* Number of damaged view rows over all presented frames */
+    unsigned long damaged_rows;
+    /* Number of damaged view rows whose content matched what was last presented */
+    unsigned long unchanged_rows;
+} ul_screen_stats;
+
+/**
+ * Saved cursor state (DECSC / DECRC)
+ */
+typedef struct {
+    int x;
+    int y;
+    ul_attr pen;
+} ul_screen_cursor_state;
+
+/**
+ * Screen model: the visible grid plus its scrollback
+ */
+typedef struct {
+    /* Number of columns */
+    int cols;
+    /* Number of visible rows */
+    int rows;
+    /* Maximum number of scrollback lines */
+    int scrollback;
+    /* Active rows. On the primary screen this is the recent scrollback followed by the
+     * visible rows with the last `rows` entries on screen, on the alternate screen it holds
+     * just the visible rows. */
+    ul_row_ring ring;
+    /* Rows of the screen that is currently not shown, swapped with ring on switches */
+    ul_row_ring inactive_ring;
+    /* True if the alternate screen is active */
+    bool is_alternate;
+    /* Compressed older scrollback of the primary screen, NULL if all of it fits into the ring */
+    ul_history *history;
+    /* Logical lines of the primary screen's scrollback (history and ring) for re-wrapping
+     * them at the current width */
+    ul_reflow reflow;
+    /* Scratch rows, one per visible row, for scrollback lines re-wrapped into the view */
+    ul_row *view_rows;
+    /* Cursor column */
+    int cursor_x;
+    /* Cursor row */
+    int cursor_y;
+    /* True if the cursor sits past the last column and the next character wraps */
+    bool wrap_pending;
+    /* True if the cursor is not shown even when the view is at the live screen */
+    bool is_cursor_hidden;
+    /* First row of the scroll region (DECSTBM) */
+    int scroll_top;
+    /* Last row of the scroll region (inclusive) */
+    int scroll_bottom;
+    /* Current rendition used for new characters */
+    ul_attr pen;
+    /* Interned ID of pen */
+    ul_attr_id pen_id;
+    /* Interned ID used for erased cells (background colour of pen only) */
+    ul_attr_id erase_id;
+    /* Cursor state saved with DECSC */
+    ul_screen_cursor_state saved;
+    /* Cursor state saved on the screen that is currently not shown */
+    ul_screen_cursor_state inactive_saved;
+    /* Number of display rows the view is scrolled back into history */
+    int view_offset;
+    /* Rows of the view that changed since the screen was last presented, one bit per row */
+    uint32_t *damage;
+    /* Changed columns of each damaged row of the view */
+    ul_screen_span *damage_spans;
+    /* Hash of each view row when the screen was last presented */
+    uint32_t *drawn_hashes;
+    /* True if drawn_hashes holds the rows of the live screen, false if they are unknown or
+     * the view was scrolled back */
+    bool has_drawn_hashes;
+    /* Number of rows the whole screen scrolled up since it was last presented */
+    int scrolled_rows;
+    /* True if anything changed since the screen was last presented */
+    bool is_dirty;
+} ul_screen;
+
+/**
+ * Create a screen.
+ *
+ * @param cols number of columns
+ * @param rows number of visible rows
+ * @param scrollback maximum number of scrollback lines
+ * @return the new screen or NULL on failure
+ */
+ul_screen *ul_screen_create(int cols, int rows, int scrollback);
+
+/**
+ * Destroy a screen and release all of its rows.
+ *
+ * @param screen screen to destroy
+ */
+void ul_screen_destroy(ul_screen *screen);
+
+/**
+ * Get a visible row.
+ *
+ * @param screen screen
+ * @param y row index (0 is the top row)
+ * @return the row
+ */
+ul_row *ul_screen_get_row(const ul_screen *screen, int y);
+
+/**
+ * Get a row of the current view, taking the scrollback position into account. Scrollback
+ * lines written at another width are re-wrapped on the fly, the returned row stays valid
+ * until the view row is requested again.
+ *
+ * @param screen screen
+ * @param y row index in the view (0 is the top row)
+ * @return the row
+ */
+const ul_row *ul_screen_get_view_row(const ul_screen *screen, int y);
+
+/**
+ * Map a cell of the current view to the line and column it shows.
+ *
+ * @param screen screen
+ * @param y row index in the view (0 is the top row)
+ * @param x column in the view
+ * @param line pointer for writing the line index into (0 is the oldest scrollback line)
+ * @param col pointer for writing the column in the line into
+ */
+void ul_screen_get_view_position(const ul_screen *screen, int y, int x, int *line, int *col);
+
+/**
+ * Map a cell of a line to its position in the current view.
+ *
+ * @param screen screen
+ * @param index line index (0 is the oldest scrollback line)
+ * @param col column in the line
+ * @param y pointer for writing the row index in the view into
+ * @param x pointer for writing the column in the view into
+ * @return true if the cell is in view, false otherwise
+ */
+bool ul_screen_get_line_view_position(const ul_screen *screen, int index, int col, int *y, int *x);
+
+/**
+ * Get the number of lines in scrollback and on screen together.
+ *
+ * @param screen screen
+ * @return number of lines
+ */
+int ul_screen_get_line_count(const ul_screen *screen);
+
+/**
+ * Get a line by its absolute index. The returned row may be decompressed from the history
+ * and only stays valid until the next access to another line.
+ *
+ * @param screen screen
+ * @param index line index (0 is the oldest scrollback line)
+ * @return the row
+ */
+const ul_row *ul_screen_get_line(const ul_screen *screen, int index);
+
+/**
+ * Get the sequence number of a line. Unlike its index, it doesn't change when older lines
+ * are dropped from the scrollback.
+ *
+ * @param screen screen
+ * @param index line index (0 is the oldest scrollback line)
+ * @return sequence number
+ */
+uint32_t ul_screen_get_line_sequence(const ul_screen *screen, int index);
+
+/**
+ * Get the current index of a line from its sequence number.
+ *
+ * @param screen screen
+ * @param sequence sequence number (see ul_screen_get_line_sequence)
+ * @return line index or -1 if the line was dropped
+ */
+int ul_screen_find_line(const ul_screen *screen, uint32_t sequence);
+
+/**
+ * Scroll the view so that a cell of a line becomes visible. The view isn't moved if the
+ * cell is already in view, otherwise its row is centred.
+ *
+ * @param screen screen
+ * @param index line index (0 is the oldest scrollback line)
+ * @param col column in the line
+ */
+void ul_screen_show_line(ul_screen *screen, int index, int col);
+
+/**
+ * Get the number of display rows the scrollback occupies at the current width.
+ *
+ * @param screen screen
+ * @return number of scrollback rows
+ */
+int ul_screen_get_scrollback_count(const ul_screen *screen);
+
+/**
+ * Change the size of the screen. The primary screen's visible rows are re-wrapped at the
+ * new width, keeping the cursor on screen. A screen filled to the bottom stays aligned to
+ * it, pulling lines back from the scrollback when it grows. Scrollback lines keep their
+ * content and are re-wrapped lazily when they are scrolled into view. The alternate screen
+ * is cut or extended instead, the inactive one is dropped and reallocated at the new size
+ * when it's shown again.
+ *
+ * @param screen screen
+ * @param cols new number of columns
+ * @param rows new number of visible rows
+ * @return true on success, false if the size is invalid or memory is short
+ */
+bool ul_screen_resize(ul_screen *screen, int cols, int rows);
+
+/**
+ * Write a character at the cursor position and advance the cursor.
+ *
+ * @param screen screen
+ * @param codepoint Unicode code point
+ */
+void ul_screen_put_char(ul_screen *screen, uint32_t codepoint);
+
+/**
+ * Move the cursor to the first column.
+ *
+ * @param screen screen
+ */
+void ul_screen_carriage_return(ul_screen *screen);
+
+/**
+ * Move the cursor down one row, scrolling the screen up if it is on the last row.
+ *
+ * @param screen screen
+ */
+void ul_screen_linefeed(ul_screen *screen);
+
+/**
+ * Move the cursor up one row, scrolling the scroll region down if it is on the top margin (RI).
+ *
+ * @param screen screen
+ */
+void ul_screen_reverse_linefeed(ul_screen *screen);
+
+/**
+ * Set the top and bottom margins of the scroll region (DECSTBM) and move the cursor home.
+ * An invalid region resets the margins to the full screen.
+ *
+ * @param screen screen
+ * @param top first row of the region
+ * @param bottom last row of the region (inclusive)
+ */
+void ul_screen_set_scroll_region(ul_screen *screen, int top, int bottom);
+
+/**
+ * Scroll the content of the scroll region up (SU). Lines only enter the scrollback if the
+ * region spans the whole primary screen.
+ *
+ * @param screen screen
+ * @param n number of lines
+ */
+void ul_screen_scroll_up(ul_screen *screen, int n);
+
+/**
+ * Scroll the content of the scroll region down (SD).
+ *
+ * @param screen screen
+ * @param n number of lines
+ */
+void ul_screen_scroll_down(ul_screen *screen, int n);
+
+/**
+ * Insert blank lines at the cursor row, pushing the rows below it down within the scroll
+ * region (IL).
+ *
+ * @param screen screen
+ * @param n number of lines
+ */
+void ul_screen_insert_lines(ul_screen *screen, int n);
+
+/**
+ * Delete lines at the cursor row, pulling the rows below it up within the scroll region (DL).
+ *
+ * @param screen screen
+ * @param n number of lines
+ */
+void ul_screen_delete_lines(ul_screen *screen, int n);
+
+/**
+ * Move the cursor one column to the left.
+ *
+ * @param screen screen
+ */
+void ul_screen_backspace(ul_screen *screen);
+
+/**
+ * Move the cursor to the next tab stop.
+ *
+ * @param screen screen
+ */
+void ul_screen_tab(ul_screen *screen);
+
+/**
+ * Move the cursor to an absolute position. Out-of-range values are clamped.
+ *
+ * @param screen screen
+ * @param x column
+ * @param y row
+ */
+void ul_screen_move_cursor(ul_screen *screen, int x, int y);
+
+/**
+ * Erase (parts of) the display (ED).
+ *
+ * @param screen screen
+ * @param mode 0 erases from the cursor to the end, 1 from the start to the cursor, 2 and 3 everything
+ */
+void ul_screen_erase_display(ul_screen *screen, int mode);
+
+/**
+ * Erase (parts of) the cursor row (EL).
+ *
+ * @param screen screen
+ * @param mode 0 erases from the cursor to the end, 1 from the start to the cursor, 2 the whole row
+ */
+void ul_screen_erase_line(ul_screen *screen, int mode);
+
+/**
+ * Erase characters starting at the cursor without moving the rest of the row (ECH).
+ *
+ * @param screen screen
+ * @param n number of characters
+ */
+void ul_screen_erase_chars(ul_screen *screen, int n);
+
+/**
+ * Insert blank characters at the cursor, shifting the rest of the row right (ICH).
+ *
+ * @param screen screen
+ * @param n number of characters
+ */
+void ul_screen_insert_chars(ul_screen *screen, int n);
+
+/**
+ * Delete characters at the cursor, shifting the rest of the row left (DCH).
+ *
+ * @param screen screen
+ * @param n number of characters
+ */
+void ul_screen_delete_chars(ul_screen *screen, int n);
+
+/**
+ * Set the rendition used for subsequently written characters.
+ *
+ * @param screen screen
+ * @param attr new rendition
+ */
+void ul_screen_set_pen(ul_screen *screen, const ul_attr *attr);
+
+/**
+ * Save the cursor position and rendition (DECSC).
+ *
+ * @param screen screen
+ */
+void ul_screen_save_cursor(ul_screen *screen);
+
+/**
+ * Restore the cursor position and rendition (DECRC).
+ *
+ * @param screen screen
+ */
+void ul_screen_restore_cursor(ul_screen *screen);
+
+/**
+ * Switch between the primary and the alternate screen. Both keep their rows, switching
+ * only swaps the active row ring. The alternate screen has no scrollback.
+ *
+ * @param screen screen
+ * @param enable true to show the alternate screen, false to return to the primary one
+ * @param clear true to erase the alternate screen when switching to it
+ * @return true on success, false if the alternate screen could not be allocated
+ */
+bool ul_screen_set_alternate(ul_screen *screen, bool enable, bool clear);
+
+/**
+ * Scroll the view into (positive delta) or out of (negative delta) the scrollback.
+ *
+ * @param screen screen
+ * @param delta number of lines
+ */
+void ul_screen_scroll_view(ul_screen *screen, int delta);
+
+/**
+ * Check whether the cursor is shown in the current view.
+ *
+ * @param screen screen
+ * @return true if the cursor is visible, false if it is hidden or the view is scrolled back
+ */
+bool ul_screen_is_cursor_visible(const ul_screen *screen);
+
+/**
+ * Show or hide the cursor.
+ *
+ * @param screen screen
+ * @param is_visible true to show the cursor, false to hide it
+ */
+void ul_screen_set_cursor_visible(ul_screen *screen, bool is_visible);
+
+/**
+ * Replace the cells of a visible row with a copy of another row, damaging only the columns
+ * whose content differs.
+ *
+ * @param screen screen
+ * @param y row index (0 is the top row)
+ * @param src row to copy, at least screen->cols cells wide
+ */
+void ul_screen_set_row(ul_screen *screen, int y, const ul_row *src);
+
+/**
+ * Write the text of the current view as UTF-8, one line per row.
+ *
+ * @param screen screen
+ * @param buf buffer to write into, always NUL-terminated
+ * @param size size of buf
+ * @param cursor_pos pointer for writing the character index of the cursor into (-1 if not in view)
+ * @param row_starts array of screen->rows entries for writing the character index of each
+ *                   row's first cell into, may be NULL
+ * @return number of bytes written (excluding the terminating NUL)
+ */
+size_t ul_screen_get_view_text(const ul_screen *screen, char *buf, size_t size, int *cursor_pos, int *row_starts);
+
+/**
+ * Get the columns of a view row that changed since the screen was last presented. Rows
+ * that were written to but hash to the same content as when they were last presented
+ * don't count as changed.
+ *
+ * @param screen screen
+ * @param y row index in the view (0 is the top row)
+ * @param span pointer for writing the changed columns into
+ * @return true if the row changed, false otherwise
+ */
+bool ul_screen_get_damage(const ul_screen *screen, int y, ul_screen_span *span);
+
+/**
+ * Mark the screen as presented, clearing the damage of all rows.
+ *
+ * @param screen screen
+ */
+void ul_screen_present(ul_screen *screen);
+
+/**
+ * Clear the damage of all rows without presenting the screen, once its changes were copied
+ * elsewhere.
+ *
+ * @param screen screen
+ */
+void ul_screen_clear_damage(ul_screen *screen);
+
+/**
+ * Get the number of rows the live screen scrolled up by since it was last presented, if the
+ * presented pixels can be moved instead of redrawn. This is the case when more rows match the
+ * presented content after shifting it than without shifting.
+ *
+ * @param screen screen
+ * @return number of rows to move the presented content up by or 0 if it should be redrawn
+ */
+int ul_screen_get_scroll(const ul_screen *screen);
+
+/**
+ * Record that the presented content was moved up by a number of rows, so that rows which
+ * now show their current content are no longer reported as damaged.
+ *
+ * @param screen screen
+ * @param n number of rows the presented content was moved up by
+ */
+void ul_screen_scroll_drawn(ul_screen *screen, int n);
+
+/**
+ * Get screen statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_screen_get_stats(ul_screen_stats *stats);
+
+#endif /* UL_SCREEN_H */
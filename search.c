@@ -0,0 +1,203 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "search.h"
+
+#include "clock.h"
+#include "history.h"
+
+#include <string.h>
+
+
+/**
+ * Static variables
+ */
+
+static unsigned long num_searches = 0;
+static unsigned long num_lines_scanned = 0;
+static unsigned long num_lines_skipped = 0;
+static long last_duration_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Check whether the query occurs at a position of a row.
+ *
+ * @param search search
+ * @param row row
+ * @param col column
+ * @return true if the query matches, false otherwise
+ */
+static bool matches_at(const ul_search *search, const ul_row *row, int col);
+
+/**
+ * Find the last occurrence of the query in a row that starts before a column.
+ *
+ * @param search search
+ * @param row row to search
+ * @param before_col column the occurrence has to start before
+ * @return column of the occurrence or -1 if there is none
+ */
+static int find_last_in_row(const ul_search *search, const ul_row *row, int before_col);
+
+
+/**
+ * Static functions
+ */
+
+static bool matches_at(const ul_search *search, const ul_row *row, int col) {
+    if (col + search->query_len > row->len) {
+        return false;
+    }
+    for (int i = 0; i < search->query_len; ++i) {
+        if (ul_history_fold(row->cells[col + i].codepoint) != search->query[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int find_last_in_row(const ul_search *search, const ul_row *row, int before_col) {
+    int last = -1;
+    for (int col = ul_search_find_in_row(search, row, 0); col >= 0 && col < before_col; col = ul_search_find_in_row(search, row, col + 1)) {
+        last = col;
+    }
+    return last;
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_search_set_query(ul_search *search, const char *text) {
+    const unsigned char *p = (const unsigned char *)text;
+
+    memset(search, 0, sizeof(ul_search));
+
+    while (*p && search->query_len < UL_SEARCH_MAX_QUERY) {
+        uint32_t codepoint = *p++;
+        int num_continuation = codepoint >= 0xf0 ? 3 : codepoint >= 0xe0 ? 2 : codepoint >= 0xc0 ? 1 : 0;
+        if (num_continuation > 0) {
+            codepoint &= 0x3f >> num_continuation;
+        }
+        for (; num_continuation > 0 && (*p & 0xc0) == 0x80; --num_continuation) {
+            codepoint = (codepoint << 6) | (*p++ & 0x3f);
+        }
+        search->query[search->query_len++] = ul_history_fold(codepoint);
+    }
+
+    for (int i = 0; i + 2 < search->query_len; ++i) {
+        search->trigram_bits[search->num_trigram_bits++] =
+            ul_history_get_trigram_bit(search->query[i], search->query[i + 1], search->query[i + 2]);
+    }
+
+    /* Shorter queries are looked up as a single character or bigram */
+    if (search->query_len == 1 || search->query_len == 2) {
+        search->trigram_bits[search->num_trigram_bits++] =
+            ul_history_get_trigram_bit(search->query[0], search->query_len == 2 ? search->query[1] : 0, 0);
+    }
+}
+
+bool ul_search_find(ul_search *search, ul_screen *screen, bool older) {
+    if (search->query_len == 0) {
+        return false;
+    }
+
+    const int64_t start_us = ul_clock_get_us();
+    int num_lines = ul_screen_get_line_count(screen);
+    int step = older ? -1 : 1;
+    int line = num_lines - 1;
+    int col = -1;
+    bool is_found = false;
+
+    /* Continue next to the current match, or past the oldest line if it was dropped meanwhile */
+    if (search->has_match) {
+        int match_line = ul_screen_find_line(screen, search->match.line);
+        if (match_line >= 0) {
+            const ul_row *row = ul_screen_get_line(screen, match_line);
+            col = older ? find_last_in_row(search, row, search->match.col) : ul_search_find_in_row(search, row, search->match.col + 1);
+            line = match_line;
+            if (col < 0) {
+                line += step;
+            }
+        } else {
+            line = older ? -1 : 0;
+        }
+    }
+
+    const ul_history *history = screen->history && !screen->is_alternate ? screen->history : NULL;
+    int num_cold = history ? ul_history_get_count(history) : 0;
+
+    for (; col < 0 && line >= 0 && line < num_lines; line += step) {
+        /* Skip whole compressed blocks that can't contain the query without decompressing them */
+        if (line < num_cold && search->num_trigram_bits > 0 && !ul_history_may_contain(history, line, search->trigram_bits, search->num_trigram_bits)) {
+            int block_start = line - line % UL_HISTORY_BLOCK_LINES;
+            int next = older ? block_start - 1 : block_start + UL_HISTORY_BLOCK_LINES;
+            num_lines_skipped += older ? line - next : next - line;
+            line = next - step;
+            continue;
+        }
+
+        const ul_row *row = ul_screen_get_line(screen, line);
+        col = older ? find_last_in_row(search, row, row->len) : ul_search_find_in_row(search, row, 0);
+        ++num_lines_scanned;
+        if (col >= 0) {
+            break;
+        }
+    }
+
+    if (col >= 0) {
+        search->match.line = ul_screen_get_line_sequence(screen, line);
+        search->match.col = col;
+        search->has_match = true;
+        ul_screen_show_line(screen, line, col);
+        is_found = true;
+    }
+
+    ++num_searches;
+    last_duration_us = (long)(ul_clock_get_us() - start_us);
+
+    return is_found;
+}
+
+int ul_search_find_in_row(const ul_search *search, const ul_row *row, int from_col) {
+    if (search->query_len == 0) {
+        return -1;
+    }
+
+    for (int col = from_col < 0 ? 0 : from_col; col + search->query_len <= row->len; ++col) {
+        if (matches_at(search, row, col)) {
+            return col;
+        }
+    }
+
+    return -1;
+}
+
+void ul_search_get_stats(ul_search_stats *stats) {
+    stats->searches = num_searches;
+    stats->lines_scanned = num_lines_scanned;
+    stats->lines_skipped = num_lines_skipped;
+    stats->last_duration_us = last_duration_us;
+}
@@ -0,0 +1,110 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_SEARCH_H
+#define UL_SEARCH_H
+
+#include "screen.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of code points in a search query */
+#define UL_SEARCH_MAX_QUERY 64
+
+/**
+ * A match in the screen's lines
+ */
+typedef struct {
+    /* Sequence number of the line (see ul_screen_get_line_sequence) */
+    uint32_t line;
+    /* First column of the match */
+    int col;
+} ul_search_match;
+
+/**
+ * Case-insensitive search through scrollback and screen
+ */
+typedef struct {
+    /* Case-folded query */
+    uint32_t query[UL_SEARCH_MAX_QUERY];
+    /* Number of code points in query */
+    int query_len;
+    /* History filter bits of the query's trigrams, or of the whole query if it is shorter */
+    uint32_t trigram_bits[UL_SEARCH_MAX_QUERY];
+    /* Number of entries in trigram_bits */
+    int num_trigram_bits;
+    /* Most recently found match */
+    ul_search_match match;
+    /* True if match is valid */
+    bool has_match;
+} ul_search;
+
+/**
+ * Statistics of all searches
+ */
+typedef struct {
+    /* Number of searches run */
+    unsigned long searches;
+    /* Number of lines compared against the query */
+    unsigned long lines_scanned;
+    /* Number of lines skipped because their block's filter ruled out a match */
+    unsigned long lines_skipped;
+    /* Duration of the most recent search in microseconds */
+    long last_duration_us;
+} ul_search_stats;
+
+/**
+ * Set the query of a search, resetting the current match.
+ *
+ * @param search search
+ * @param text UTF-8 query, an empty string clears the search
+ */
+void ul_search_set_query(ul_search *search, const char *text);
+
+/**
+ * Find the next match in a direction, starting next to the current match or at the newest
+ * line if there is none. The view is scrolled to show the match.
+ *
+ * @param search search
+ * @param screen screen to search in
+ * @param older true to search towards older lines, false towards newer lines
+ * @return true if a match was found, false otherwise
+ */
+bool ul_search_find(ul_search *search, ul_screen *screen, bool older);
+
+/**
+ * Find the next occurrence of the query in a row.
+ *
+ * @param search search
+ * @param row row to search
+ * @param from_col column to start at
+ * @return column of the occurrence or -1 if there is none
+ */
+int ul_search_find_in_row(const ul_search *search, const ul_row *row, int from_col);
+
+/**
+ * Get statistics about all searches.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_search_get_stats(ul_search_stats *stats);
+
+#endif /* UL_SEARCH_H */
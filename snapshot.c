@@ -0,0 +1,293 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "snapshot.h"
+
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+
+/**
+ * Static variables
+ */
+
+static unsigned long num_published_frames = 0;
+static unsigned long num_replaced_frames = 0;
+static unsigned long num_applied_frames = 0;
+static unsigned long num_copied_rows = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Reallocate the rows of a frame for a new size and mark all of them as stale.
+ *
+ * @param frame frame to resize
+ * @param cols number of columns
+ * @param rows number of rows
+ * @return true on success, false if memory is short and the frame is unchanged
+ */
+static bool resize_frame(ul_snapshot_frame *frame, int cols, int rows);
+
+/**
+ * Check whether a frame shows the same cursor as a screen.
+ *
+ * @param frame frame
+ * @param screen screen
+ * @return true if position and visibility of the cursor match, false otherwise
+ */
+static bool has_same_cursor(const ul_snapshot_frame *frame, const ul_screen *screen);
+
+/**
+ * Find the marked cell in the view of a screen.
+ *
+ * @param snapshot snapshot
+ * @param screen screen
+ * @param x pointer for writing the column in the view into, -1 if the cell isn't in view
+ * @param y pointer for writing the row in the view into, -1 if the cell isn't in view
+ */
+static void find_mark(const ul_snapshot *snapshot, const ul_screen *screen, int *x, int *y);
+
+/**
+ * Copy a range of cells into a row of a frame, moving the attribute references along.
+ *
+ * @param frame frame to write into
+ * @param y row index
+ * @param src row to copy from
+ * @param x0 first column
+ * @param x1 column after the last one
+ */
+static void copy_cells(ul_snapshot_frame *frame, int y, const ul_row *src, int x0, int x1);
+
+
+/**
+ * Static functions
+ */
+
+static bool resize_frame(ul_snapshot_frame *frame, int cols, int rows) {
+    ul_row *row_data = calloc(rows, sizeof(ul_row));
+    ul_cell *cells = calloc((size_t)cols * rows, sizeof(ul_cell));
+    uint32_t *stale = malloc((rows + 31) / 32 * sizeof(uint32_t));
+    if (!row_data || !cells || !stale) {
+        free(row_data);
+        free(cells);
+        free(stale);
+        return false;
+    }
+
+    for (int i = 0; i < frame->cols * frame->rows; ++i) {
+        ul_attr_unref(frame->cells[i].attr);
+    }
+    free(frame->row_data);
+    free(frame->cells);
+    free(frame->stale);
+
+    for (int y = 0; y < rows; ++y) {
+        row_data[y].cells = cells + (size_t)y * cols;
+        row_data[y].size = (uint16_t)cols;
+    }
+    memset(stale, 0xff, (rows + 31) / 32 * sizeof(uint32_t));
+
+    frame->cols = cols;
+    frame->rows = rows;
+    frame->row_data = row_data;
+    frame->cells = cells;
+    frame->stale = stale;
+    frame->scrolled_rows = 0;
+
+    return true;
+}
+
+static bool has_same_cursor(const ul_snapshot_frame *frame, const ul_screen *screen) {
+    return frame->cursor_x == screen->cursor_x && frame->cursor_y == screen->cursor_y &&
+        frame->is_cursor_visible == ul_screen_is_cursor_visible(screen);
+}
+
+static void find_mark(const ul_snapshot *snapshot, const ul_screen *screen, int *x, int *y) {
+    int line = snapshot->has_mark ? ul_screen_find_line(screen, snapshot->mark_line) : -1;
+    if (line < 0 || !ul_screen_get_line_view_position(screen, line, snapshot->mark_col, y, x)) {
+        *x = -1;
+        *y = -1;
+    }
+}
+
+static void copy_cells(ul_snapshot_frame *frame, int y, const ul_row *src, int x0, int x1) {
+    ul_row *row = &(frame->row_data[y]);
+
+    for (int x = x0; x < x1; ++x) {
+        ul_attr_ref(src->cells[x].attr);
+        ul_attr_unref(row->cells[x].attr);
+        row->cells[x] = src->cells[x];
+    }
+
+    row->len = (uint16_t)MIN(src->len, frame->cols);
+    row->flags = src->flags;
+    ++num_copied_rows;
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_snapshot_init(ul_snapshot *snapshot) {
+    memset(snapshot, 0, sizeof(ul_snapshot));
+    for (int i = 0; i < 2; ++i) {
+        snapshot->frames[i].mark_x = -1;
+        snapshot->frames[i].mark_y = -1;
+    }
+    pthread_mutex_init(&(snapshot->mutex), NULL);
+}
+
+bool ul_snapshot_publish(ul_snapshot *snapshot, ul_screen *screen) {
+    int mark_x;
+    int mark_y;
+    find_mark(snapshot, screen, &mark_x, &mark_y);
+
+    pthread_mutex_lock(&(snapshot->mutex));
+
+    /* Nothing to do if the newest frame, whoever holds it, still matches the screen */
+    const ul_snapshot_frame *latest = &(snapshot->frames[snapshot->has_new_frame ? 1 - snapshot->read_index : snapshot->read_index]);
+    if (!screen->is_dirty && latest->cols == screen->cols && latest->rows == screen->rows && has_same_cursor(latest, screen)
+            && latest->mark_x == mark_x && latest->mark_y == mark_y) {
+        pthread_mutex_unlock(&(snapshot->mutex));
+        return true;
+    }
+
+    /* Take back a frame the reader didn't pick up yet, it is updated in place */
+    const bool is_replacing = snapshot->has_new_frame;
+    snapshot->has_new_frame = false;
+    ul_snapshot_frame *frame = &(snapshot->frames[1 - snapshot->read_index]);
+    ul_snapshot_frame *other = &(snapshot->frames[snapshot->read_index]);
+    pthread_mutex_unlock(&(snapshot->mutex));
+
+    if ((frame->cols != screen->cols || frame->rows != screen->rows) && !resize_frame(frame, screen->cols, screen->rows)) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for %dx%d snapshot", screen->cols, screen->rows);
+        pthread_mutex_lock(&(snapshot->mutex));
+        snapshot->has_new_frame = is_replacing;
+        pthread_mutex_unlock(&(snapshot->mutex));
+        return false;
+    }
+
+    frame->scrolled_rows = MIN(frame->scrolled_rows + screen->scrolled_rows, frame->rows);
+
+    /* Rows the frame missed while the reader had it are copied whole, fresh damage only
+     * covers its columns. Either way the reader's frame now misses the damaged rows. */
+    for (int y = 0; y < frame->rows; ++y) {
+        const uint32_t bit = (uint32_t)1 << (y % 32);
+        const bool is_stale = frame->stale[y / 32] & bit;
+        ul_screen_span span;
+        const bool is_damaged = ul_screen_get_damage(screen, y, &span);
+        if (!is_stale && !is_damaged) {
+            continue;
+        }
+
+        const ul_row *src = ul_screen_get_view_row(screen, y);
+        copy_cells(frame, y, src, is_stale ? 0 : span.x0, is_stale ? frame->cols : span.x1);
+        frame->stale[y / 32] &= ~bit;
+        if (is_damaged && y < other->rows) {
+            other->stale[y / 32] |= bit;
+        }
+    }
+
+    frame->cursor_x = screen->cursor_x;
+    frame->cursor_y = screen->cursor_y;
+    frame->is_cursor_visible = ul_screen_is_cursor_visible(screen);
+    frame->mark_x = mark_x;
+    frame->mark_y = mark_y;
+    ul_screen_clear_damage(screen);
+
+    ++num_published_frames;
+    if (is_replacing) {
+        ++num_replaced_frames;
+    }
+
+    pthread_mutex_lock(&(snapshot->mutex));
+    snapshot->has_new_frame = true;
+    pthread_mutex_unlock(&(snapshot->mutex));
+
+    return true;
+}
+
+bool ul_snapshot_apply(ul_snapshot *snapshot, ul_screen *screen) {
+    pthread_mutex_lock(&(snapshot->mutex));
+    if (!snapshot->has_new_frame) {
+        pthread_mutex_unlock(&(snapshot->mutex));
+        return false;
+    }
+
+    /* The frame given back to the writer starts counting scrolled rows from here */
+    snapshot->frames[snapshot->read_index].scrolled_rows = 0;
+    snapshot->read_index = 1 - snapshot->read_index;
+    snapshot->has_new_frame = false;
+    const ul_snapshot_frame *frame = &(snapshot->frames[snapshot->read_index]);
+    pthread_mutex_unlock(&(snapshot->mutex));
+
+    if (screen->cols != frame->cols || screen->rows != frame->rows) {
+        if (!ul_screen_resize(screen, frame->cols, frame->rows)) {
+            return false;
+        }
+    } else if (frame->scrolled_rows > 0) {
+        /* Moving the rows first lets the row comparison below find them unchanged */
+        ul_screen_scroll_up(screen, frame->scrolled_rows);
+    }
+
+    for (int y = 0; y < frame->rows; ++y) {
+        ul_screen_set_row(screen, y, &(frame->row_data[y]));
+    }
+
+    ul_screen_move_cursor(screen, frame->cursor_x, frame->cursor_y);
+    ul_screen_set_cursor_visible(screen, frame->is_cursor_visible);
+    ++num_applied_frames;
+
+    return true;
+}
+
+void ul_snapshot_set_mark(ul_snapshot *snapshot, bool has_mark, uint32_t line, int col) {
+    snapshot->has_mark = has_mark;
+    snapshot->mark_line = line;
+    snapshot->mark_col = col;
+}
+
+bool ul_snapshot_get_mark(const ul_snapshot *snapshot, int *x, int *y) {
+    /* Only the reader changes read_index */
+    const ul_snapshot_frame *frame = &(snapshot->frames[snapshot->read_index]);
+    *x = frame->mark_x;
+    *y = frame->mark_y;
+    return frame->mark_y >= 0;
+}
+
+void ul_snapshot_get_stats(ul_snapshot_stats *stats) {
+    stats->published_frames = num_published_frames;
+    stats->replaced_frames = num_replaced_frames;
+    stats->applied_frames = num_applied_frames;
+    stats->copied_rows = num_copied_rows;
+}
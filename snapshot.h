@@ -0,0 +1,150 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_SNAPSHOT_H
+#define UL_SNAPSHOT_H
+
+#include "row.h"
+#include "screen.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Copy of the view of a screen at one point in time
+ */
+typedef struct {
+    /* Number of columns */
+    int cols;
+    /* Number of rows */
+    int rows;
+    /* View rows, their cells point into cells */
+    ul_row *row_data;
+    /* Cells of all rows, cols cells per row, each holding a reference on its attribute set */
+    ul_cell *cells;
+    /* Rows that changed on the screen since they were copied into this frame, one bit per row */
+    uint32_t *stale;
+    /* Cursor column */
+    int cursor_x;
+    /* Cursor row */
+    int cursor_y;
+    /* True if the cursor is shown */
+    bool is_cursor_visible;
+    /* Column of the marked cell in the view, -1 if there is none or it is out of view */
+    int mark_x;
+    /* Row of the marked cell in the view, -1 if there is none or it is out of view */
+    int mark_y;
+    /* Number of rows the screen scrolled up by since the reader applied the other frame */
+    int scrolled_rows;
+} ul_snapshot_frame;
+
+/**
+ * Pair of frames handed from the thread writing a screen to the thread rendering it. The
+ * writer only ever fills the frame the reader isn't using, the two threads just meet for
+ * swapping the frames.
+ */
+typedef struct {
+    /* Frames, the reader owns frames[read_index] and the writer the other one */
+    ul_snapshot_frame frames[2];
+    /* Index of the frame the reader applied last */
+    int read_index;
+    /* True if the writer's frame is complete and wasn't applied yet */
+    bool has_new_frame;
+    /* True if the writer marks a cell in every frame, e.g. the current search match */
+    bool has_mark;
+    /* Sequence number of the marked cell's line (see ul_screen_get_line_sequence) */
+    uint32_t mark_line;
+    /* Column of the marked cell in its line */
+    int mark_col;
+    /* Guards read_index and has_new_frame */
+    pthread_mutex_t mutex;
+} ul_snapshot;
+
+/**
+ * Snapshot statistics
+ */
+typedef struct {
+    /* Number of frames published */
+    unsigned long published_frames;
+    /* Number of frames that were published again before the reader applied them */
+    unsigned long replaced_frames;
+    /* Number of frames applied by the reader */
+    unsigned long applied_frames;
+    /* Number of rows copied into frames */
+    unsigned long copied_rows;
+} ul_snapshot_stats;
+
+/**
+ * Initialise a snapshot with two empty frames.
+ *
+ * @param snapshot snapshot to initialise
+ */
+void ul_snapshot_init(ul_snapshot *snapshot);
+
+/**
+ * Copy the view of a screen into the writer's frame and hand it to the reader. Only rows that
+ * changed since the frame was last written are copied. The damage of the screen is cleared.
+ *
+ * @param snapshot snapshot
+ * @param screen screen to copy, must not be changed by anyone else during the call
+ * @return true on success, false if memory is short and the screen stays damaged
+ */
+bool ul_snapshot_publish(ul_snapshot *snapshot, ul_screen *screen);
+
+/**
+ * Take the latest published frame, if any, and write it into a screen of the reader. Only
+ * cells that differ from the screen are damaged.
+ *
+ * @param snapshot snapshot
+ * @param screen screen to update
+ * @return true if a new frame was applied, false if nothing was published since the last call
+ */
+bool ul_snapshot_apply(ul_snapshot *snapshot, ul_screen *screen);
+
+/**
+ * Mark a cell of a line, e.g. the current search match, so that its position in the view is
+ * published with the frames. Call this from the writer.
+ *
+ * @param snapshot snapshot
+ * @param has_mark false to clear the mark
+ * @param line sequence number of the line (see ul_screen_get_line_sequence)
+ * @param col column in the line
+ */
+void ul_snapshot_set_mark(ul_snapshot *snapshot, bool has_mark, uint32_t line, int col);
+
+/**
+ * Get the position of the marked cell in the frame applied last. Call this from the reader.
+ *
+ * @param snapshot snapshot
+ * @param x pointer for writing the column in the view into
+ * @param y pointer for writing the row in the view into
+ * @return true if a cell is marked and in view, false otherwise
+ */
+bool ul_snapshot_get_mark(const ul_snapshot *snapshot, int *x, int *y);
+
+/**
+ * Get snapshot statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_snapshot_get_stats(ul_snapshot_stats *stats);
+
+#endif /* UL_SNAPSHOT_H */
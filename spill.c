@@ -0,0 +1,245 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "spill.h"
+
+#include "log.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+
+
+/**
+ * Static variables
+ */
+
+static uint8_t *mapping = NULL;
+static size_t mapping_size = 0;
+static size_t page_size = 4096;
+
+static uint8_t *page_map = NULL; /* One bit per page, set if the page is in use */
+static size_t num_pages = 0;
+static size_t next_page = 0; /* Start of the next free page search */
+
+static size_t used_bytes = 0;
+static size_t allocated_pages = 0;
+static unsigned long num_page_outs = 0;
+static unsigned long num_page_ins = 0;
+static unsigned long num_failures = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Check whether a page is in use.
+ *
+ * @param page page index
+ * @return true if the page is in use, false otherwise
+ */
+static bool is_page_used(size_t page);
+
+/**
+ * Mark a range of pages as used or free.
+ *
+ * @param first first page
+ * @param count number of pages
+ * @param used true to mark the pages as used, false to mark them as free
+ */
+static void mark_pages(size_t first, size_t count, bool used);
+
+/**
+ * Find a run of free pages, starting after the most recent allocation.
+ *
+ * @param count number of pages
+ * @param first pointer for writing the first page of the run into
+ * @return true if a run was found, false otherwise
+ */
+static bool find_free_pages(size_t count, size_t *first);
+
+/**
+ * Get the number of pages covering a byte range.
+ *
+ * @param size number of bytes
+ * @return number of pages
+ */
+static size_t pages_for(size_t size);
+
+
+/**
+ * Static functions
+ */
+
+static bool is_page_used(size_t page) {
+    return page_map[page / 8] & (1 << (page % 8));
+}
+
+static void mark_pages(size_t first, size_t count, bool used) {
+    for (size_t page = first; page < first + count; ++page) {
+        if (used) {
+            page_map[page / 8] |= (uint8_t)(1 << (page % 8));
+        } else {
+            page_map[page / 8] &= (uint8_t)~(1 << (page % 8));
+        }
+    }
+}
+
+static bool find_free_pages(size_t count, size_t *first) {
+    size_t run = 0;
+
+    /* Next-fit: history is freed roughly in the order it was written, so the space after
+     * the last allocation is usually free */
+    for (size_t i = 0; i < num_pages + count; ++i) {
+        size_t page = (next_page + i) % num_pages;
+        if (page == 0) {
+            run = 0; /* Runs can't wrap around the end of the file */
+        }
+        if (is_page_used(page)) {
+            run = 0;
+            continue;
+        }
+        if (++run == count) {
+            *first = page + 1 - count;
+            next_page = (page + 1) % num_pages;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static size_t pages_for(size_t size) {
+    return (size + page_size - 1) / page_size;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_spill_init(const char *directory, size_t max_size) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/furios-terminal-spill-XXXXXX", directory);
+
+    long sys_page_size = sysconf(_SC_PAGESIZE);
+    if (sys_page_size > 0) {
+        page_size = (size_t)sys_page_size;
+    }
+
+    num_pages = max_size / page_size;
+    if (num_pages == 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Spill file size of %zu bytes is too small", max_size);
+        return false;
+    }
+
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not create spill file in %s: %s", directory, strerror(errno));
+        return false;
+    }
+    unlink(path);
+
+    mapping_size = num_pages * page_size;
+    if (ftruncate(fd, (off_t)mapping_size) != 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not resize spill file: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); /* The mapping keeps the file alive */
+    if (mapping == MAP_FAILED) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not map spill file: %s", strerror(errno));
+        mapping = NULL;
+        return false;
+    }
+
+    page_map = calloc((num_pages + 7) / 8, 1);
+    if (!page_map) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate memory for spill page map");
+        munmap(mapping, mapping_size);
+        mapping = NULL;
+        return false;
+    }
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Spilling history to %s (up to %zu bytes)", directory, mapping_size);
+    return true;
+}
+
+bool ul_spill_is_enabled(void) {
+    return mapping != NULL;
+}
+
+bool ul_spill_store(const uint8_t *data, size_t size, size_t *offset) {
+    if (!mapping || size == 0) {
+        return false;
+    }
+
+    size_t count = pages_for(size);
+    size_t first;
+    if (!find_free_pages(count, &first)) {
+        ++num_failures;
+        return false;
+    }
+
+    mark_pages(first, count, true);
+    *offset = first * page_size;
+    memcpy(mapping + *offset, data, size);
+    madvise(mapping + *offset, count * page_size, MADV_DONTNEED);
+
+    used_bytes += size;
+    allocated_pages += count;
+    num_page_outs += count;
+
+    return true;
+}
+
+const uint8_t *ul_spill_load(size_t offset, size_t size) {
+    num_page_ins += pages_for(size);
+    return mapping + offset;
+}
+
+void ul_spill_release(size_t offset, size_t size) {
+    madvise(mapping + offset, pages_for(size) * page_size, MADV_DONTNEED);
+}
+
+void ul_spill_free(size_t offset, size_t size) {
+    size_t count = pages_for(size);
+    madvise(mapping + offset, count * page_size, MADV_REMOVE); /* Give the space back to tmpfs, best effort */
+    mark_pages(offset / page_size, count, false);
+    used_bytes -= size;
+    allocated_pages -= count;
+}
+
+void ul_spill_get_stats(ul_spill_stats *stats) {
+    stats->used = used_bytes;
+    stats->allocated = allocated_pages * page_size;
+    stats->capacity = mapping_size;
+    stats->page_outs = num_page_outs;
+    stats->page_ins = num_page_ins;
+    stats->failures = num_failures;
+}
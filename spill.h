@@ -0,0 +1,109 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_SPILL_H
+#define UL_SPILL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Maximum size of the spill file in MiB if not configured otherwise */
+#define UL_SPILL_DEFAULT_SIZE 64
+
+/**
+ * Spill file statistics
+ */
+typedef struct {
+    /* Bytes of spilled data currently held in the file */
+    size_t used;
+    /* Bytes occupied in the file including padding to whole pages */
+    size_t allocated;
+    /* Maximum size of the file */
+    size_t capacity;
+    /* Number of pages written out */
+    unsigned long page_outs;
+    /* Number of pages read back in */
+    unsigned long page_ins;
+    /* Number of store requests that failed because the file was full */
+    unsigned long failures;
+} ul_spill_stats;
+
+/**
+ * Create the spill file. The file is unlinked right away and only reachable through a
+ * shared memory mapping, so its content is written back to the file system rather than
+ * counting towards the resident set once released.
+ *
+ * @param directory directory to create the file in (e.g. a tmpfs or a data partition)
+ * @param max_size maximum size of the file in bytes
+ * @return true on success, false otherwise
+ */
+bool ul_spill_init(const char *directory, size_t max_size);
+
+/**
+ * Check whether the spill file is available.
+ *
+ * @return true if ul_spill_init succeeded, false otherwise
+ */
+bool ul_spill_is_enabled(void);
+
+/**
+ * Copy data into the spill file and drop the written pages from the resident set.
+ *
+ * @param data bytes to store
+ * @param size number of bytes
+ * @param offset pointer for writing the offset of the stored data into
+ * @return true on success, false if the file is full or not available
+ */
+bool ul_spill_store(const uint8_t *data, size_t size, size_t *offset);
+
+/**
+ * Map spilled data back in. The pages stay resident until ul_spill_release is called.
+ *
+ * @param offset offset returned by ul_spill_store
+ * @param size number of bytes
+ * @return pointer to the data
+ */
+const uint8_t *ul_spill_load(size_t offset, size_t size);
+
+/**
+ * Drop the pages of previously loaded data from the resident set again.
+ *
+ * @param offset offset returned by ul_spill_store
+ * @param size number of bytes
+ */
+void ul_spill_release(size_t offset, size_t size);
+
+/**
+ * Free spilled data.
+ *
+ * @param offset offset returned by ul_spill_store
+ * @param size number of bytes
+ */
+void ul_spill_free(size_t offset, size_t size);
+
+/**
+ * Get statistics about the spill file.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_spill_get_stats(ul_spill_stats *stats);
+
+#endif /* UL_SPILL_H */
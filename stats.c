@@ -0,0 +1,197 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "stats.h"
+
+#include "atlas.h"
+#include "attr.h"
+#include "flush.h"
+#include "history.h"
+#include "log.h"
+#include "parser.h"
+#include "render.h"
+#include "screen.h"
+#include "search.h"
+#include "snapshot.h"
+#include "spill.h"
+#include "termview.h"
+
+#include "lv_drv_conf.h"
+
+#if USE_FBDEV
+#include "fbdev.h"
+#endif /* USE_FBDEV */
+#if USE_DRM
+#include "kms.h"
+#endif /* USE_DRM */
+#if USE_MINUI
+#include "minuifb.h"
+#endif /* USE_MINUI */
+
+#include <stdio.h>
+#include <unistd.h>
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get the resident set size of the process.
+ *
+ * @return resident set size in bytes or 0 if it can't be determined
+ */
+static size_t get_rss(void);
+
+
+/**
+ * Static functions
+ */
+
+static size_t get_rss(void) {
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int num_values = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+
+    return num_values == 2 ? resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_stats_log(void) {
+    ul_attr_stats attr_stats;
+    ul_attr_get_stats(&attr_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: attribute table %d/%d used (peak %d, %lu overflows)",
+        attr_stats.used, attr_stats.capacity, attr_stats.peak, attr_stats.overflows);
+
+    ul_history_stats history_stats;
+    ul_history_get_stats(&history_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: history %ld lines in %d blocks, %zu bytes compressed from %zu (ratio %.2f, %zu bytes saved, %lu decompressions)",
+        history_stats.lines, history_stats.blocks, history_stats.compressed_bytes, history_stats.raw_bytes,
+        history_stats.compressed_bytes > 0 ? (double)history_stats.raw_bytes / history_stats.compressed_bytes : 0.0,
+        history_stats.raw_bytes - history_stats.compressed_bytes, history_stats.decompressions);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: history %zu bytes resident (budget %zu), %lu blocks spilled, %lu dropped early",
+        history_stats.resident_bytes, history_stats.memory_budget, history_stats.spills, history_stats.evictions);
+
+    ul_spill_stats spill_stats;
+    ul_spill_get_stats(&spill_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: spill file %zu/%zu bytes used (%zu allocated), %lu pages out, %lu pages in, %lu failures",
+        spill_stats.used, spill_stats.capacity, spill_stats.allocated, spill_stats.page_outs, spill_stats.page_ins, spill_stats.failures);
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: history search filters %zu bytes", history_stats.filter_bytes);
+
+    ul_search_stats search_stats;
+    ul_search_get_stats(&search_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu searches, %lu lines scanned, %lu lines skipped by filters, last search took %ld us",
+        search_stats.searches, search_stats.lines_scanned, search_stats.lines_skipped, search_stats.last_duration_us);
+
+    ul_screen_stats screen_stats;
+    ul_screen_get_stats(&screen_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu damaged rows, %lu skipped as unchanged (%.1f%%)",
+        screen_stats.damaged_rows, screen_stats.unchanged_rows,
+        screen_stats.damaged_rows > 0 ? 100.0 * screen_stats.unchanged_rows / screen_stats.damaged_rows : 0.0);
+
+    ul_parser_stats parser_stats;
+    ul_parser_get_stats(&parser_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu output chunks (%llu bytes) parsed %s, %.1f us each",
+        parser_stats.chunks, parser_stats.bytes, parser_stats.is_threaded ? "on a parser thread" : "on the main loop",
+        parser_stats.chunks > 0 ? (double)parser_stats.parse_us / parser_stats.chunks : 0.0);
+
+    ul_snapshot_stats snapshot_stats;
+    ul_snapshot_get_stats(&snapshot_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu snapshots published (%lu replaced before rendering), %lu rendered, %.1f rows copied each",
+        snapshot_stats.published_frames, snapshot_stats.replaced_frames, snapshot_stats.applied_frames,
+        snapshot_stats.published_frames > 0 ? (double)snapshot_stats.copied_rows / snapshot_stats.published_frames : 0.0);
+
+    ul_render_stats render_stats;
+    ul_render_get_stats(&render_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu frames, %.0f pixels repainted and %.0f pixels changed per frame (last frame %u / %u)",
+        render_stats.frames, render_stats.frames > 0 ? (double)render_stats.repainted_pixels / render_stats.frames : 0.0,
+        render_stats.frames > 0 ? (double)render_stats.changed_pixels / render_stats.frames : 0.0,
+        render_stats.last_repainted_pixels, render_stats.last_changed_pixels);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu scrolls moved on the display (%.0f us each), %lu rows not redrawn",
+        render_stats.blit_scrolls, render_stats.blit_scrolls > 0 ? (double)render_stats.blit_us / render_stats.blit_scrolls : 0.0,
+        render_stats.blit_rows);
+
+    ul_termview_stats termview_stats;
+    ul_termview_get_stats(&termview_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu cells drawn in %lu row slices (%.1f cells per frame)",
+        termview_stats.drawn_cells, termview_stats.drawn_rows,
+        render_stats.frames > 0 ? (double)termview_stats.drawn_cells / render_stats.frames : 0.0);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu draw calls (%.1f per frame)", termview_stats.draw_calls,
+        render_stats.frames > 0 ? (double)termview_stats.draw_calls / render_stats.frames : 0.0);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %.0f ns per cell drawn, %lu full-screen redraws (%.0f us each)",
+        termview_stats.drawn_cells > 0 ? 1000.0 * termview_stats.draw_us / termview_stats.drawn_cells : 0.0,
+        termview_stats.full_redraws,
+        termview_stats.full_redraws > 0 ? (double)termview_stats.full_redraw_us / termview_stats.full_redraws : 0.0);
+
+    /* Every hit saves the time an average miss spent rasterising the glyph */
+    ul_atlas_stats atlas_stats;
+    ul_atlas_get_stats(&atlas_stats);
+    const unsigned long lookups = atlas_stats.hits + atlas_stats.misses;
+    const double saved_ns = atlas_stats.misses > 0 ? (double)atlas_stats.rasterise_ns / atlas_stats.misses * atlas_stats.hits : 0.0;
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: glyph cache %d glyphs in %zu bytes (budget %zu), hit rate %.1f%% (%lu / %lu), %lu evicted",
+        atlas_stats.glyphs, atlas_stats.bytes, atlas_stats.budget, lookups > 0 ? 100.0 * atlas_stats.hits / lookups : 0.0,
+        atlas_stats.hits, lookups, atlas_stats.evictions);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: glyph cache saved %.1f us per frame (%.0f ns rasterising per miss)",
+        render_stats.frames > 0 ? saved_ns / 1000.0 / render_stats.frames : 0.0,
+        atlas_stats.misses > 0 ? (double)atlas_stats.rasterise_ns / atlas_stats.misses : 0.0);
+
+    ul_flush_stats flush_stats;
+    ul_flush_get_stats(&flush_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu areas flushed %s, %.0f us writing and %.0f us blocking rendering per frame",
+        flush_stats.flushes, flush_stats.is_async ? "on a worker thread" : "synchronously",
+        render_stats.frames > 0 ? (double)flush_stats.write_us / render_stats.frames : 0.0,
+        render_stats.frames > 0 ? (double)flush_stats.wait_us / render_stats.frames : 0.0);
+
+#if USE_FBDEV
+    ul_fbdev_stats fbdev_stats;
+    ul_fbdev_get_stats(&fbdev_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %.0f bytes copied into the framebuffer per frame",
+        render_stats.frames > 0 ? (double)fbdev_stats.copied_bytes / render_stats.frames : 0.0);
+#endif /* USE_FBDEV */
+#if USE_DRM
+    ul_kms_stats kms_stats;
+    ul_kms_get_stats(&kms_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %lu page flips, %lu forced refreshes waited for a flip",
+        kms_stats.flips, kms_stats.flip_waits);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %.0f bytes copied into and %.0f bytes between dumb buffers per frame",
+        render_stats.frames > 0 ? (double)kms_stats.copied_bytes / render_stats.frames : 0.0,
+        render_stats.frames > 0 ? (double)kms_stats.synced_bytes / render_stats.frames : 0.0);
+#endif /* USE_DRM */
+#if USE_MINUI
+    ul_minuifb_stats minuifb_stats;
+    ul_minuifb_get_stats(&minuifb_stats);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: %.0f bytes converted into and %.0f bytes blitted from the minui shadow surface per frame",
+        render_stats.frames > 0 ? (double)minuifb_stats.copied_bytes / render_stats.frames : 0.0,
+        render_stats.frames > 0 ? (double)minuifb_stats.blitted_bytes / render_stats.frames : 0.0);
+#endif /* USE_MINUI */
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "stats: resident set size %zu bytes", get_rss());
+}
@@ -1,5 +1,5 @@
 /**
- * Copyright 2024 David Badiei
+ * Copyright 2026 FuriLabs
  *
  * This file is part of furios-terminal, hereafter referred to as the program.
  *
@@ -17,4 +17,13 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
-void remove_escape_codes(char *buffer);
\ No newline at end of file
+
+#ifndef UL_STATS_H
+#define UL_STATS_H
+
+/**
+ * Write the current statistics of all subsystems to the log (verbose level).
+ */
+void ul_stats_log(void);
+
+#endif /* UL_STATS_H */
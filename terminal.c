@@ -25,10 +25,10 @@
 
 #include "lvgl/src/widgets/keyboard/lv_keyboard_global.h"
 
-#include "termstr.h"
-
+#include <errno.h>
 #include <fcntl.h>
 #include <stdbool.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <linux/kd.h>
@@ -51,6 +51,7 @@ static int original_mode = KD_TEXT;
 static int original_kb_mode = K_UNICODE;
 
 static char terminal_buffer[BUFFER_SIZE];
+static int terminal_buffer_length = 0;
 
 static int pid = 0;
 static int tty_fd = 0;
@@ -59,6 +60,10 @@ bool term_needs_update = false;
 
 pthread_mutex_t tty_mutex;
 
+/* Signals term_needs_update becoming true */
+static pthread_mutex_t output_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t output_cond = PTHREAD_COND_INITIALIZER;
+
 /**
  * Static prototypes
  */
@@ -134,13 +139,9 @@ static void* tty_thread(void* arg)
     struct winsize ws = {};
     struct term_dimen *tty_dimen = (struct term_dimen*)arg;
 
-    ws.ws_col = tty_dimen->width / 8; //max width of font_32
-    ws.ws_row = tty_dimen->height / 16; //max height of font_32
+    ws.ws_col = tty_dimen->width;
+    ws.ws_row = tty_dimen->height;
     pid = forkpty(&tty_fd, NULL, NULL, &ws);
-
-    char* entered_command = NULL;
-    char* cut_terminal = NULL;
-    int tmp_length = 0;
     
     if (pid == 0) {
         putenv("TERM=xterm");
@@ -163,45 +164,23 @@ static void* tty_thread(void* arg)
             }
 
             if ((p[0].revents & POLLIN) && !term_needs_update) {
-                int readValue = read(tty_fd, &terminal_buffer, BUFFER_SIZE);
-                terminal_buffer[readValue] = '\0';
-                
-                if (tmp_length != 0) {
-                    cut_terminal = (char*)malloc(tmp_length);
-                    memcpy(cut_terminal, terminal_buffer, tmp_length);
-                    cut_terminal[tmp_length] = '\0';
-                }
-    
-                if (entered_command == NULL || cut_terminal == NULL || strlen(entered_command) == 0 || strcmp(entered_command,cut_terminal) != 0)
+                /* The echo of entered commands is kept, the screen model renders it like any other output */
+                int readValue = read(tty_fd, &terminal_buffer, BUFFER_SIZE - 1);
+                if (readValue > 0) {
+                    terminal_buffer[readValue] = '\0';
+                    terminal_buffer_length = readValue;
+                    pthread_mutex_lock(&output_mutex);
                     term_needs_update = true;
-                else if (strcmp(entered_command,cut_terminal) == 0){
-                    remove_escape_codes(terminal_buffer);
-                    int copySize = strlen(terminal_buffer)-strlen(entered_command);
-                    if (copySize-2 > 0){
-                        memcpy(terminal_buffer,terminal_buffer+strlen(entered_command),copySize);
-                        terminal_buffer[copySize] = 0;
-                        term_needs_update = true;
-                    }
-                }
-                if ((entered_command != NULL) && (strlen(entered_command) > 0)) {
-                    free(entered_command);
-                    entered_command = NULL;
-                }
-                if (cut_terminal != NULL) {
-                    free(cut_terminal);
-                    cut_terminal = NULL;
+                    pthread_cond_broadcast(&output_cond);
+                    pthread_mutex_unlock(&output_mutex);
                 }
             }
             else if ((p[0].revents & POLLOUT) && command_ready_to_send) {
                 write(tty_fd, &command_buffer, sizeof(command_buffer));
                 command_ready_to_send = false;
                 command_buffer_pos = 0;
-                entered_command = (char*)malloc(command_buffer_length);
-                memcpy(entered_command, command_buffer, command_buffer_length);
-                entered_command[command_buffer_length] = '\0';
                 for (long unsigned int i = 0; i < sizeof(command_buffer); i++)
                     command_buffer[i] = '\0';
-                tmp_length = command_buffer_length;
                 command_buffer_length = 0;
             }
             pthread_mutex_unlock(&tty_mutex);
@@ -214,7 +193,7 @@ static void* tty_thread(void* arg)
  * Public functions
  */
 
-bool ul_terminal_prepare_current_terminal(int term_width, int term_height) {
+bool ul_terminal_prepare_current_terminal(int cols, int rows) {
     reopen_current_terminal();
 
     if (current_fd < 0) {
@@ -247,10 +226,10 @@ bool ul_terminal_prepare_current_terminal(int term_width, int term_height) {
     
     pthread_t tty_id;
 
-    struct term_dimen dimen;
+    static struct term_dimen dimen;
 
-    dimen.width = term_width;
-    dimen.height = term_height;
+    dimen.width = cols;
+    dimen.height = rows;
     
     if (pthread_create(&tty_id, NULL, tty_thread, (void*)&dimen) != 0) {
         ul_log(UL_LOG_LEVEL_WARNING, "Could not start TTY thread");
@@ -285,7 +264,56 @@ void ul_terminal_reset_current_terminal(void) {
     close_current_terminal();
 }
 
+bool ul_terminal_resize(int cols, int rows) {
+    if (pid <= 0) {
+        return false;
+    }
+
+    struct winsize ws = {};
+    ws.ws_col = cols;
+    ws.ws_row = rows;
+    if (ioctl(tty_fd, TIOCSWINSZ, &ws) != 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not resize terminal to %dx%d", cols, rows);
+        return false;
+    }
+
+    return true;
+}
+
 char* ul_terminal_update_interpret_buffer()
 {
     return (char*) &terminal_buffer;
 }
+
+int ul_terminal_get_interpret_buffer_length()
+{
+    return terminal_buffer_length;
+}
+
+bool ul_terminal_wait_for_output(int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&output_mutex);
+    while (!term_needs_update) {
+        if (pthread_cond_timedwait(&output_cond, &output_mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    const bool has_output = term_needs_update;
+    pthread_mutex_unlock(&output_mutex);
+
+    return has_output;
+}
+
+void ul_terminal_release_output(void) {
+    pthread_mutex_lock(&output_mutex);
+    term_needs_update = false;
+    pthread_mutex_unlock(&output_mutex);
+}
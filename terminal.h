@@ -33,20 +33,51 @@
 #define BUFFER_SIZE 4096
 
 /**
- * Prepare the current TTY for graphics output.
+ * Prepare the current TTY for graphics output and spawn the shell.
+ *
+ * @param cols number of columns of the shell's terminal
+ * @param rows number of rows of the shell's terminal
  */
-bool ul_terminal_prepare_current_terminal(int term_width, int term_height);
+bool ul_terminal_prepare_current_terminal(int cols, int rows);
 
 /**
  * Reset the current TTY to text output.
  */
 void ul_terminal_reset_current_terminal(void);
 
+/**
+ * Tell the shell about a new terminal size (TIOCSWINSZ, which raises SIGWINCH).
+ *
+ * @param cols number of columns
+ * @param rows number of rows
+ * @return true on success, false otherwise
+ */
+bool ul_terminal_resize(int cols, int rows);
+
 /**
 * Intepret keyboard input and add it to command buffer
 */
 char* ul_terminal_update_interpret_buffer();
 
+/**
+* Get the number of bytes in the interpret buffer
+*/
+int ul_terminal_get_interpret_buffer_length();
+
+/**
+ * Block until the shell's output is in the interpret buffer.
+ *
+ * @param timeout_ms maximum time to wait in milliseconds, 0 to just check
+ * @return true if output is waiting, false if the timeout passed without any
+ */
+bool ul_terminal_wait_for_output(int timeout_ms);
+
+/**
+ * Hand the interpret buffer back once its output was processed, so that the next output
+ * can be read into it.
+ */
+void ul_terminal_release_output(void);
+
 extern bool term_needs_update;
 
 extern pthread_mutex_t tty_mutex;
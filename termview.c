@@ -0,0 +1,519 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "termview.h"
+
+#include "atlas.h"
+#include "attr.h"
+#include "clock.h"
+
+
+/**
+ * Defines
+ */
+
+#define MY_CLASS &ul_termview_class
+
+
+/**
+ * Static variables
+ */
+
+/* xterm's default values for the 16 basic colours */
+static const uint32_t basic_colors[16] = {
+    0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+    0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff
+};
+
+/* Channel values of the 6x6x6 colour cube */
+static const uint8_t cube_levels[6] = { 0x00, 0x5f, 0x87, 0xaf, 0xd7, 0xff };
+
+static unsigned long num_drawn_rows = 0;
+static unsigned long num_drawn_cells = 0;
+static unsigned long num_draw_calls = 0;
+static unsigned long num_full_redraws = 0;
+static unsigned long long full_redraw_us = 0;
+static unsigned long long draw_us = 0;
+
+/* Pixel rows of the grid drawn across their full width and time spent drawing cells during
+ * the ongoing refresh, which LVGL may split into several strips */
+static int refresh_grid_height = 0;
+static int refresh_covered_height = 0;
+static unsigned long long refresh_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Initialise a newly created terminal view.
+ *
+ * @param class_p class of the object
+ * @param obj terminal view
+ */
+static void constructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+
+/**
+ * Release the resources of a terminal view that is being deleted.
+ *
+ * @param class_p class of the object
+ * @param obj terminal view
+ */
+static void destructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+
+/**
+ * Handle events sent to a terminal view.
+ *
+ * @param class_p class of the object
+ * @param event the event object
+ */
+static void event_cb(const lv_obj_class_t *class_p, lv_event_t *event);
+
+/**
+ * Resolve a cell colour.
+ *
+ * @param color colour (see UL_ATTR_COLOR_*)
+ * @param fallback colour to use for UL_ATTR_COLOR_DEFAULT
+ * @return the colour
+ */
+static lv_color_t resolve_color(uint32_t color, lv_color_t fallback);
+
+/**
+ * Resolve the colours a cell is drawn with.
+ *
+ * @param attr cell attributes
+ * @param default_fg colour of default foreground cells
+ * @param default_bg colour of default background cells
+ * @param fg pointer for writing the foreground colour into
+ * @param bg pointer for writing the background colour into
+ */
+static void resolve_cell_colors(const ul_attr *attr, lv_color_t default_fg, lv_color_t default_bg, lv_color_t *fg, lv_color_t *bg);
+
+/**
+ * Draw the cells of the view that intersect the area being redrawn.
+ *
+ * @param obj terminal view
+ * @param draw_ctx draw context
+ */
+static void draw_cells(lv_obj_t *obj, lv_draw_ctx_t *draw_ctx);
+
+/**
+ * Draw the cursor if the widget is focused and the cursor is in view.
+ *
+ * @param obj terminal view
+ * @param draw_ctx draw context
+ */
+static void draw_cursor(lv_obj_t *obj, lv_draw_ctx_t *draw_ctx);
+
+/**
+ * Invalidate the cell under the cursor.
+ *
+ * @param obj terminal view
+ */
+static void invalidate_cursor(lv_obj_t *obj);
+
+/**
+ * Toggle the cursor, or leave it shown and stop blinking if the view is idle or unfocused.
+ *
+ * @param timer blink timer
+ */
+static void blink_timer_cb(lv_timer_t *timer);
+
+
+/**
+ * Static functions
+ */
+
+static void constructor(const lv_obj_class_t *class_p, lv_obj_t *obj) {
+    LV_UNUSED(class_p);
+
+    ul_termview_t *view = (ul_termview_t *)obj;
+    view->screen = NULL;
+    view->blink_timer = NULL;
+    view->is_cursor_shown = true;
+    view->blink_idle_ms = 0;
+    view->last_activity = 0;
+
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_CLICK_FOCUSABLE);
+}
+
+static void destructor(const lv_obj_class_t *class_p, lv_obj_t *obj) {
+    LV_UNUSED(class_p);
+
+    ul_termview_t *view = (ul_termview_t *)obj;
+    if (view->blink_timer) {
+        lv_timer_del(view->blink_timer);
+        view->blink_timer = NULL;
+    }
+}
+
+static void event_cb(const lv_obj_class_t *class_p, lv_event_t *event) {
+    LV_UNUSED(class_p);
+
+    if (lv_obj_event_base(MY_CLASS, event) != LV_RES_OK) {
+        return;
+    }
+
+    lv_obj_t *obj = lv_event_get_target(event);
+    const lv_event_code_t code = lv_event_get_code(event);
+
+    if (code == LV_EVENT_DRAW_MAIN) {
+        lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(event);
+        draw_cells(obj, draw_ctx);
+        draw_cursor(obj, draw_ctx);
+    } else if (code == LV_EVENT_FOCUSED || code == LV_EVENT_DEFOCUSED) {
+        invalidate_cursor(obj);
+        ul_termview_wake_cursor(obj);
+    } else if (code == LV_EVENT_STYLE_CHANGED) {
+        lv_obj_invalidate(obj); /* The font and with it the grid may have changed */
+    }
+}
+
+static lv_color_t resolve_color(uint32_t color, lv_color_t fallback) {
+    switch (UL_ATTR_COLOR_TYPE(color)) {
+    case UL_ATTR_COLOR_TYPE(UL_ATTR_COLOR_INDEXED(0)): {
+        const uint32_t index = color & 0xff;
+        if (index < 16) {
+            return lv_color_hex(basic_colors[index]);
+        }
+        if (index < 232) {
+            const uint32_t cube = index - 16;
+            return lv_color_make(cube_levels[cube / 36], cube_levels[(cube / 6) % 6], cube_levels[cube % 6]);
+        }
+        const uint8_t grey = (uint8_t)(8 + (index - 232) * 10);
+        return lv_color_make(grey, grey, grey);
+    }
+    case UL_ATTR_COLOR_TYPE(UL_ATTR_COLOR_RGB(0, 0, 0)):
+        return lv_color_hex(color & 0xffffff);
+    default:
+        return fallback;
+    }
+}
+
+static void resolve_cell_colors(const ul_attr *attr, lv_color_t default_fg, lv_color_t default_bg, lv_color_t *fg, lv_color_t *bg) {
+    uint32_t fg_color = attr->fg;
+    if ((attr->flags & UL_ATTR_FLAG_BOLD) && UL_ATTR_COLOR_TYPE(fg_color) == UL_ATTR_COLOR_TYPE(UL_ATTR_COLOR_INDEXED(0))
+            && (fg_color & 0xff) < 8) {
+        fg_color += 8; /* Bold selects the bright variant of the basic colours */
+    }
+    *fg = resolve_color(fg_color, default_fg);
+    *bg = resolve_color(attr->bg, default_bg);
+    if (attr->flags & UL_ATTR_FLAG_INVERSE) {
+        lv_color_t tmp = *fg;
+        *fg = *bg;
+        *bg = tmp;
+    }
+}
+
+static void draw_cells(lv_obj_t *obj, lv_draw_ctx_t *draw_ctx) {
+    const ul_screen *screen = ((ul_termview_t *)obj)->screen;
+    if (!screen) {
+        return;
+    }
+
+    const int64_t start_us = ul_clock_get_us();
+
+    lv_coord_t cell_width;
+    lv_coord_t cell_height;
+    ul_termview_get_cell_size(obj, &cell_width, &cell_height);
+
+    lv_area_t content;
+    lv_obj_get_content_coords(obj, &content);
+
+    /* Only the cells inside the redrawn area are visited */
+    lv_area_t clip;
+    if (!_lv_area_intersect(&clip, draw_ctx->clip_area, &content)) {
+        return;
+    }
+    const int y0 = (clip.y1 - content.y1) / cell_height;
+    const int y1 = LV_MIN((clip.y2 - content.y1) / cell_height + 1, screen->rows);
+    const int x0 = (clip.x1 - content.x1) / cell_width;
+    const int x1 = LV_MIN((clip.x2 - content.x1) / cell_width + 1, screen->cols);
+
+    const lv_color_t default_fg = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    const lv_color_t default_bg = lv_obj_get_style_bg_color(obj, LV_PART_MAIN);
+
+    /* Neighbouring cells mostly share their attributes, so colours are only resolved when they change */
+    ul_attr_id attr_id = UL_ATTR_DEFAULT_ID;
+    const ul_attr *attr = ul_attr_get(attr_id);
+    lv_color_t fg;
+    lv_color_t bg;
+    resolve_cell_colors(attr, default_fg, default_bg, &fg, &bg);
+
+    lv_draw_label_dsc_t label_dsc;
+    lv_draw_label_dsc_init(&label_dsc);
+    lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &label_dsc);
+
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+    rect_dsc.bg_opa = LV_OPA_COVER;
+
+    for (int y = y0; y < y1; ++y) {
+        const ul_row *row = ul_screen_get_view_row(screen, y);
+        const lv_coord_t cell_y = content.y1 + y * cell_height;
+
+        /* Runs of cells sharing a background colour are filled at once before any glyph is drawn. The
+         * widget's own background already covers cells of the default colour, these are skipped. */
+        int run_start = -1;
+        lv_color_t run_bg = bg;
+        for (int x = x0; x <= x1; ++x) {
+            bool has_bg = false;
+            if (x < x1) {
+                const ul_cell *cell = &(row->cells[x]);
+                if (cell->attr != attr_id) {
+                    attr_id = cell->attr;
+                    attr = ul_attr_get(attr_id);
+                    resolve_cell_colors(attr, default_fg, default_bg, &fg, &bg);
+                }
+                has_bg = attr->bg != UL_ATTR_COLOR_DEFAULT || (attr->flags & UL_ATTR_FLAG_INVERSE);
+            }
+
+            if (run_start >= 0 && (!has_bg || bg.full != run_bg.full)) {
+                lv_area_t run;
+                run.x1 = content.x1 + run_start * cell_width;
+                run.y1 = cell_y;
+                run.x2 = content.x1 + x * cell_width - 1;
+                run.y2 = cell_y + cell_height - 1;
+                rect_dsc.bg_color = run_bg;
+                lv_draw_rect(draw_ctx, &rect_dsc, &run);
+                ++num_draw_calls;
+                run_start = -1;
+            }
+            if (has_bg && run_start < 0) {
+                run_start = x;
+                run_bg = bg;
+            }
+        }
+
+        for (int x = x0; x < x1; ++x) {
+            const ul_cell *cell = &(row->cells[x]);
+            if (cell->attr != attr_id) {
+                attr_id = cell->attr;
+                attr = ul_attr_get(attr_id);
+                resolve_cell_colors(attr, default_fg, default_bg, &fg, &bg);
+            }
+
+            /* Every glyph sits at a fixed advance, no text layout is needed to place it */
+            lv_area_t area;
+            area.x1 = content.x1 + x * cell_width;
+            area.y1 = cell_y;
+            area.x2 = area.x1 + cell_width - 1;
+            area.y2 = area.y1 + cell_height - 1;
+
+            if (cell->width == 0 || (attr->flags & UL_ATTR_FLAG_INVISIBLE)) {
+                continue;
+            }
+
+            if (cell->codepoint > ' ') {
+                const lv_point_t pos = { .x = area.x1, .y = area.y1 };
+                const lv_opa_t opa = (attr->flags & UL_ATTR_FLAG_FAINT) ? LV_OPA_60 : LV_OPA_COVER;
+                const uint8_t style = (attr->flags & UL_ATTR_FLAG_BOLD) ? UL_ATLAS_STYLE_BOLD : 0;
+                const ul_atlas_glyph *glyph = ul_atlas_get(label_dsc.font, cell->codepoint, style);
+                if (glyph) {
+                    ul_atlas_draw(draw_ctx, glyph, &pos, fg, opa);
+                } else {
+                    label_dsc.color = fg;
+                    label_dsc.opa = opa;
+                    lv_draw_letter(draw_ctx, &label_dsc, &pos, cell->codepoint);
+                }
+                ++num_draw_calls;
+            }
+
+            if (attr->flags & (UL_ATTR_FLAG_UNDERLINE | UL_ATTR_FLAG_STRIKETHROUGH)) {
+                lv_area_t line = area;
+                line.y1 = (attr->flags & UL_ATTR_FLAG_UNDERLINE) ? area.y2 : area.y1 + cell_height / 2;
+                line.y2 = line.y1;
+                rect_dsc.bg_color = fg;
+                lv_draw_rect(draw_ctx, &rect_dsc, &line);
+                ++num_draw_calls;
+            }
+        }
+
+        ++num_drawn_rows;
+        num_drawn_cells += (unsigned long)(x1 - x0);
+    }
+
+    const int64_t elapsed_us = ul_clock_get_us() - start_us;
+    draw_us += (unsigned long long)elapsed_us;
+    refresh_us += (unsigned long long)elapsed_us;
+
+    /* Strips of one refreshed area don't overlap, count the grid rows they cover in full width */
+    refresh_grid_height = screen->rows * cell_height;
+    if (x0 == 0 && x1 == screen->cols) {
+        refresh_covered_height += LV_MIN(clip.y2, content.y1 + refresh_grid_height - 1) - clip.y1 + 1;
+    }
+}
+
+static void draw_cursor(lv_obj_t *obj, lv_draw_ctx_t *draw_ctx) {
+    const ul_termview_t *view = (ul_termview_t *)obj;
+    const ul_screen *screen = view->screen;
+    if (!screen || !ul_screen_is_cursor_visible(screen) || !view->is_cursor_shown || !lv_obj_has_state(obj, LV_STATE_FOCUSED)) {
+        return;
+    }
+
+    lv_draw_rect_dsc_t cursor_dsc;
+    lv_draw_rect_dsc_init(&cursor_dsc);
+    lv_obj_init_draw_rect_dsc(obj, LV_PART_CURSOR, &cursor_dsc);
+
+    lv_area_t area;
+    ul_termview_get_cell_area(obj, screen->cursor_y, screen->cursor_x, screen->cursor_x + 1, &area);
+    lv_draw_rect(draw_ctx, &cursor_dsc, &area);
+    ++num_draw_calls;
+}
+
+static void invalidate_cursor(lv_obj_t *obj) {
+    const ul_screen *screen = ((ul_termview_t *)obj)->screen;
+    if (!screen) {
+        return;
+    }
+
+    lv_area_t area;
+    ul_termview_get_cell_area(obj, screen->cursor_y, screen->cursor_x, screen->cursor_x + 1, &area);
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static void blink_timer_cb(lv_timer_t *timer) {
+    lv_obj_t *obj = timer->user_data;
+    ul_termview_t *view = (ul_termview_t *)obj;
+
+    const bool is_idle = view->blink_idle_ms > 0 && lv_tick_elaps(view->last_activity) >= view->blink_idle_ms;
+    if (is_idle || !lv_obj_has_state(obj, LV_STATE_FOCUSED)) {
+        /* Stop waking up until the next activity */
+        if (!view->is_cursor_shown) {
+            view->is_cursor_shown = true;
+            invalidate_cursor(obj);
+        }
+        lv_timer_pause(timer);
+        return;
+    }
+
+    view->is_cursor_shown = !view->is_cursor_shown;
+    invalidate_cursor(obj);
+}
+
+
+/**
+ * Public functions
+ */
+
+const lv_obj_class_t ul_termview_class = {
+    .base_class = &lv_obj_class,
+    .constructor_cb = constructor,
+    .destructor_cb = destructor,
+    .event_cb = event_cb,
+    .width_def = LV_PCT(100),
+    .height_def = LV_PCT(100),
+    .group_def = LV_OBJ_CLASS_GROUP_DEF_TRUE,
+    .instance_size = sizeof(ul_termview_t)
+};
+
+lv_obj_t *ul_termview_create(lv_obj_t *parent) {
+    lv_obj_t *obj = lv_obj_class_create_obj(MY_CLASS, parent);
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+void ul_termview_set_screen(lv_obj_t *obj, const ul_screen *screen) {
+    ((ul_termview_t *)obj)->screen = screen;
+    lv_obj_invalidate(obj);
+}
+
+void ul_termview_set_cursor_blink(lv_obj_t *obj, uint32_t idle_ms) {
+    ul_termview_t *view = (ul_termview_t *)obj;
+    view->blink_idle_ms = idle_ms;
+    if (!view->blink_timer) {
+        view->blink_timer = lv_timer_create(blink_timer_cb, 1000, obj);
+    }
+    ul_termview_wake_cursor(obj);
+}
+
+void ul_termview_wake_cursor(lv_obj_t *obj) {
+    ul_termview_t *view = (ul_termview_t *)obj;
+    view->last_activity = lv_tick_get();
+    if (!view->is_cursor_shown) {
+        view->is_cursor_shown = true;
+        invalidate_cursor(obj);
+    }
+
+    if (!view->blink_timer) {
+        return;
+    }
+
+    /* Restart the cycle so that the cursor stays shown while there is activity */
+    const uint32_t period = lv_obj_get_style_anim_time(obj, LV_PART_CURSOR);
+    if (period == 0 || !lv_obj_has_state(obj, LV_STATE_FOCUSED)) {
+        lv_timer_pause(view->blink_timer);
+        return;
+    }
+    lv_timer_set_period(view->blink_timer, period);
+    lv_timer_reset(view->blink_timer);
+    lv_timer_resume(view->blink_timer);
+}
+
+void ul_termview_get_cell_size(lv_obj_t *obj, lv_coord_t *width, lv_coord_t *height) {
+    const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    *width = LV_MAX(lv_font_get_glyph_width(font, ' ', 0) + lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN), 1);
+    *height = LV_MAX(lv_font_get_line_height(font) + lv_obj_get_style_text_line_space(obj, LV_PART_MAIN), 1);
+}
+
+void ul_termview_get_grid_size(lv_obj_t *obj, int *cols, int *rows) {
+    lv_coord_t cell_width;
+    lv_coord_t cell_height;
+    ul_termview_get_cell_size(obj, &cell_width, &cell_height);
+
+    *cols = LV_MAX(lv_obj_get_content_width(obj) / cell_width, 1);
+    *rows = LV_MAX(lv_obj_get_content_height(obj) / cell_height, 1);
+}
+
+void ul_termview_get_cell_area(lv_obj_t *obj, int y, int x0, int x1, lv_area_t *area) {
+    lv_coord_t cell_width;
+    lv_coord_t cell_height;
+    ul_termview_get_cell_size(obj, &cell_width, &cell_height);
+
+    lv_area_t content;
+    lv_obj_get_content_coords(obj, &content);
+
+    area->x1 = content.x1 + x0 * cell_width;
+    area->y1 = content.y1 + y * cell_height;
+    area->x2 = content.x1 + x1 * cell_width - 1;
+    area->y2 = area->y1 + cell_height - 1;
+}
+
+void ul_termview_end_refresh(void) {
+    if (refresh_grid_height > 0 && refresh_covered_height >= refresh_grid_height) {
+        ++num_full_redraws;
+        full_redraw_us += refresh_us;
+    }
+
+    refresh_grid_height = 0;
+    refresh_covered_height = 0;
+    refresh_us = 0;
+}
+
+void ul_termview_get_stats(ul_termview_stats *stats) {
+    stats->drawn_rows = num_drawn_rows;
+    stats->drawn_cells = num_drawn_cells;
+    stats->draw_calls = num_draw_calls;
+    stats->full_redraws = num_full_redraws;
+    stats->full_redraw_us = full_redraw_us;
+    stats->draw_us = draw_us;
+}
@@ -0,0 +1,144 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_TERMVIEW_H
+#define UL_TERMVIEW_H
+
+#include "screen.h"
+
+#include "lvgl/lvgl.h"
+
+/**
+ * Terminal view widget: draws the cells of a screen's view at fixed positions on a grid
+ * sized by the width of a space and the line height of the text font. Only the cells
+ * inside the area being redrawn are visited, so the cost of a refresh follows the number
+ * of invalidated cells rather than the amount of text. The cursor is drawn from the
+ * LV_PART_CURSOR style while the widget is focused and, if enabled, blinks by redrawing
+ * only its own cell.
+ */
+typedef struct {
+    lv_obj_t obj;
+    /* Screen to draw, NULL to draw only the background */
+    const ul_screen *screen;
+    /* Timer toggling the cursor, NULL if the cursor doesn't blink */
+    lv_timer_t *blink_timer;
+    /* Whether the cursor is in the visible phase of blinking */
+    bool is_cursor_shown;
+    /* Time after the last activity to stop blinking (in milliseconds), 0 to blink forever */
+    uint32_t blink_idle_ms;
+    /* Tick of the last activity */
+    uint32_t last_activity;
+} ul_termview_t;
+
+/**
+ * Terminal view statistics
+ */
+typedef struct {
+    /* Number of row slices drawn, one per row and redrawn area */
+    unsigned long drawn_rows;
+    /* Number of cells drawn */
+    unsigned long drawn_cells;
+    /* Number of rectangle fills and glyphs handed to the draw context */
+    unsigned long draw_calls;
+    /* Number of refreshes that redrew the whole grid, in one or several strips */
+    unsigned long full_redraws;
+    /* Time spent drawing the cells of those refreshes in microseconds */
+    unsigned long long full_redraw_us;
+    /* Time spent drawing cells in microseconds */
+    unsigned long long draw_us;
+} ul_termview_stats;
+
+extern const lv_obj_class_t ul_termview_class;
+
+/**
+ * Create a terminal view.
+ *
+ * @param parent parent object
+ * @return the new object
+ */
+lv_obj_t *ul_termview_create(lv_obj_t *parent);
+
+/**
+ * Set the screen shown by a terminal view and redraw it.
+ *
+ * @param obj terminal view
+ * @param screen screen to show, may be NULL
+ */
+void ul_termview_set_screen(lv_obj_t *obj, const ul_screen *screen);
+
+/**
+ * Make the cursor blink with the animation time of the LV_PART_CURSOR style. Once no
+ * activity was reported for a while, blinking stops with the cursor shown so that an idle
+ * terminal doesn't need any redraws.
+ *
+ * @param obj terminal view
+ * @param idle_ms time after the last activity to stop blinking (in milliseconds), 0 to blink forever
+ */
+void ul_termview_set_cursor_blink(lv_obj_t *obj, uint32_t idle_ms);
+
+/**
+ * Show the cursor and restart blinking after activity such as output or key presses.
+ *
+ * @param obj terminal view
+ */
+void ul_termview_wake_cursor(lv_obj_t *obj);
+
+/**
+ * Get the size of a cell in pixels.
+ *
+ * @param obj terminal view
+ * @param width pointer for writing the cell width into
+ * @param height pointer for writing the cell height into
+ */
+void ul_termview_get_cell_size(lv_obj_t *obj, lv_coord_t *width, lv_coord_t *height);
+
+/**
+ * Get the number of whole cells that fit into the content area of a terminal view.
+ *
+ * @param obj terminal view
+ * @param cols pointer for writing the number of columns into, at least 1
+ * @param rows pointer for writing the number of rows into, at least 1
+ */
+void ul_termview_get_grid_size(lv_obj_t *obj, int *cols, int *rows);
+
+/**
+ * Get the area a range of cells of a view row covers on the display.
+ *
+ * @param obj terminal view
+ * @param y row index in the view
+ * @param x0 first column
+ * @param x1 column after the last one
+ * @param area pointer for writing the area into
+ */
+void ul_termview_get_cell_area(lv_obj_t *obj, int y, int x0, int x1, lv_area_t *area);
+
+/**
+ * Finish counting the time spent on a refresh, call this once LVGL has drawn all of its areas.
+ */
+void ul_termview_end_refresh(void);
+
+/**
+ * Get terminal view statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void ul_termview_get_stats(ul_termview_stats *stats);
+
+#endif /* UL_TERMVIEW_H */
@@ -22,6 +22,7 @@
 
 #include "log.h"
 #include "sq2lv_layouts.h"
+#include "termview.h"
 #include "furios-terminal.h"
 
 #include "lvgl/lvgl.h"
@@ -33,6 +34,7 @@
 
 static ul_theme current_theme;
 static lv_theme_t lv_theme;
+static const lv_font_t *terminal_font = &lv_font_unscii_16;
 
 static struct {
     lv_style_t widget;
@@ -154,7 +156,7 @@ static void init_styles(const ul_theme *theme) {
     lv_style_set_border_color(&(styles.textarea), lv_color_hex(theme->textarea.border_color));
     lv_style_set_radius(&(styles.textarea), lv_dpx(theme->textarea.corner_radius));
     lv_style_set_pad_all(&(styles.textarea), lv_dpx(theme->textarea.pad));
-    lv_style_set_text_font(&(styles.textarea), &lv_font_unscii_16);
+    lv_style_set_text_font(&(styles.textarea), terminal_font);
 
     reset_style(&(styles.textarea_placeholder));
     lv_style_set_text_color(&(styles.textarea_placeholder), lv_color_hex(theme->textarea.placeholder_color));
@@ -283,6 +285,12 @@ static void apply_theme_cb(lv_theme_t *theme, lv_obj_t *obj) {
         return; /* Inherit styling from textarea */
     }
 
+    if (lv_obj_check_type(obj, &ul_termview_class)) {
+        lv_obj_add_style(obj, &(styles.textarea), 0);
+        lv_obj_add_style(obj, &(styles.textarea_cursor), LV_PART_CURSOR | LV_STATE_FOCUSED);
+        return;
+    }
+
     if (lv_obj_check_type(obj, &lv_dropdown_class)) {
         lv_obj_add_style(obj, &(styles.dropdown), 0);
         lv_obj_add_style(obj, &(styles.dropdown_pressed), LV_STATE_PRESSED);
@@ -371,6 +379,10 @@ void ul_theme_prepare_keyboard(lv_obj_t *keyboard) {
     lv_obj_add_event_cb(keyboard, keyboard_draw_part_begin_cb, LV_EVENT_DRAW_PART_BEGIN, NULL);
 }
 
+void ul_theme_set_terminal_font(const lv_font_t *font) {
+    terminal_font = font;
+}
+
 void ul_theme_apply(const ul_theme *theme) {
     if (!theme) {
         ul_log(UL_LOG_LEVEL_ERROR, "Could not apply theme from NULL pointer");
@@ -195,6 +195,13 @@ typedef struct {
  */
 void ul_theme_prepare_keyboard(lv_obj_t *keyboard);
 
+/**
+ * Set the font of the terminal and text areas. Takes effect when a theme is applied next.
+ *
+ * @param font monospace font
+ */
+void ul_theme_set_terminal_font(const lv_font_t *font);
+
 /**
  * Apply a UI theme.
  *
@@ -0,0 +1,446 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "vt.h"
+
+#include "attr.h"
+
+#include <string.h>
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get a control sequence parameter.
+ *
+ * @param vt parser
+ * @param index parameter index
+ * @param def value to use if the parameter is omitted or zero
+ * @return parameter value
+ */
+static int get_param(const ul_vt *vt, int index, int def);
+
+/**
+ * Reset the parameter state for a new sequence.
+ *
+ * @param vt parser
+ */
+static void clear_sequence(ul_vt *vt);
+
+/**
+ * Handle a C0 control character.
+ *
+ * @param vt parser
+ * @param c control character
+ */
+static void execute_control(ul_vt *vt, unsigned char c);
+
+/**
+ * Handle a printable code point.
+ *
+ * @param vt parser
+ * @param codepoint code point
+ */
+static void print_codepoint(ul_vt *vt, uint32_t codepoint);
+
+/**
+ * Handle the final byte of an escape sequence.
+ *
+ * @param vt parser
+ * @param final final byte
+ */
+static void dispatch_escape(ul_vt *vt, unsigned char final);
+
+/**
+ * Handle the final byte of a control sequence (CSI).
+ *
+ * @param vt parser
+ * @param final final byte
+ */
+static void dispatch_csi(ul_vt *vt, unsigned char final);
+
+/**
+ * Set or reset DEC private modes (CSI ? ... h / CSI ? ... l).
+ *
+ * @param vt parser
+ * @param enable true to set the modes, false to reset them
+ */
+static void set_private_modes(ul_vt *vt, bool enable);
+
+/**
+ * Feed a byte in the ground state, decoding UTF-8.
+ *
+ * @param vt parser
+ * @param c input byte
+ */
+static void feed_ground(ul_vt *vt, unsigned char c);
+
+/**
+ * Reset the terminal to its initial state (RIS).
+ *
+ * @param vt parser
+ */
+static void full_reset(ul_vt *vt);
+
+
+/**
+ * Static functions
+ */
+
+static int get_param(const ul_vt *vt, int index, int def) {
+    if (index >= vt->num_params || vt->params[index] <= 0) {
+        return def;
+    }
+    return vt->params[index];
+}
+
+static void clear_sequence(ul_vt *vt) {
+    vt->num_params = 0;
+    vt->private_marker = 0;
+    vt->intermediate = 0;
+}
+
+static void execute_control(ul_vt *vt, unsigned char c) {
+    ul_screen *screen = vt->screen;
+
+    switch (c) {
+    case '\b':
+        ul_screen_backspace(screen);
+        break;
+    case '\t':
+        ul_screen_tab(screen);
+        break;
+    case '\n':
+    case '\v':
+    case '\f':
+        ul_screen_linefeed(screen);
+        break;
+    case '\r':
+        ul_screen_carriage_return(screen);
+        break;
+    default:
+        break; /* BEL, SO, SI etc. have no visible effect */
+    }
+}
+
+static void print_codepoint(ul_vt *vt, uint32_t codepoint) {
+    ul_screen_put_char(vt->screen, codepoint);
+}
+
+static void dispatch_escape(ul_vt *vt, unsigned char final) {
+    ul_screen *screen = vt->screen;
+
+    if (vt->intermediate != 0) {
+        return; /* Character set designations (ESC ( B etc.) are not supported */
+    }
+
+    switch (final) {
+    case '7':
+        ul_screen_save_cursor(screen);
+        break;
+    case '8':
+        ul_screen_restore_cursor(screen);
+        break;
+    case 'D':
+        ul_screen_linefeed(screen);
+        break;
+    case 'E':
+        ul_screen_carriage_return(screen);
+        ul_screen_linefeed(screen);
+        break;
+    case 'M':
+        ul_screen_reverse_linefeed(screen);
+        break;
+    case 'c':
+        full_reset(vt);
+        break;
+    default:
+        break;
+    }
+}
+
+static void dispatch_csi(ul_vt *vt, unsigned char final) {
+    ul_screen *screen = vt->screen;
+
+    if (vt->private_marker == '?' && vt->intermediate == 0 && (final == 'h' || final == 'l')) {
+        set_private_modes(vt, final == 'h');
+        return;
+    }
+
+    if (vt->private_marker != 0 || vt->intermediate != 0) {
+        return; /* Other private sequences and extensions are not supported */
+    }
+
+    switch (final) {
+    case '@':
+        ul_screen_insert_chars(screen, get_param(vt, 0, 1));
+        break;
+    case 'A':
+        ul_screen_move_cursor(screen, screen->cursor_x, screen->cursor_y - get_param(vt, 0, 1));
+        break;
+    case 'B':
+    case 'e':
+        ul_screen_move_cursor(screen, screen->cursor_x, screen->cursor_y + get_param(vt, 0, 1));
+        break;
+    case 'C':
+    case 'a':
+        ul_screen_move_cursor(screen, screen->cursor_x + get_param(vt, 0, 1), screen->cursor_y);
+        break;
+    case 'D':
+        ul_screen_move_cursor(screen, screen->cursor_x - get_param(vt, 0, 1), screen->cursor_y);
+        break;
+    case 'E':
+        ul_screen_move_cursor(screen, 0, screen->cursor_y + get_param(vt, 0, 1));
+        break;
+    case 'F':
+        ul_screen_move_cursor(screen, 0, screen->cursor_y - get_param(vt, 0, 1));
+        break;
+    case 'G':
+    case '`':
+        ul_screen_move_cursor(screen, get_param(vt, 0, 1) - 1, screen->cursor_y);
+        break;
+    case 'H':
+    case 'f':
+        ul_screen_move_cursor(screen, get_param(vt, 1, 1) - 1, get_param(vt, 0, 1) - 1);
+        break;
+    case 'L':
+        ul_screen_insert_lines(screen, get_param(vt, 0, 1));
+        break;
+    case 'M':
+        ul_screen_delete_lines(screen, get_param(vt, 0, 1));
+        break;
+    case 'S':
+        ul_screen_scroll_up(screen, get_param(vt, 0, 1));
+        break;
+    case 'T':
+        ul_screen_scroll_down(screen, get_param(vt, 0, 1));
+        break;
+    case 'r':
+        ul_screen_set_scroll_region(screen, get_param(vt, 0, 1) - 1, get_param(vt, 1, screen->rows) - 1);
+        break;
+    case 'J':
+        ul_screen_erase_display(screen, vt->num_params > 0 && vt->params[0] > 0 ? vt->params[0] : 0);
+        break;
+    case 'K':
+        ul_screen_erase_line(screen, vt->num_params > 0 && vt->params[0] > 0 ? vt->params[0] : 0);
+        break;
+    case 'P':
+        ul_screen_delete_chars(screen, get_param(vt, 0, 1));
+        break;
+    case 'X':
+        ul_screen_erase_chars(screen, get_param(vt, 0, 1));
+        break;
+    case 'd':
+        ul_screen_move_cursor(screen, screen->cursor_x, get_param(vt, 0, 1) - 1);
+        break;
+    case 'm': {
+        ul_attr pen = screen->pen;
+        ul_attr_apply_sgr(&pen, vt->params, vt->num_params);
+        ul_screen_set_pen(screen, &pen);
+        break;
+    }
+    case 's':
+        ul_screen_save_cursor(screen);
+        break;
+    case 'u':
+        ul_screen_restore_cursor(screen);
+        break;
+    default:
+        break;
+    }
+}
+
+static void set_private_modes(ul_vt *vt, bool enable) {
+    ul_screen *screen = vt->screen;
+
+    for (int i = 0; i < vt->num_params; ++i) {
+        switch (vt->params[i]) {
+        case 25:
+            /* Show or hide the cursor (DECTCEM) */
+            ul_screen_set_cursor_visible(screen, enable);
+            break;
+        case 47:
+            ul_screen_set_alternate(screen, enable, false);
+            break;
+        case 1047:
+            /* The alternate screen is cleared when leaving it */
+            if (!enable && screen->is_alternate) {
+                ul_screen_erase_display(screen, 2);
+            }
+            ul_screen_set_alternate(screen, enable, false);
+            break;
+        case 1049:
+            /* Save the cursor, then switch to a cleared alternate screen */
+            if (enable) {
+                if (!screen->is_alternate) {
+                    ul_screen_save_cursor(screen);
+                }
+                ul_screen_set_alternate(screen, true, true);
+            } else if (screen->is_alternate) {
+                ul_screen_set_alternate(screen, false, false);
+                ul_screen_restore_cursor(screen);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void feed_ground(ul_vt *vt, unsigned char c) {
+    if (vt->utf8_remaining > 0) {
+        if ((c & 0xc0) == 0x80) {
+            vt->utf8_codepoint = (vt->utf8_codepoint << 6) | (c & 0x3f);
+            if (--vt->utf8_remaining == 0) {
+                print_codepoint(vt, vt->utf8_codepoint);
+            }
+            return;
+        }
+        /* Truncated sequence, emit a replacement and reprocess the byte */
+        vt->utf8_remaining = 0;
+        print_codepoint(vt, 0xfffd);
+    }
+
+    if (c < 0x20) {
+        execute_control(vt, c);
+    } else if (c < 0x7f) {
+        print_codepoint(vt, c);
+    } else if (c == 0x7f) {
+        /* DEL is ignored */
+    } else if (c >= 0xc2 && c <= 0xdf) {
+        vt->utf8_codepoint = c & 0x1f;
+        vt->utf8_remaining = 1;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        vt->utf8_codepoint = c & 0x0f;
+        vt->utf8_remaining = 2;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        vt->utf8_codepoint = c & 0x07;
+        vt->utf8_remaining = 3;
+    } else {
+        print_codepoint(vt, 0xfffd);
+    }
+}
+
+static void full_reset(ul_vt *vt) {
+    ul_screen *screen = vt->screen;
+    ul_attr pen;
+    ul_attr_reset(&pen);
+    ul_screen_set_alternate(screen, false, false);
+    ul_screen_set_scroll_region(screen, 0, screen->rows - 1);
+    ul_screen_set_pen(screen, &pen);
+    ul_screen_erase_display(screen, 2);
+    ul_screen_move_cursor(screen, 0, 0);
+    ul_screen_set_cursor_visible(screen, true);
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_vt_init(ul_vt *vt, ul_screen *screen) {
+    memset(vt, 0, sizeof(ul_vt));
+    vt->screen = screen;
+    vt->state = UL_VT_STATE_GROUND;
+}
+
+void ul_vt_feed(ul_vt *vt, const char *data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = (unsigned char)data[i];
+
+        /* ESC, CAN and SUB interrupt any sequence except for string terminators */
+        if (c == 0x1b && vt->state != UL_VT_STATE_STRING) {
+            vt->utf8_remaining = 0;
+            clear_sequence(vt);
+            vt->state = UL_VT_STATE_ESCAPE;
+            continue;
+        }
+        if (c == 0x18 || c == 0x1a) {
+            vt->state = UL_VT_STATE_GROUND;
+            continue;
+        }
+
+        switch (vt->state) {
+        case UL_VT_STATE_GROUND:
+            feed_ground(vt, c);
+            break;
+        case UL_VT_STATE_ESCAPE:
+        case UL_VT_STATE_ESCAPE_INTERMEDIATE:
+            if (c < 0x20) {
+                execute_control(vt, c);
+            } else if (c < 0x30) {
+                vt->intermediate = (char)c;
+                vt->state = UL_VT_STATE_ESCAPE_INTERMEDIATE;
+            } else if (c == '[' && vt->state == UL_VT_STATE_ESCAPE) {
+                vt->state = UL_VT_STATE_CSI;
+            } else if ((c == ']' || c == 'P' || c == 'X' || c == '^' || c == '_') && vt->state == UL_VT_STATE_ESCAPE) {
+                /* OSC, DCS, SOS, PM and APC strings */
+                vt->state = UL_VT_STATE_STRING;
+            } else {
+                dispatch_escape(vt, c);
+                vt->state = UL_VT_STATE_GROUND;
+            }
+            break;
+        case UL_VT_STATE_CSI:
+            if (c < 0x20) {
+                execute_control(vt, c);
+            } else if (c >= '0' && c <= '9') {
+                if (vt->num_params == 0) {
+                    vt->params[vt->num_params++] = -1;
+                }
+                int *param = &(vt->params[vt->num_params - 1]);
+                if (*param < 0) {
+                    *param = 0;
+                }
+                if (*param < 100000) {
+                    *param = *param * 10 + (c - '0');
+                }
+            } else if (c == ';' || c == ':') {
+                if (vt->num_params == 0) {
+                    vt->params[vt->num_params++] = -1;
+                }
+                if (vt->num_params < UL_VT_MAX_PARAMS) {
+                    vt->params[vt->num_params++] = -1;
+                }
+            } else if (c >= '<' && c <= '?') {
+                vt->private_marker = (char)c;
+            } else if (c < 0x30) {
+                vt->intermediate = (char)c;
+            } else if (c >= 0x40 && c <= 0x7e) {
+                dispatch_csi(vt, c);
+                vt->state = UL_VT_STATE_GROUND;
+            }
+            break;
+        case UL_VT_STATE_STRING:
+            /* Window titles, device control strings etc. are not handled, skip until BEL or ST */
+            if (c == 0x07) {
+                vt->state = UL_VT_STATE_GROUND;
+            } else if (c == 0x1b) {
+                vt->state = UL_VT_STATE_STRING_ESCAPE;
+            }
+            break;
+        case UL_VT_STATE_STRING_ESCAPE:
+            vt->state = c == '\\' ? UL_VT_STATE_GROUND : UL_VT_STATE_STRING;
+            break;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_VT_H
+#define UL_VT_H
+
+#include "screen.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Maximum number of parameters in a control sequence, extra parameters are dropped */
+#define UL_VT_MAX_PARAMS 16
+
+/**
+ * Parser states
+ */
+typedef enum {
+    UL_VT_STATE_GROUND,
+    UL_VT_STATE_ESCAPE,
+    UL_VT_STATE_ESCAPE_INTERMEDIATE,
+    UL_VT_STATE_CSI,
+    UL_VT_STATE_STRING,
+    UL_VT_STATE_STRING_ESCAPE
+} ul_vt_state;
+
+/**
+ * Escape sequence parser feeding a screen
+ */
+typedef struct {
+    /* Screen to apply the parsed output to */
+    ul_screen *screen;
+    /* Current parser state */
+    ul_vt_state state;
+    /* Control sequence parameters, -1 for omitted values */
+    int params[UL_VT_MAX_PARAMS];
+    /* Number of parameters */
+    int num_params;
+    /* Private marker of the current control sequence ('?', '>', '<', '=' or 0) */
+    char private_marker;
+    /* Intermediate byte of the current sequence or 0 */
+    char intermediate;
+    /* Partially decoded UTF-8 code point */
+    uint32_t utf8_codepoint;
+    /* Number of UTF-8 continuation bytes still expected */
+    int utf8_remaining;
+} ul_vt;
+
+/**
+ * Initialise a parser.
+ *
+ * @param vt parser to initialise
+ * @param screen screen to apply the parsed output to
+ */
+void ul_vt_init(ul_vt *vt, ul_screen *screen);
+
+/**
+ * Parse output of the child process and apply it to the screen.
+ *
+ * @param vt parser
+ * @param data output bytes
+ * @param len number of bytes
+ */
+void ul_vt_feed(ul_vt *vt, const char *data, size_t len);
+
+#endif /* UL_VT_H */